@@ -30,6 +30,7 @@ public:
 
   std::function<bool(uint64_t sample, const CanMessage& msg)> OnCanMessage;
 
+  using ISampleObserver::OnSample;
   bool OnSample(uint64_t sample, uint64_t record_id,
                 const std::vector<uint8_t>& record) override;
 
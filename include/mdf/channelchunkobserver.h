@@ -0,0 +1,140 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+/** \file channelchunkobserver.h
+ * \brief Channel observer that streams the sample values in chunks.
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "mdf/isampleobserver.h"
+#include "mdf/span.h"
+
+namespace mdf {
+
+namespace detail {
+class ValueDecoder;
+class DecodePlan;
+}
+
+class IChannelGroup;
+
+/** \class ChannelChunkObserver channelchunkobserver.h
+ * "mdf/channelchunkobserver.h"
+ * \brief Channel observer that delivers the sample values in chunks.
+ *
+ * A normal channel observer stores all samples of a channel, so the
+ * memory needed is proportional to the number of samples. This observer
+ * only holds one chunk of values. When the chunk is full, the values are
+ * delivered to the OnChunk function and the chunk buffer is reused for the
+ * next samples. This makes it possible to calculate statistics or export
+ * channels from files that are larger than the primary memory.
+ *
+ * The values are delivered as double values. The engineering values are
+ * delivered if the ConvertValues() property is true (default), otherwise
+ * the channel values. Channel arrays deliver all array values of a sample
+ * after each other. The observer is intended for numeric channels.
+ *
+ * The samples are delivered in sample order. A chunk only holds samples
+ * that follow each other, so a chunk may be delivered before it is full.
+ * The last chunk is delivered when the last sample of the channel group is
+ * read. Call the Flush() function after a partial read to deliver the
+ * remaining samples.
+ */
+class ChannelChunkObserver : public ISampleObserver {
+ public:
+  /** \brief Default number of samples in a chunk. */
+  static constexpr size_t kDefaultChunkSize = 65'536;
+
+  ChannelChunkObserver() = delete;
+
+  /** \brief Creates and attaches the observer.
+   *
+   * @param data_group Data group (DG) to read.
+   * @param group Channel group (CG) with the channel.
+   * @param channel Channel to observe.
+   * @param chunk_size Max number of samples in a chunk.
+   */
+  ChannelChunkObserver(const IDataGroup& data_group,
+                       const IChannelGroup& group, const IChannel& channel,
+                       size_t chunk_size = kDefaultChunkSize);
+  ~ChannelChunkObserver() override;
+
+  ChannelChunkObserver(const ChannelChunkObserver&) = delete;
+  ChannelChunkObserver& operator=(const ChannelChunkObserver&) = delete;
+
+  /** \brief Function object that receives a chunk of samples.
+   *
+   * The views are only valid during the call.
+   * @param first_sample Sample index of the first value.
+   * @param values Sample values. Array channels have ArraySize() values per
+   * sample.
+   * @param valid Valid flag (0/1) for each value.
+   * @return False if the reading should be aborted.
+   */
+  std::function<bool(uint64_t first_sample, Span<const double> values,
+                     Span<const uint8_t> valid)> OnChunk;
+
+  /** \brief If set, the engineering values are delivered. Default true. */
+  void ConvertValues(bool convert) { convert_ = convert; }
+  [[nodiscard]] bool ConvertValues() const { return convert_; }
+
+  [[nodiscard]] const IChannel& Channel() const { return channel_; }
+  [[nodiscard]] uint64_t NofSamples() const;
+  [[nodiscard]] size_t ChunkSize() const { return chunk_size_; }
+  [[nodiscard]] uint64_t ArraySize() const { return array_size_; }
+
+  /** \brief Delivers the samples in the chunk buffer.
+   *
+   * @return False if the OnChunk function requested an abort.
+   */
+  bool Flush();
+
+  bool OnSample(uint64_t sample, uint64_t record_id,
+                const std::vector<uint8_t>& record) override;
+  bool OnSample(uint64_t sample, uint64_t record_id,
+                Span<const uint8_t> record) override;
+  bool OnSampleBlock(uint64_t first_sample, uint64_t record_id,
+                     Span<const uint8_t> records,
+                     size_t record_size) override;
+
+  /** \brief Only channels with a decoder extract columns. */
+  [[nodiscard]] bool IsSampleBlockSupported() const override {
+    return decoder_ != nullptr;
+  }
+
+ private:
+  const IChannelGroup& group_;
+  const IChannel& channel_;
+  uint64_t record_id_ = 0;
+  uint64_t array_size_ = 1;
+  size_t chunk_size_ = kDefaultChunkSize;
+  bool convert_ = true;
+
+  /** \brief Decoder from the channel groups decode plan.
+   *
+   * The pointer is null if the channel isn't in a decode plan.
+   */
+  const detail::ValueDecoder* decoder_ = nullptr;
+  /** \brief Keeps the decoder alive. */
+  std::shared_ptr<const detail::DecodePlan> decode_plan_;
+
+  uint64_t first_sample_ = 0; ///< Sample index of the first buffered sample.
+  size_t nof_samples_ = 0; ///< Number of buffered samples.
+  std::vector<double> channel_list_; ///< Channel values.
+  std::vector<double> eng_list_; ///< Engineering values.
+  std::vector<uint8_t> valid_list_; ///< Valid flags.
+  std::vector<uint8_t> eng_valid_list_; ///< Conversion valid flags.
+
+  bool PrepareSample(uint64_t sample);
+  bool SampleAdded();
+  void DecodeRecord(size_t position, const uint8_t* record, size_t size);
+};
+
+}  // namespace mdf
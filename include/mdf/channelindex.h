@@ -0,0 +1,122 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+/** \file channelindex.h
+ * \brief Index that finds channels by name in a file.
+ */
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace mdf {
+
+class MdfFile;
+class IDataGroup;
+class IChannelGroup;
+class IChannel;
+
+/** \brief Reference to a channel and the groups it belongs to. */
+struct ChannelIndexItem {
+  IDataGroup* DataGroup = nullptr;           ///< Data group (DG) block.
+  const IChannelGroup* ChannelGroup = nullptr; ///< Channel group (CG) block.
+  const IChannel* Channel = nullptr;         ///< Channel (CN) block.
+};
+
+/** \class ChannelIndex channelindex.h "mdf/channelindex.h"
+ * \brief Name index of all channels in a file.
+ *
+ * Searching a channel by name, iterates through all channel groups and
+ * channels of a data group. This is slow when many channels are searched in
+ * a file with many channels. The index maps a channel name to its data
+ * group, channel group and channel. The index is created on the first search
+ * and the search is case-insensitive, same as the
+ * CreateChannelObserver(dg_group, channel_name) function.
+ *
+ * The channel names are always indexed. The display names and the alternative
+ * names in the channel comment (MD) may optionally be indexed as well. Note
+ * that the latter parses the MD block of all channels.
+ *
+ * The index refers to the blocks of the file, so the index must be cleared if
+ * the file blocks are re-read.
+ */
+class ChannelIndex final {
+ public:
+  /** \brief Creates an index for a file.
+   *
+   * @param file The file must be read, at least the measurement info, before
+   * the first search.
+   */
+  explicit ChannelIndex(const MdfFile& file);
+
+  ChannelIndex() = delete;
+  ChannelIndex(const ChannelIndex&) = delete;
+  ChannelIndex& operator=(const ChannelIndex&) = delete;
+
+  /** \brief Adds the display names to the index. Default false. */
+  void IndexDisplayNames(bool index);
+  /** \brief Returns true if the display names are indexed. */
+  [[nodiscard]] bool IndexDisplayNames() const { return display_names_; }
+
+  /** \brief Adds the alternative names in the comment to the index.
+   *
+   * The default and alternative names in the MD comment of the channel
+   * (MdAlternativeName) are added. The display names in the comment are
+   * added if the display names also are indexed. Default false.
+   * @param index Set to true to index the alternative names.
+   */
+  void IndexAlternativeNames(bool index);
+  /** \brief Returns true if the alternative names are indexed. */
+  [[nodiscard]] bool IndexAlternativeNames() const {
+    return alternative_names_;
+  }
+
+  /** \brief Clears the index. It is recreated on next search. */
+  void Clear();
+
+  /** \brief Returns number of indexed names. */
+  [[nodiscard]] size_t Size() const;
+
+  /** \brief Returns all channels that match a name.
+   *
+   * The list is in file order.
+   * @param name Channel name.
+   * @return List of channels. Empty if none is found.
+   */
+  [[nodiscard]] std::vector<ChannelIndexItem> FindAll(
+      std::string_view name) const;
+
+  /** \brief Finds a channel by name.
+   *
+   * In case that the channel exist in many channel groups, it selects the
+   * group with the largest number of samples.
+   * @param name Channel name.
+   * @param item Destination of the channel reference.
+   * @return True if the channel was found.
+   */
+  bool Find(std::string_view name, ChannelIndexItem& item) const;
+
+ private:
+  const MdfFile& file_;
+  bool display_names_ = false;
+  bool alternative_names_ = false;
+
+  mutable std::mutex index_mutex_;
+  mutable bool created_ = false;
+  /** \brief The key is the lower case name. The value is the item index. */
+  mutable std::unordered_multimap<std::string, size_t> name_list_;
+  mutable std::vector<ChannelIndexItem> item_list_;
+
+  void CreateIndex() const;
+  void AddCommentNames(const IChannel& channel,
+                       std::vector<std::string>& key_list) const;
+  void AddName(std::string_view name, size_t item) const;
+};
+
+}  // namespace mdf
@@ -11,6 +11,7 @@
 #include <iomanip>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "mdf/iblock.h"
@@ -146,6 +147,13 @@ class IChannel : public IBlock  {
 
   virtual void Name(const std::string &name) = 0; ///< Sets channel name
   [[nodiscard]] virtual std::string Name() const = 0; ///< Returns channel name
+  /** \brief Returns the channel name without copying it.
+   *
+   * The view is valid as long as the channel exists and its name isn't
+   * changed.
+   * @return Channel name.
+   */
+  [[nodiscard]] virtual std::string_view NameView() const = 0;
 
   virtual void DisplayName(const std::string &name) = 0; ///< Sets display name.
   [[nodiscard]] virtual std::string DisplayName() const = 0; ///< Display name.
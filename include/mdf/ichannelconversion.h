@@ -8,9 +8,14 @@
  *
  */
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include <variant>
 
@@ -19,9 +24,14 @@
 #include "mdf/mdfhelper.h"
 #include "mdf/cccomment.h"
 #include "mdf/ccunit.h"
+#include "mdf/span.h"
 
 namespace mdf {
 
+namespace detail {
+class ConversionTable;
+}
+
 /** \brief Type of conversion formula
  *
  * The type together with the Parameter() function defines
@@ -144,7 +154,7 @@ constexpr uint16_t StatusString = 0x0004; ///< Status string flag.
 class IChannelConversion : public IBlock {
 
  public:
-  ~IChannelConversion() override = default;
+  ~IChannelConversion() override; ///< Destructor.
 
   virtual void Name(const std::string& name); ///< Sets the CC name.
   [[nodiscard]] virtual std::string Name() const; ///< Name.
@@ -286,6 +296,86 @@ class IChannelConversion : public IBlock {
     return true;
   }
 
+  /** \brief Converts a batch of channel values to engineering values.
+   *
+   * The function gives the same result as calling Convert() for each value
+   * but the conversion type and its parameters are resolved once per batch.
+   * The linear, rational and polynomial conversions use SIMD kernels if the
+   * CPU supports them. Other conversion types are converted value by value.
+   * This function is typically used when a whole channel is converted.
+   * @tparam T Channel data type.
+   * @tparam V Engineering value data type.
+   * @param in Channel values.
+   * @param out Engineering values. Shall have the same size as the input.
+   * @param valid Optional valid flag (0/1) per value. Leave it empty if the
+   * flags aren't needed, otherwise it shall have the same size as the input.
+   * @return True if all values are valid.
+   */
+  template <typename T, typename V>
+  bool ConvertBatch(Span<const T> in, Span<V> out,
+                    Span<uint8_t> valid = {}) const;
+
+  /** \brief Engineering values of all raw values of a small integer channel.
+   *
+   * The table holds the engineering value of each raw value of an integer
+   * channel with a few bits. A conversion is then a single array load
+   * instead of a calculation or a table search. The table is indexed by the
+   * raw value minus the min raw value.
+   */
+  class EngValueTable final {
+   public:
+    /** \brief Creates the table by converting each raw value.
+     *
+     * @param conversion The conversion to tabulate.
+     * @param bit_count Number of bits of the raw value (1..16).
+     * @param signed_value True if the raw value is signed.
+     */
+    EngValueTable(const IChannelConversion& conversion, uint32_t bit_count,
+                  bool signed_value);
+
+    [[nodiscard]] uint32_t BitCount() const { return bit_count_; }
+    [[nodiscard]] bool IsSigned() const { return signed_; }
+
+    /** \brief Converts a raw integer value.
+     *
+     * Gives the same result as IChannelConversion::Convert(). Raw values
+     * outside of the table are converted by the conversion.
+     * @tparam T Integer channel data type.
+     * @tparam V Engineering value data type.
+     * @param channel_value The raw channel value.
+     * @param eng_value The scaled engineering value.
+     * @return True if the conversion is valid.
+     */
+    template <typename T, typename V>
+    bool Convert(const T& channel_value, V& eng_value) const;
+
+   private:
+    const IChannelConversion& conversion_;
+    uint32_t bit_count_ = 0;
+    bool signed_ = false;
+    int64_t min_value_ = 0; ///< Raw value of the first table value.
+    std::vector<double> value_list_; ///< Value conversions only.
+    std::vector<std::string> text_list_; ///< Text conversions only.
+    std::vector<uint8_t> valid_list_;
+  };
+
+  /** \brief Max number of raw value bits that may use a value table. */
+  static constexpr uint32_t kMaxEngValueTableBits = 16;
+
+  /** \brief Returns the engineering value table of an integer channel.
+   *
+   * The table is created on first use if the raw values have a few bits and
+   * the conversion is more expensive than a linear conversion. The table
+   * is only used if it pays off, i.e. the number of values to convert is at
+   * least the table size.
+   * @param bit_count Number of bits of the raw channel value.
+   * @param signed_value True if the channel value is signed.
+   * @param nof_values Number of values that will be converted.
+   * @return The table or nullptr if no table should be used.
+   */
+  [[nodiscard]] const EngValueTable* GetEngValueTable(uint32_t bit_count,
+      bool signed_value, uint64_t nof_values) const;
+
   virtual void CopyFrom(const IChannelConversion& source);
 
  protected:
@@ -336,6 +426,55 @@ class IChannelConversion : public IBlock {
       double& eng_value) const; ///< Logarithmic conversion (MDF3).
   virtual bool ConvertExponential(double channel_value,
       double& eng_value) const; ///< Exponential conversion (MDF3).
+
+  /** \brief Converts a batch of double values.
+   *
+   * Used by ConvertBatch(). Only the linear, rational, polynomial,
+   * logarithmic, exponential and algebraic conversions are supported.
+   * @param in Channel values.
+   * @param out Engineering values.
+   * @param valid Valid flag (0/1) per value.
+   * @param count Number of values.
+   * @return True if all values are valid.
+   */
+  bool ConvertDoubles(const double* in, double* out, uint8_t* valid,
+                      size_t count) const;
+  /** \brief Returns true if the conversion is supported by
+   * ConvertDoubles(). */
+  [[nodiscard]] bool IsBatchConversion() const;
+
+  /** \brief Returns the lookup table of a table based conversion.
+   *
+   * The table is created on first use by CreateLookupTable(). The table
+   * also holds the compiled formula of an algebraic conversion.
+   * @return Lookup table.
+   */
+  [[nodiscard]] const detail::ConversionTable& LookupTable() const;
+
+  /** \brief Fills in the lookup table.
+   *
+   * The default function creates the keys of the value to value
+   * conversions and compiles the formula of an algebraic conversion.
+   * Blocks with text references override this function and add the value
+   * to text keys and the resolved text references.
+   * @param table Lookup table to fill in.
+   */
+  virtual void CreateLookupTable(detail::ConversionTable& table) const;
+
+  /** \brief Deletes the lookup table.
+   *
+   * Shall be called when the type, parameters or references are changed.
+   */
+  void ResetLookupTable();
+
+ private:
+  mutable std::unique_ptr<detail::ConversionTable> lookup_table_;
+  mutable std::atomic<bool> lookup_table_created_{false};
+  mutable std::mutex lookup_table_mutex_;
+
+  mutable std::unique_ptr<EngValueTable> eng_value_table_;
+  mutable std::atomic<bool> eng_value_table_created_{false};
+  mutable std::mutex eng_value_table_mutex_;
 };
 
 template <typename T, typename V>
@@ -520,6 +659,76 @@ inline bool IChannelConversion::Convert(const T& channel_value,
   return valid;
 }
 
+template <typename T, typename V>
+bool IChannelConversion::ConvertBatch(Span<const T> in, Span<V> out,
+                                      Span<uint8_t> valid) const {
+  const size_t count = std::min(in.size(), out.size());
+  const bool use_valid = !valid.empty();
+  bool all_valid = true;
+  if constexpr (std::is_arithmetic_v<T> && std::is_arithmetic_v<V>) {
+    if (IsBatchConversion()) {
+      // Convert in small chunks that stay in the cache.
+      constexpr size_t kChunkSize = 1024;
+      double channel_values[kChunkSize];
+      double eng_values[kChunkSize];
+      uint8_t valid_flags[kChunkSize];
+      for (size_t first = 0; first < count; first += kChunkSize) {
+        const size_t nof_values = std::min(kChunkSize, count - first);
+        for (size_t index = 0; index < nof_values; ++index) {
+          channel_values[index] = static_cast<double>(in[first + index]);
+        }
+        if (!ConvertDoubles(channel_values, eng_values, valid_flags,
+                            nof_values)) {
+          all_valid = false;
+        }
+        for (size_t index = 0; index < nof_values; ++index) {
+          out[first + index] = static_cast<V>(eng_values[index]);
+        }
+        if (use_valid) {
+          std::copy_n(valid_flags, nof_values, valid.data() + first);
+        }
+      }
+      return all_valid;
+    }
+  }
+
+  for (size_t index = 0; index < count; ++index) {
+    const bool valid_value = Convert(in[index], out[index]);
+    if (use_valid) {
+      valid[index] = valid_value ? 1 : 0;
+    }
+    all_valid = all_valid && valid_value;
+  }
+  return all_valid;
+}
+
+template <typename T, typename V>
+bool IChannelConversion::EngValueTable::Convert(const T& channel_value,
+                                                V& eng_value) const {
+  static_assert(std::is_integral_v<T>, "The raw value shall be an integer");
+  const auto index = static_cast<uint64_t>(
+      static_cast<int64_t>(channel_value) - min_value_);
+  if (index >= valid_list_.size()) {
+    return conversion_.Convert(channel_value, eng_value);
+  }
+  if (!text_list_.empty()) {
+    if constexpr (std::is_same_v<V, std::string>) {
+      eng_value = text_list_[index];
+    } else {
+      std::istringstream s(text_list_[index]);
+      s >> eng_value;
+    }
+  } else {
+    if constexpr (std::is_same_v<V, std::string>) {
+      eng_value = MdfHelper::FormatDouble(value_list_[index],
+          conversion_.IsDecimalUsed() ? conversion_.Decimals() : 6);
+    } else {
+      eng_value = static_cast<V>(value_list_[index]);
+    }
+  }
+  return valid_list_[index] != 0;
+}
+
 template <typename T, typename V>
 bool IChannelConversion::Convert(const std::string& channel_value,
     double& eng_value) const {
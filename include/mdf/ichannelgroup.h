@@ -145,6 +145,8 @@ class IChannelGroup : public IBlock {
 
   /** \brief Resets the internal sample counter. Internal use only. */
   void ResetSampleCounter() const { sample_ = 0;}
+  /** \brief Sets the internal sample counter. Internal use only. */
+  void SampleCounter(size_t sample) const { sample_ = sample; }
 
   virtual void ClearData(); ///< Resets all temporary stored samples.
   void IncrementSample() const; ///< Add a sample
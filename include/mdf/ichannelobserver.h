@@ -9,10 +9,14 @@
  */
 #pragma once
 #include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
 #include <vector>
 
 #include "mdf/ichannel.h"
 #include "mdf/isampleobserver.h"
+#include "mdf/span.h"
 
 
 namespace mdf {
@@ -28,7 +32,12 @@ class IChannelObserver : public ISampleObserver {
    bool read_vlsd_data_ = true; ///< Defines if the VLSD bytes should be read.
 
   std::vector<uint64_t> offset_list_; ///< Only used for VLSD channels.
-  std::vector<bool> valid_list_; ///< List of valid samples.
+  /** \brief List of valid samples.
+   *
+   * Observers that store the valid samples in a more compact way, may create
+   * the list on demand. See GetValidList().
+   */
+  mutable std::vector<bool> valid_list_;
 
   virtual bool GetSampleUnsigned(uint64_t sample, uint64_t& value, uint64_t array_index)
       const = 0; ///< Returns a unsigned  sample value.
@@ -41,6 +50,44 @@ class IChannelObserver : public ISampleObserver {
   virtual bool GetSampleByteArray(uint64_t sample, std::vector<uint8_t>& value)
       const = 0; ///< Returns a byte array sample value.
 
+  /** \brief Returns the engineering value table of an integer channel.
+   *
+   * Returns nullptr if the channel shall be converted value by value.
+   * @param conversion The channel conversion.
+   * @return Engineering value table or nullptr.
+   */
+  [[nodiscard]] const IChannelConversion::EngValueTable* GetEngValueTable(
+      const IChannelConversion& conversion) const;
+
+  /** \brief Returns the buffer with the stored channel values.
+   *
+   * Observers that store all values after each other in a buffer, should
+   * return the buffer if the type is the type of the stored values.
+   * @param type Type of the stored values.
+   * @return Pointer to the first value and number of values or nullptr.
+   */
+  [[nodiscard]] virtual std::pair<const void*, size_t> SampleBuffer(
+      const std::type_info& type) const;
+
+  /** \brief Returns the valid flag of each sample.
+   *
+   * Used by the bulk functions as GetChannelSamples(). Only the first
+   * array value is returned for array channels.
+   * @param valid_array Valid flag per sample.
+   * @return False if the observer doesn't support this function.
+   */
+  virtual bool GetSampleValidList(std::vector<bool>& valid_array) const;
+
+  /** \brief Converts the sample buffer to another value type. */
+  template <typename V, typename T>
+  bool CopySampleBuffer(std::vector<V>& values) const;
+
+  /** \brief Converts the sample buffer of any numeric type. */
+  template <typename V, typename... T>
+  bool CopyAnySampleBuffer(std::vector<V>& values) const {
+    return (CopySampleBuffer<V, T>(values) || ...);
+  }
+
  public:
   explicit IChannelObserver(const IDataGroup& dataGroup, const IChannel& channel); ///< Constructor.
 
@@ -210,10 +257,27 @@ class IChannelObserver : public ISampleObserver {
   }
 
   /** \brief Returns the sample to valid list.  */
-  [[nodiscard]] const std::vector<bool>& GetValidList() const {
+  [[nodiscard]] virtual const std::vector<bool>& GetValidList() const {
     return valid_list_;
   }
 
+  /** \brief Returns a view of the stored channel values.
+   *
+   * Numeric channels store their values after each other. The view gives
+   * direct access to the values without any copy. The type T shall be the
+   * type of the stored values, otherwise an empty view is returned. Array
+   * values are stored after each other for each sample. Note that the valid
+   * flags are returned by the GetValidList() function.
+   * @tparam T Type of the stored values.
+   * @return View of all stored values.
+   */
+  template <typename T>
+  [[nodiscard]] Span<const T> GetSampleBuffer() const {
+    const auto [data, size] = SampleBuffer(typeid(T));
+    return data != nullptr ?
+        Span<const T>(static_cast<const T*>(data), size) : Span<const T>();
+  }
+
 };
 
 template <typename V>
@@ -290,10 +354,59 @@ template <>
 bool IChannelObserver::GetChannelValue(uint64_t sample,
                                        std::vector<uint8_t>& value, uint64_t array_index) const;
 
+template <typename V, typename T>
+bool IChannelObserver::CopySampleBuffer(std::vector<V>& values) const {
+  const auto [data, size] = SampleBuffer(typeid(T));
+  if (data == nullptr) {
+    return false;
+  }
+  // Same conversions as GetChannelValue().
+  const auto* buffer = static_cast<const T*>(data);
+  values.resize(size);
+  switch (channel_.DataType()) {
+    case ChannelDataType::UnsignedIntegerLe:
+    case ChannelDataType::UnsignedIntegerBe:
+      for (size_t index = 0; index < size; ++index) {
+        values[index] = static_cast<V>(static_cast<uint64_t>(buffer[index]));
+      }
+      break;
+
+    case ChannelDataType::SignedIntegerLe:
+    case ChannelDataType::SignedIntegerBe:
+      for (size_t index = 0; index < size; ++index) {
+        values[index] = static_cast<V>(static_cast<int64_t>(buffer[index]));
+      }
+      break;
+
+    case ChannelDataType::FloatLe:
+    case ChannelDataType::FloatBe:
+      for (size_t index = 0; index < size; ++index) {
+        values[index] = static_cast<V>(static_cast<double>(buffer[index]));
+      }
+      break;
+
+    default:
+      return false;
+  }
+  return true;
+}
+
 template <typename V>
 std::vector<bool> IChannelObserver::GetChannelSamples(
     std::vector<V>& values) const {
   const uint64_t nof_samples = NofSamples();
+  if constexpr (std::is_arithmetic_v<V> && !std::is_same_v<V, bool>) {
+    // Copy the stored values in one loop. Note that array channels only
+    // return the first array value.
+    std::vector<bool> valid_array;
+    if (GetSampleValidList(valid_array) &&
+        CopyAnySampleBuffer<V, uint8_t, uint16_t, uint32_t, uint64_t, int8_t,
+                            int16_t, int32_t, int64_t, float, double>(values)) {
+      if (values.size() == nof_samples && valid_array.size() == nof_samples) {
+        return valid_array;
+      }
+    }
+  }
   std::vector<bool> valid_array(nof_samples, false);
   values.resize(nof_samples, {});
   uint64_t sample = 0;
@@ -333,7 +446,9 @@ bool IChannelObserver::GetEngValue(uint64_t sample, V& value, uint64_t array_ind
       uint64_t v = 0;
       valid = GetSampleUnsigned(sample, v, array_index);
       if (valid) {
-        valid = conversion->Convert(v, value);
+        const auto* table = GetEngValueTable(*conversion);
+        valid = table != nullptr ? table->Convert(v, value) :
+                                   conversion->Convert(v, value);
       }
       break;
     }
@@ -341,8 +456,12 @@ bool IChannelObserver::GetEngValue(uint64_t sample, V& value, uint64_t array_ind
     case ChannelDataType::SignedIntegerLe:
     case ChannelDataType::SignedIntegerBe: {
       int64_t v = 0;
-      valid = GetSampleSigned(sample, v, array_index)
-        && conversion->Convert(v, value);
+      valid = GetSampleSigned(sample, v, array_index);
+      if (valid) {
+        const auto* table = GetEngValueTable(*conversion);
+        valid = table != nullptr ? table->Convert(v, value) :
+                                   conversion->Convert(v, value);
+      }
       break;
     }
 
@@ -382,6 +501,54 @@ bool IChannelObserver::GetEngValue(uint64_t sample,
 template <typename V>
 std::vector<bool> IChannelObserver::GetEngSamples(
     std::vector<V>& values) const {
+  const auto* conversion = channel_.ChannelConversion();
+  if constexpr (std::is_arithmetic_v<V> && !std::is_same_v<V, bool>) {
+    bool numeric = false;
+    switch (channel_.DataType()) {
+      case ChannelDataType::UnsignedIntegerLe:
+      case ChannelDataType::UnsignedIntegerBe:
+      case ChannelDataType::SignedIntegerLe:
+      case ChannelDataType::SignedIntegerBe:
+      case ChannelDataType::FloatLe:
+      case ChannelDataType::FloatBe:
+        numeric = true;
+        break;
+
+      default:
+        break;
+    }
+    // Convert all samples in one batch. Note that a channel value without
+    // conversion isn't converted through a double.
+    if (numeric && conversion != nullptr &&
+        conversion->Type() != ConversionType::NoConversion) {
+      std::vector<double> channel_values;
+      auto valid_array = GetChannelSamples(channel_values);
+      values.resize(channel_values.size(), {});
+      if (const auto* table = GetEngValueTable(*conversion);
+          table != nullptr) {
+        // The raw values are small integers and exact as doubles.
+        for (size_t sample = 0; sample < values.size(); ++sample) {
+          if (valid_array[sample]) {
+            valid_array[sample] = table->Convert(
+                static_cast<int64_t>(channel_values[sample]), values[sample]);
+          }
+        }
+        return valid_array;
+      }
+      std::vector<uint8_t> eng_valid(channel_values.size(), 0);
+      conversion->ConvertBatch(Span<const double>(channel_values),
+                               Span<V>(values), Span<uint8_t>(eng_valid));
+      for (size_t sample = 0; sample < values.size(); ++sample) {
+        if (!valid_array[sample]) {
+          values[sample] = {};
+        } else if (eng_valid[sample] == 0) {
+          valid_array[sample] = false;
+        }
+      }
+      return valid_array;
+    }
+  }
+
   const uint64_t nof_samples = NofSamples();
   std::vector<bool> valid_array(nof_samples, false);
   values.resize(nof_samples, {});
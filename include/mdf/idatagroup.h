@@ -14,6 +14,7 @@
 
 #include "mdf/iblock.h"
 #include "mdf/dgcomment.h"
+#include "mdf/span.h"
 
 namespace mdf {
 
@@ -92,6 +93,26 @@ class IDataGroup : public IBlock {
   bool NotifySampleObservers(uint64_t sample, uint64_t record_id,
                              const std::vector<uint8_t>& record) const;
 
+  /** \brief Notifies the observers with a view of the sample record.
+   *
+   * The record view points into the read buffer, so no record buffer needs
+   * to be allocated for each record.
+   */
+  bool NotifySampleObservers(uint64_t sample, uint64_t record_id,
+                             Span<const uint8_t> record) const;
+
+  /** \brief Returns the record view copied into a record buffer.
+   *
+   * Support function for observers that only handles record buffers. The
+   * record is copied once for each notification, independent of the number
+   * of observers. The record buffer belongs to the calling thread, so
+   * several threads may notify observers at the same time.
+   * @param record View of the current sample record.
+   * @return Reference to the thread's record buffer.
+   */
+  [[nodiscard]] const std::vector<uint8_t>& RecordBuffer(
+      Span<const uint8_t> record) const;
+
   /** \brief Clear all temporary sample and data buffers.
    *
    * Clear all sample and signal data buffers. Call this function
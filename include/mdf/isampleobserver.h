@@ -14,6 +14,7 @@
 #include <functional>
 
 #include "mdf/ichannel.h"
+#include "mdf/span.h"
 namespace mdf {
 
 class IDataGroup;
@@ -70,6 +71,68 @@ class ISampleObserver {
   virtual bool OnSample(uint64_t sample, uint64_t record_id,
                         const std::vector<uint8_t>& record);
 
+  /** \brief Observer function that receives a view of the sample record.
+   *
+   * The readers call this function with a view that points directly into the
+   * read buffer (memory mapped file or decompressed data block). The view is
+   * only valid during the call. This avoids that a record buffer is allocated
+   * for each record.
+   *
+   * The default implementation is an adapter that calls the OnSample()
+   * function above. The record is then copied into a record buffer that
+   * belongs to the reading thread. The copy is done once per record,
+   * independent of the number of observers. Observers that are able to parse the record view directly,
+   * should override this function.
+   * @param sample Sample number.
+   * @param record_id Record ID (channel group identity).
+   * @param record View of the sample record (excluding the record ID).
+   * @return If this function returns false it indicate that reading should be
+   * aborted.
+   */
+  virtual bool OnSample(uint64_t sample, uint64_t record_id,
+                        Span<const uint8_t> record);
+
+  /** \brief Returns true if the observer can handle parallel samples.
+   *
+   * Large sorted data groups may be parsed by several threads. Each thread
+   * then notifies the observers of its own range of samples, so the samples
+   * doesn't arrive in order and OnSampleBlock() is called concurrently. This
+   * is only done if all observers also support sample blocks. An observer
+   * that only stores the sample values at their sample index can handle this
+   * and should return true. Default is false which means that the data group
+   * is parsed by one thread.
+   * @return True if OnSampleBlock() may be called from several threads.
+   */
+  [[nodiscard]] virtual bool IsParallelSafe() const { return false; }
+
+  /** \brief Observer function that receives a run of sorted records.
+   *
+   * Sorted data groups store the records of one channel group after each
+   * other in the data blocks. The reader may then deliver all records in a
+   * data block with one call instead of one call per record. An observer
+   * may then extract a channel as a column, which is much faster than
+   * parsing each record.
+   *
+   * The default implementation calls the OnSample() function with a view of
+   * each record.
+   * @param first_sample Sample number of the first record.
+   * @param record_id Record ID (channel group identity).
+   * @param records View of the records (excluding record ID).
+   * @param record_size Number of bytes in each record.
+   * @return If this function returns false it indicate that reading should be
+   * aborted.
+   */
+  virtual bool OnSampleBlock(uint64_t first_sample, uint64_t record_id,
+                             Span<const uint8_t> records, size_t record_size);
+
+  /** \brief Returns true if the observer overrides the OnSampleBlock().
+   *
+   * The reader only delivers sample blocks if all observers of a channel
+   * group support it.
+   * @return True if the observer handles blocks of records.
+   */
+  [[nodiscard]] virtual bool IsSampleBlockSupported() const { return false; }
+
   /**
    * \brief Function that test if this observer needs to read a specific
    * record.
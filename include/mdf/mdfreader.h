@@ -11,6 +11,7 @@
 #include <functional>
 #include <vector>
 
+#include "mdf/channelindex.h"
 #include "mdf/ichannelobserver.h"
 #include "mdf/mdffile.h"
 #include "mdf/isamplereduction.h"
@@ -76,6 +77,32 @@ void CreateChannelObserverForChannelGroup(const IDataGroup& data_group,
  */
 void CreateChannelObserverForDataGroup(const IDataGroup& data_group,
                                           ChannelObserverList& dest_list);
+
+/** \brief Channel observers that belongs to one data group. */
+struct DataGroupObservers {
+  IDataGroup* DataGroup = nullptr; ///< The data group to read.
+  ChannelObserverList ObserverList; ///< Observers of the data group.
+};
+/** \brief List of observers grouped per data group. */
+using DataGroupObserverList = std::vector<DataGroupObservers>;
+
+/** \brief Creates channel observers for a list of channel names.
+ *
+ * The channels are searched through a channel name index, so this function
+ * is much faster than calling CreateChannelObserver(dg_group, channel_name)
+ * for each name. The observers are grouped per data group, so the data
+ * groups may be read in parallel, see MdfReader::ReadDataParallel().
+ *
+ * In case that a channel exist in many channel groups, it selects the group
+ * with the largest number of samples. Names that aren't found are skipped and
+ * a channel is only observed once.
+ * @param index Channel name index of the file.
+ * @param channel_names List of channel names.
+ * @return Observers grouped per data group, in order of first use.
+ */
+[[nodiscard]] DataGroupObserverList CreateChannelObservers(
+    const ChannelIndex& index, const std::vector<std::string>& channel_names);
+
 /** \class MdfReader mdfreader.h "mdf/mdfreader.h"
  * \brief Reader interface to an MDF file.
  *
@@ -90,6 +117,10 @@ class MdfReader {
    * but more generic as it support environment without a file block
    * storage.
    *
+   * The file is memory mapped if possible. The records are then parsed
+   * directly out of the mapping. If the mapping fails, the reader falls back
+   * on an ordinary file stream.
+   *
    * @param filename Full file path to the input file.
    */
   explicit MdfReader(std::wstring filename);
@@ -124,6 +155,42 @@ class MdfReader {
    */
   void Index(int64_t index) { index_ = index; }
 
+  /** \brief Sets the size of the read buffer.
+   *
+   * Sample data that isn't memory mapped, is read from the stream in chunks
+   * of this size. The size is limited to 1-16 MB. Default is 4 MB.
+   * @param buffer_size Size of the read buffer in bytes.
+   */
+  void ReadBufferSize(size_t buffer_size) { read_buffer_size_ = buffer_size; }
+  /** \brief Returns the read buffer size. 0 means the default size. */
+  [[nodiscard]] size_t ReadBufferSize() const { return read_buffer_size_; }
+
+  /** \brief Sets max number of threads when reading data.
+   *
+   * The threads decompress DZ blocks and parse large sorted data groups in
+   * parallel. ReadDataParallel() shares the threads between the data groups.
+   * Set it to 1 to read in the calling thread only. Default 0 means the
+   * number of cores.
+   * @param nof_threads Max number of threads.
+   */
+  void ReadThreads(unsigned nof_threads) { read_threads_ = nof_threads; }
+  /** \brief Returns max number of read threads. 0 means number of cores. */
+  [[nodiscard]] unsigned ReadThreads() const { return read_threads_; }
+
+  /** \brief Defers the reading of the channel metadata.
+   *
+   * Files with many channels are slow to open as the conversion (CC),
+   * source information (SI), unit and comment (MD) blocks of all channels
+   * are read. If this property is set before the ReadEverythingButData()
+   * call, these blocks are read when they are accessed. The file is then
+   * opened temporarily if it is closed, so keep the file open when the
+   * metadata of many channels is accessed. Default false.
+   * @param lazy Set to true to defer the reading.
+   */
+  void LazyMetadata(bool lazy) { lazy_metadata_ = lazy; }
+  /** \brief Returns true if the channel metadata is read on demand. */
+  [[nodiscard]] bool LazyMetadata() const { return lazy_metadata_; }
+
   /// Checks if the file was read without errors.
   /// \return True if the file was read OK.
   [[nodiscard]] bool IsOk() const { return static_cast<bool>(instance_); }
@@ -150,6 +217,14 @@ class MdfReader {
   /** \brief Returns the data group (DG) block. */
   [[nodiscard]] IDataGroup* GetDataGroup(size_t order) const;
 
+  /** \brief Returns the channel name index of the file.
+   *
+   * The index is created on the first search and is cleared when the file
+   * blocks are re-read. The index is owned by the reader.
+   * @return Pointer to the index or null if the file isn't an MDF file.
+   */
+  [[nodiscard]] ChannelIndex* GetChannelIndex();
+
   [[nodiscard]] std::string ShortName()
       const;  ///< Returns the file name without paths.
   [[nodiscard]] std::wstring WShortName()
@@ -210,6 +285,22 @@ class MdfReader {
    */
   bool ReadData(IDataGroup& data_group);
 
+  /** \brief Reads in data bytes for several data groups in parallel.
+   *
+   * Reads in the data bytes for a list of data groups (DG) concurrently.
+   * Each data group is read on a worker thread that opens its own stream
+   * buffer (file handle or memory mapping), so the data groups don't compete
+   * for the same file position. The observers of a data group are notified
+   * on the worker thread that reads the group. An observer shall therefore
+   * only be attached to one of the data groups in the list.
+   *
+   * If the reader was created from an external stream buffer, the data
+   * groups are read one by one.
+   * @param data_group_list List of data groups to read.
+   * @return True if all data groups were read successfully.
+   */
+  bool ReadDataParallel(const DataGroupList& data_group_list);
+
   bool ReadInDataBuffer(int64_t data_position, uint64_t nof_bytes,
     std::vector<uint8_t>& destination);
 
@@ -235,6 +326,56 @@ class MdfReader {
   bool ReadPartialData(IDataGroup& data_group, size_t min_sample,
                        size_t max_sample);
 
+  /** \brief Reads the samples within a time range.
+   *
+   * Reads the samples of a data group (DG) that have a master channel value
+   * within the time range. The first and last sample of each channel group
+   * are found by a binary search over the master channel, so only a few
+   * records are read before the actual range is read. Unsorted data groups
+   * use the sample index to locate the records. The index is created if it
+   * doesn't exist, see CreateSampleIndex().
+   *
+   * Channel groups without a master channel are not read.
+   * @param data_group Reference to the data group (DG) object.
+   * @param t_start Start time (master channel value).
+   * @param t_stop Stop time (master channel value).
+   * @return True if the read was successful.
+   */
+  bool ReadTimeRange(IDataGroup& data_group, double t_start, double t_stop);
+
+  /** \brief Creates a sample index for a data group.
+   *
+   * An unsorted data group stores records from several channel groups, so
+   * a partial read must normally scan all records before the requested
+   * range. The function scans the data group once and stores a checkpoint
+   * every N samples per channel group. The ReadPartialData() function then
+   * starts at the nearest checkpoint. The index may be saved to a sidecar
+   * file, see SaveSampleIndex().
+   * @param data_group Reference to the data group (DG) object.
+   * @param sample_interval Number of samples between checkpoints.
+   * @return True if the index was created.
+   */
+  bool CreateSampleIndex(IDataGroup& data_group,
+                         uint64_t sample_interval = 10'000);
+
+  /** \brief Saves all sample indexes to an index file.
+   *
+   * @param index_file Index file. Default is the MDF file name with an
+   * extra '.idx' extension.
+   * @return True if the file was saved.
+   */
+  bool SaveSampleIndex(const std::string& index_file = {}) const;
+
+  /** \brief Loads the sample indexes from an index file.
+   *
+   * The file information blocks must be read before this call. Indexes that
+   * doesn't match the data groups are ignored.
+   * @param index_file Index file. Default is the MDF file name with an
+   * extra '.idx' extension.
+   * @return True if the index file was loaded.
+   */
+  bool LoadSampleIndex(const std::string& index_file = {});
+
   /** \brief Reads in data bytes to a sample reduction (SR) block.
    *
    * To minimíze the use of time and memory, this function reads in
@@ -283,12 +424,17 @@ class MdfReader {
   std::unique_ptr<MdfFile> instance_;  ///< Pointer to the MDF file object.
   int64_t index_ = 0;  ///< Unique (database) file index that can be used to
                        ///< identify a file instead of its path.
+  size_t read_buffer_size_ = 0; ///< Read buffer size. 0 = default size.
+  unsigned read_threads_ = 0; ///< Max read threads. 0 = number of cores.
+  bool lazy_metadata_ = false; ///< Read channel metadata on first access.
+  std::unique_ptr<ChannelIndex> channel_index_; ///< Channel name index.
 
   /** \brief Reads in the
    *
    */
   void VerifyMdfFile();
-
+  /** \brief Gives the header block access to the file. */
+  void SetLazyMetadata();
 };
 
 }  // namespace mdf
@@ -19,6 +19,7 @@ public:
   SampleRecordObserver(const IDataGroup& data_group,
                        const IChannelGroup& channel_group,
                        uint64_t base_time);
+  using ISampleObserver::OnSample;
   bool OnSample(uint64_t sample, uint64_t record_id,
             const std::vector<uint8_t>& record) override;
   virtual void OnSampleRecord() = 0;
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+/** \file span.h
+ * \brief Simple non-owning view of a contiguous sequence of objects.
+ */
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace mdf {
+
+/** \class Span span.h "mdf/span.h"
+ * \brief Non-owning view of contiguous memory.
+ *
+ * The library is built with C++17, so std::span is not available. This class
+ * implements the small subset of std::span that the library interfaces need.
+ * The view doesn't own the memory, so it shall not be stored outside the call
+ * that it was passed to.
+ * @tparam T Type of element. Use a const type for read-only views.
+ */
+template <typename T>
+class Span {
+ public:
+  using element_type = T;
+  using value_type = std::remove_cv_t<T>;
+  using pointer = T*;
+  using reference = T&;
+  using iterator = T*;
+
+  constexpr Span() noexcept = default; ///< Creates an empty view.
+
+  /** \brief Creates a view of a memory range. */
+  constexpr Span(T* data, size_t size) noexcept : data_(data), size_(size) {}
+
+  /** \brief Creates a view of a vector. */
+  template <typename V = value_type,
+            typename = std::enable_if_t<std::is_const_v<T>, V>>
+  Span(const std::vector<V>& list) noexcept // NOLINT
+      : data_(list.data()), size_(list.size()) {}
+
+  /** \brief Creates a mutable view of a vector. */
+  Span(std::vector<value_type>& list) noexcept // NOLINT
+      : data_(list.data()), size_(list.size()) {}
+
+  /** \brief Returns a pointer to the first element. */
+  [[nodiscard]] constexpr pointer data() const noexcept { return data_; }
+  /** \brief Returns number of elements. */
+  [[nodiscard]] constexpr size_t size() const noexcept { return size_; }
+  /** \brief Returns true if the view is empty. */
+  [[nodiscard]] constexpr bool empty() const noexcept { return size_ == 0; }
+
+  [[nodiscard]] constexpr iterator begin() const noexcept { return data_; }
+  [[nodiscard]] constexpr iterator end() const noexcept {
+    return data_ + size_;
+  }
+
+  /** \brief Returns an element without any range check. */
+  constexpr reference operator[](size_t index) const { return data_[index]; }
+
+  /** \brief Returns a view of a part of this view.
+   *
+   * @param offset Index of the first element.
+   * @param count Number of elements.
+   * @return A view of the sub-range.
+   */
+  [[nodiscard]] constexpr Span subspan(size_t offset, size_t count) const {
+    return {data_ + offset, count};
+  }
+
+ private:
+  T* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+}  // namespace mdf
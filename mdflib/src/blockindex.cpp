@@ -0,0 +1,30 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "blockindex.h"
+
+#include "mdfblock.h"
+
+namespace mdf::detail {
+
+void BlockIndex::Add(MdfBlock& block) {
+  if (block.FilePosition() > 0) {
+    block_list_.try_emplace(block.FilePosition(), &block);
+  }
+}
+
+void BlockIndex::Remove(int64_t position, const MdfBlock& block) {
+  if (const auto itr = block_list_.find(position);
+      itr != block_list_.end() && itr->second == &block) {
+    block_list_.erase(itr);
+  }
+}
+
+MdfBlock* BlockIndex::Find(int64_t position) const {
+  const auto itr = block_list_.find(position);
+  return itr != block_list_.cend() ? itr->second : nullptr;
+}
+
+}  // namespace mdf::detail
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+/** \file
+ * This file defines the file position index of the blocks in a file.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+namespace mdf::detail {
+
+class MdfBlock;
+
+/** \brief Index from file position to block.
+ *
+ * Blocks reference each other by file position (link). Finding the block of
+ * a link by searching the block tree is slow on files with many channels.
+ * The index is owned by the header block and the blocks below the header
+ * add themselves when they are read or written and remove themselves when
+ * they are deleted. A link is then resolved with one lookup.
+ *
+ * Only the first block of a position is stored. Note that the index isn't
+ * thread-safe, same as the rest of the block tree.
+ */
+class BlockIndex final {
+ public:
+  /** \brief Adds a block with its current file position. */
+  void Add(MdfBlock& block);
+
+  /** \brief Removes a block if it is stored at the position.
+   *
+   * @param position File position that the block was added with.
+   * @param block Block to remove.
+   */
+  void Remove(int64_t position, const MdfBlock& block);
+
+  /** \brief Returns the block at a file position or null if missing. */
+  [[nodiscard]] MdfBlock* Find(int64_t position) const;
+
+  [[nodiscard]] size_t Size() const { return block_list_.size(); }
+
+ private:
+  std::unordered_map<int64_t, MdfBlock*> block_list_;
+};
+
+}  // namespace mdf::detail
@@ -112,6 +112,7 @@ void Cc3Block::Type(ConversionType type) {
       conversion_type_ = 0xFFFF;
       break;
   }
+  ResetLookupTable();
 }
 
 ConversionType Cc3Block::Type() const {
@@ -271,6 +272,7 @@ uint64_t Cc3Block::Read(std::streambuf& buffer) {
       conv.text = temp.Text();
     }
   }
+  ResetLookupTable();
   return bytes;
 }
 
@@ -360,6 +362,7 @@ uint64_t Cc3Block::Write(std::streambuf& buffer) {
       bytes += WriteNumber(buffer, nof_values_);
       break;
   }
+  ResetLookupTable();
   UpdateBlockSize(buffer, bytes);
   return bytes;
 }
@@ -380,13 +383,14 @@ void Cc3Block::CopyFrom(const IChannelConversion &source) {
 
 bool Cc3Block::ConvertValueToText(double channel_value,
                                   std::string &eng_value) const {
-  for (const auto &conv : text_conversion_list_) {
-    if (channel_value == conv.value) {
-      eng_value = conv.text;
-      return true;
-    }
+  const auto &table = LookupTable();
+  const size_t index = table.FindEqual(channel_value);
+  if (index == ConversionTable::kNotFound ||
+      index >= text_conversion_list_.size()) {
+    return false;
   }
-  return false;
+  eng_value = text_conversion_list_[index].text;
+  return true;
 }
 
 bool Cc3Block::ConvertValueRangeToText(double channel_value,
@@ -394,24 +398,45 @@ bool Cc3Block::ConvertValueRangeToText(double channel_value,
   if (text_range_conversion_list_.empty()) {
     return false;
   }
-  for (size_t index = 1; index < text_range_conversion_list_.size(); ++index) {
-    const auto &range = text_range_conversion_list_[index];
-    const double key_min = range.lower;
-    const double key_max = range.upper;
-    if (IsChannelInteger() && channel_value >= key_min &&
-        channel_value <= key_max) {
-      eng_value = range.text;
-      return true;
-    }
-
-    if (IsChannelFloat() && channel_value >= key_min &&
-        channel_value < key_max) {
-      eng_value = range.text;
-      return true;
-    }
+  // The first range is the default value and not in the table.
+  const auto &table = LookupTable();
+  const size_t index = table.FindRange(channel_value);
+  if (index != ConversionTable::kNotFound &&
+      index + 1 < text_range_conversion_list_.size()) {
+    eng_value = text_range_conversion_list_[index + 1].text;
+    return true;
   }
   eng_value = text_range_conversion_list_[0].text;
   return true;
 }
 
+void Cc3Block::CreateLookupTable(ConversionTable &table) const {
+  std::vector<double> key_list;
+  switch (Type()) {
+    case ConversionType::ValueToText:
+      for (const auto &conv : text_conversion_list_) {
+        key_list.push_back(conv.value);
+      }
+      table.CreateKeys(std::move(key_list));
+      break;
+
+    case ConversionType::ValueRangeToText: {
+      std::vector<double> max_list;
+      for (size_t index = 1; index < text_range_conversion_list_.size();
+           ++index) {
+        key_list.push_back(text_range_conversion_list_[index].lower);
+        max_list.push_back(text_range_conversion_list_[index].upper);
+      }
+      table.CreateRanges(std::move(key_list), std::move(max_list), {},
+          ConversionTable::GetRangeType(IsChannelInteger(),
+                                        IsChannelFloat()));
+      break;
+    }
+
+    default:
+      IChannelConversion::CreateLookupTable(table);
+      break;
+  }
+}
+
 }  // namespace mdf::detail
@@ -7,6 +7,7 @@
 #include <string>
 #include <vector>
 
+#include "conversiontable.h"
 #include "mdf/ichannelconversion.h"
 #include "mdfblock.h"
 
@@ -42,6 +43,7 @@ class Cc3Block : public MdfBlock, public IChannelConversion {
                           std::string& eng_value) const override;
   bool ConvertValueRangeToText(double channel_value,
                                std::string& eng_value) const override;
+  void CreateLookupTable(ConversionTable& table) const override;
 
  private:
   bool range_valid_ = false;
@@ -5,6 +5,7 @@
 
 #include "cc4block.h"
 
+#include <algorithm>
 #include <sstream>
 #include <string>
 
@@ -99,7 +100,10 @@ void Cc4Block::Description(const std::string& desc) {
 
 std::string Cc4Block::Description() const { return Comment(); }
 
-void Cc4Block::Type(ConversionType type) { type_ = static_cast<uint8_t>(type); }
+void Cc4Block::Type(ConversionType type) {
+  type_ = static_cast<uint8_t>(type);
+  ResetLookupTable();
+}
 
 ConversionType Cc4Block::Type() const {
   return static_cast<ConversionType>(type_);
@@ -274,6 +278,7 @@ uint64_t Cc4Block::Read(std::streambuf& buffer) {  // NOLINT
       }
     }
   }
+  ResetLookupTable();
   return bytes;
 }
 
@@ -285,6 +290,7 @@ uint64_t Cc4Block::Write(std::streambuf& buffer) {  // NOLINT
 
   nof_references_ = static_cast<uint16_t>(ref_list_.size());
   nof_values_ = static_cast<uint16_t>(value_list_.size());
+  ResetLookupTable();
 
   block_type_ = "##CC";
   block_length_ = 24 + (4 * 8) + (nof_references_ * 8) + 1 + 1 + 2 + 2 + 2 + 8 +
@@ -351,41 +357,12 @@ bool Cc4Block::ConvertValueToText(double channel_value,
   if (ref_list_.empty()) {
     return false;
   }
-  // First iterate to find the ref
-  size_t ref_index = ref_list_.size() - 1;  // Default CC/TX
-  for (uint16_t n = 0; n < nof_values_; ++n) {
-    if (n >= value_list_.size()) {
-      break;
-    }
-    const auto key = Parameter(n);
-    if (channel_value == key) {
-      ref_index = n;
-      break;
-    }
-  }
-  if (ref_index >= ref_list_.size()) {
-    return false;
-  }
-  const auto& block = ref_list_[ref_index];
-  if (!block) {
-    eng_value.clear();
-    eng_value.shrink_to_fit();
-  } else if (block->BlockType() == "TX") {
-    const auto* tx = dynamic_cast<const Tx4Block*>(block.get());
-    if (tx == nullptr) {
-      return false;
-    }
-    eng_value = tx->Text();
-  } else if (block->BlockType() == "CC") {
-    const auto* cc = dynamic_cast<const IChannelConversion*>(block.get());
-    if (cc == nullptr) {
-      return false;
-    }
-    return cc->Convert(channel_value, eng_value);
-  } else {
-    return false;
+  const auto& table = LookupTable();
+  size_t ref_index = table.FindEqual(channel_value);
+  if (ref_index == ConversionTable::kNotFound) {
+    ref_index = ref_list_.size() - 1;  // Default CC/TX
   }
-  return true;
+  return ConvertReference(table, ref_index, channel_value, eng_value);
 }
 
 bool Cc4Block::ConvertValueRangeToText(double channel_value,
@@ -393,52 +370,95 @@ bool Cc4Block::ConvertValueRangeToText(double channel_value,
   if (ref_list_.empty()) {
     return false;
   }
+  const auto& table = LookupTable();
+  size_t ref_index = table.FindRange(channel_value);
+  if (ref_index == ConversionTable::kNotFound) {
+    ref_index = ref_list_.size() - 1;  // Default CC/TX
+  }
+  return ConvertReference(table, ref_index, channel_value, eng_value);
+}
 
-  // First iterate to find the ref
-  size_t ref_index = ref_list_.size() - 1;  // Default CC/TX
-  for (uint16_t n = 0; n < nof_values_; ++n) {
-    const uint16_t key_min_index = n * 2;
-    const uint16_t key_max_index = key_min_index + 1;
-    if (key_max_index >= value_list_.size()) {
+bool Cc4Block::ConvertReference(const ConversionTable& table,
+                                size_t ref_index, double channel_value,
+                                std::string& eng_value) {
+  const auto& text_list = table.TextResults();
+  if (ref_index >= text_list.size()) {
+    return false;
+  }
+  const auto& result = text_list[ref_index];
+  switch (result.Type) {
+    case ConversionTable::TextResult::Kind::Empty:
+      eng_value.clear();
+      eng_value.shrink_to_fit();
       break;
-    }
-    const auto key_min = Parameter(key_min_index);
-    const auto key_max = Parameter(key_max_index);
-    if (IsChannelInteger() && channel_value >= key_min &&
-        channel_value <= key_max) {
-      ref_index = n;
+
+    case ConversionTable::TextResult::Kind::Text:
+      eng_value = result.Text;
+      break;
+
+    case ConversionTable::TextResult::Kind::Conversion:
+      return result.Conversion->Convert(channel_value, eng_value);
+
+    default:
+      return false;
+  }
+  return true;
+}
+
+void Cc4Block::CreateLookupTable(ConversionTable& table) const {
+  std::vector<double> key_list;
+  switch (Type()) {
+    case ConversionType::ValueToText: {
+      const size_t nof_keys = std::min(static_cast<size_t>(nof_values_),
+                                       value_list_.size());
+      for (size_t n = 0; n < nof_keys; ++n) {
+        key_list.push_back(Parameter(static_cast<uint16_t>(n)));
+      }
+      table.CreateKeys(std::move(key_list));
       break;
     }
 
-    if (IsChannelFloat() && channel_value >= key_min &&
-        channel_value < key_max) {
-      ref_index = n;
+    case ConversionType::ValueRangeToText: {
+      const size_t nof_keys = std::min(static_cast<size_t>(nof_values_),
+                                       value_list_.size() / 2);
+      std::vector<double> max_list;
+      for (size_t n = 0; n < nof_keys; ++n) {
+        key_list.push_back(Parameter(static_cast<uint16_t>(n * 2)));
+        max_list.push_back(Parameter(static_cast<uint16_t>((n * 2) + 1)));
+      }
+      table.CreateRanges(std::move(key_list), std::move(max_list), {},
+          ConversionTable::GetRangeType(IsChannelInteger(),
+                                        IsChannelFloat()));
       break;
     }
+
+    default:
+      IChannelConversion::CreateLookupTable(table);
+      return;
   }
-  if (ref_index >= ref_list_.size()) {
-    return false;
-  }
-  const auto& block = ref_list_[ref_index];
-  if (!block) {
-    eng_value.clear();
-    eng_value.shrink_to_fit();
-  } else if (block->BlockType() == "TX") {
-    const auto* tx = dynamic_cast<const Tx4Block*>(block.get());
-    if (tx == nullptr) {
-      return false;
-    }
-    eng_value = tx->Text();
-  } else if (block->BlockType() == "CC") {
-    const auto* cc = dynamic_cast<const IChannelConversion*>(block.get());
-    if (cc == nullptr) {
-      return false;
+
+  // Resolve the text references once.
+  auto& text_list = table.TextResults();
+  text_list.resize(ref_list_.size());
+  for (size_t index = 0; index < ref_list_.size(); ++index) {
+    const auto& block = ref_list_[index];
+    auto& result = text_list[index];
+    if (!block) {
+      result.Type = ConversionTable::TextResult::Kind::Empty;
+    } else if (block->BlockType() == "TX") {
+      const auto* tx = dynamic_cast<const Tx4Block*>(block.get());
+      if (tx != nullptr) {
+        result.Type = ConversionTable::TextResult::Kind::Text;
+        result.Text = tx->Text();
+      }
+    } else if (block->BlockType() == "CC") {
+      const auto* cc = dynamic_cast<const IChannelConversion*>(block.get());
+      if (cc != nullptr) {
+        result.Type = ConversionTable::TextResult::Kind::Conversion;
+        result.Conversion = cc;
+      }
     }
-    return cc->Convert(channel_value, eng_value);
-  } else {
-    return false;
   }
-  return true;
 }
 
 bool Cc4Block::ConvertTextToValue(const std::string& channel_value,
@@ -530,6 +550,7 @@ void Cc4Block::Formula(const std::string& formula) {
       ref_list_[0] = std::move(temp);
     }
   }
+  ResetLookupTable();
   IChannelConversion::Formula(formula);
 }
 
@@ -603,6 +624,7 @@ void Cc4Block::Reference(const uint16_t index, const std::string& text) {
       temp->Text(text);
       ref_list_[index] = std::move(temp);
     }
+    ResetLookupTable();
   } catch (const std::exception& err) {
     MDF_ERROR() << "Failed to add a text reference. Index: "
                 << index << ", Text: " << text << ", Error: " << err.what();
@@ -8,6 +8,7 @@
 
 #include <vector>
 
+#include "conversiontable.h"
 #include "md4block.h"
 #include "mdf/ichannelconversion.h"
 #include "mdfblock.h"
@@ -89,6 +90,7 @@ class Cc4Block : public MdfBlock, public IChannelConversion {
                           double& eng_value) const override;
   bool ConvertTextToTranslation(const std::string& channel_value,
                                 std::string& eng_value) const override;
+  void CreateLookupTable(ConversionTable& table) const override;
 
  private:
   uint8_t type_ = 0;
@@ -103,6 +105,9 @@ class Cc4Block : public MdfBlock, public IChannelConversion {
   std::unique_ptr<Cc4Block> cc_block_;  ///< Inverse conversion block
   std::unique_ptr<Md4Block> unit_;
   RefList ref_list_;
+
+  static bool ConvertReference(const ConversionTable& table, size_t ref_index,
+                               double channel_value, std::string& eng_value);
 };
 
 }  // namespace mdf::detail
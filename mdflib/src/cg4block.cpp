@@ -62,9 +62,13 @@ Cg4Block::Cg4Block() {
 
 int64_t Cg4Block::Index() const { return FilePosition(); }
 
-void Cg4Block::Name(const std::string &name) { acquisition_name_ = name; }
+void Cg4Block::Name(const std::string &name) {
+  acquisition_name_ = MakePoolString(name);
+}
 
-std::string Cg4Block::Name() const { return acquisition_name_; }
+std::string Cg4Block::Name() const {
+  return std::string(ToStringView(acquisition_name_));
+}
 
 void Cg4Block::Description(const std::string &description) {
   md_comment_ = std::make_unique<Md4Block>(description);
@@ -116,7 +120,7 @@ void Cg4Block::GetBlockProperty(BlockPropertyList &dest) const {
                     "Link to next channel group", BlockItemType::LinkItem);
   dest.emplace_back("First CN", ToHexString(Link(kIndexCn)),
                     "Link to first channel", BlockItemType::LinkItem);
-  dest.emplace_back("Name TX", ToHexString(Link(kIndexName)), acquisition_name_,
+  dest.emplace_back("Name TX", ToHexString(Link(kIndexName)), Name(),
                     BlockItemType::LinkItem);
   dest.emplace_back("Source SI", ToHexString(Link(kIndexSi)),
                     "Link to source information", BlockItemType::LinkItem);
@@ -129,7 +133,7 @@ void Cg4Block::GetBlockProperty(BlockPropertyList &dest) const {
   dest.emplace_back("Information", "", "", BlockItemType::HeaderItem);
 
   if (Link(kIndexName) > 0) {
-    dest.emplace_back("Name", acquisition_name_);
+    dest.emplace_back("Name", Name());
   }
   dest.emplace_back("Nof Channels", std::to_string(cn_list_.size()));
   dest.emplace_back("Nof SR", std::to_string(sr_list_.size()));
@@ -173,7 +177,7 @@ uint64_t Cg4Block::Read(std::streambuf& buffer) {
   bytes += ReadNumber(buffer, nof_data_bytes_);
   bytes += ReadNumber(buffer, nof_invalid_bytes_);
 
-  acquisition_name_ = ReadTx4(buffer, kIndexName);
+  acquisition_name_ = ReadPoolTx4(buffer, kIndexName);
   if (Link(kIndexSi) > 0) {
     SetFilePosition(buffer, Link(kIndexSi));
     si_block_ = std::make_unique<Si4Block>();
@@ -200,7 +204,7 @@ uint64_t Cg4Block::Write(std::streambuf& buffer) {
 
   WriteLink4List(buffer, cn_list_, kIndexCn,
                  UpdateOption::DoNotUpdateWrittenBlock);
-  WriteTx4(buffer, kIndexName, acquisition_name_);
+  WriteTx4(buffer, kIndexName, Name());
   WriteBlock4(buffer, si_block_, kIndexSi);
   WriteLink4List(buffer, sr_list_, kIndexSr,
                  UpdateOption::DoNotUpdateWrittenBlock);
@@ -428,7 +432,23 @@ IChannel *Cg4Block::CreateChannel() {
   return cn_list_.empty() ? nullptr : cn_list_.back().get();
 }
 
+std::shared_ptr<const DecodePlan> Cg4Block::GetDecodePlan() const {
+  std::lock_guard lock(decode_plan_mutex_);
+  if (!decode_plan_) {
+    auto plan = std::make_shared<DecodePlan>();
+    plan->Create(*this);
+    decode_plan_ = std::move(plan);
+  }
+  return decode_plan_;
+}
+
 void Cg4Block::PrepareForWriting() {
+  {
+    // The channel layout is recalculated, so a new plan is needed. Existing
+    // observers keep the old plan.
+    std::lock_guard lock(decode_plan_mutex_);
+    decode_plan_.reset();
+  }
   nof_data_bytes_ = 0;
   vlsd_index_ = 0;
   if (Flags() & CgFlag::VlsdChannel) {
@@ -744,7 +764,7 @@ void Cg4Block::CopyFrom(const IChannelGroup& source) {
     path_separator_ = cg4->path_separator_;
     nof_data_bytes_ = cg4->nof_data_bytes_;
     nof_invalid_bytes_ = cg4->nof_invalid_bytes_;
-    acquisition_name_ = cg4->acquisition_name_;
+    Name(cg4->Name());
   }
   if (const auto total_size = nof_invalid_bytes_ + nof_data_bytes_;
       total_size > 0) {
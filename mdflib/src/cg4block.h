@@ -4,6 +4,7 @@
  */
 #pragma once
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -13,6 +14,7 @@
 #include "mdfblock.h"
 #include "si4block.h"
 #include "cn4block.h"
+#include "decodeplan.h"
 #include "sr4block.h"
 namespace mdf::detail {
 
@@ -91,6 +93,14 @@ class Cg4Block : public MdfBlock, public IChannelGroup {
   }
   void PrepareForWriting();
 
+  /** \brief Returns the decode plan of the channel group.
+   *
+   * The plan is created on first use. The observers keep a reference to the
+   * plan, so their decoders stay valid if the plan is replaced when the
+   * channel layout changes.
+   */
+  [[nodiscard]] std::shared_ptr<const DecodePlan> GetDecodePlan() const;
+
   uint32_t NofDataBytes() const {
     return nof_data_bytes_;
   }
@@ -124,7 +134,7 @@ class Cg4Block : public MdfBlock, public IChannelGroup {
   uint32_t nof_data_bytes_ = 0;
   uint32_t nof_invalid_bytes_ = 0;
 
-  std::string acquisition_name_;
+  PoolString acquisition_name_;
   std::unique_ptr<Si4Block> si_block_;
   Cn4List cn_list_;
   Sr4List sr_list_;
@@ -133,6 +143,9 @@ class Cg4Block : public MdfBlock, public IChannelGroup {
   int64_t nof_data_position_ = 0; ///< File position for lower VLSD 32-bit
   int64_t nof_invalid_position_ = 0;///< File position for higher VLSD 32-bit
   uint64_t vlsd_index_ = 0; ///< Index Counter that holds the next free VLSD index
+  /** \brief Pre-resolved channel decoders. Created on first use. */
+  mutable std::shared_ptr<const DecodePlan> decode_plan_;
+  mutable std::mutex decode_plan_mutex_; ///< Protects the lazy creation.
 
 };
 
@@ -19,6 +19,16 @@ class CgRange final {
   void IsUsed(bool used) { is_used_ = used;}
   [[nodiscard]] bool IsUsed() const { return is_used_;}
 
+  /** \brief Sample range of this channel group.
+   *
+   * The range is by default the data group range but a time range read
+   * sets a separate range for each channel group.
+   */
+  void MinSample(size_t min_sample) { min_sample_ = min_sample; }
+  [[nodiscard]] size_t MinSample() const { return min_sample_; }
+  void MaxSample(size_t max_sample) { max_sample_ = max_sample; }
+  [[nodiscard]] size_t MaxSample() const { return max_sample_; }
+
   [[nodiscard]] const IChannelGroup& ChannelGroup() const {
     return channel_group_;
   }
@@ -26,6 +36,8 @@ class CgRange final {
  private:
   const IChannelGroup& channel_group_;
   bool is_used_ = false;
+  size_t min_sample_ = 0;
+  size_t max_sample_ = 0;
 };
 
 }  // namespace mdf
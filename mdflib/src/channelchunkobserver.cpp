@@ -0,0 +1,196 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "mdf/channelchunkobserver.h"
+
+#include <algorithm>
+
+#include "mdf/ichannelgroup.h"
+#include "mdf/ichannelconversion.h"
+#include "cg4block.h"
+#include "decodeplan.h"
+
+namespace mdf {
+
+ChannelChunkObserver::ChannelChunkObserver(const IDataGroup& data_group,
+                                           const IChannelGroup& group,
+                                           const IChannel& channel,
+                                           size_t chunk_size)
+    : ISampleObserver(data_group),
+      group_(group),
+      channel_(channel),
+      record_id_(group.RecordId()),
+      array_size_(std::max<uint64_t>(channel.ArraySize(), 1)),
+      chunk_size_(std::max<size_t>(chunk_size, 1)) {
+  // Only the channels own records are needed.
+  record_id_list_.clear();
+  record_id_list_.insert(record_id_);
+
+  if (const auto* cg4 = dynamic_cast<const detail::Cg4Block*>(&group_);
+      cg4 != nullptr) {
+    decode_plan_ = cg4->GetDecodePlan();
+    decoder_ = decode_plan_->GetDecoder(channel_);
+  }
+  const auto buffer_size = static_cast<size_t>(chunk_size_ * array_size_);
+  channel_list_.resize(buffer_size, 0.0);
+  valid_list_.resize(buffer_size, 0);
+}
+
+ChannelChunkObserver::~ChannelChunkObserver() {
+  ChannelChunkObserver::DetachObserver();
+}
+
+uint64_t ChannelChunkObserver::NofSamples() const {
+  return group_.NofSamples();
+}
+
+bool ChannelChunkObserver::Flush() {
+  if (nof_samples_ == 0) {
+    return true;
+  }
+  const auto count = static_cast<size_t>(nof_samples_ * array_size_);
+  const uint64_t first_sample = first_sample_;
+  first_sample_ += nof_samples_;
+  nof_samples_ = 0;
+
+  Span<const double> values(channel_list_.data(), count);
+  const auto* conversion = channel_.ChannelConversion();
+  if (convert_ && conversion != nullptr &&
+      conversion->Type() != ConversionType::NoConversion) {
+    eng_list_.resize(channel_list_.size(), 0.0);
+    eng_valid_list_.resize(valid_list_.size(), 0);
+    conversion->ConvertBatch(values, Span<double>(eng_list_.data(), count),
+                             Span<uint8_t>(eng_valid_list_.data(), count));
+    for (size_t index = 0; index < count; ++index) {
+      valid_list_[index] &= eng_valid_list_[index];
+    }
+    values = Span<const double>(eng_list_.data(), count);
+  }
+  return !OnChunk ||
+         OnChunk(first_sample, values,
+                 Span<const uint8_t>(valid_list_.data(), count));
+}
+
+bool ChannelChunkObserver::PrepareSample(uint64_t sample) {
+  // A chunk only holds samples that follow each other.
+  if (nof_samples_ > 0 && sample != first_sample_ + nof_samples_ &&
+      !Flush()) {
+    return false;
+  }
+  if (nof_samples_ == 0) {
+    first_sample_ = sample;
+  }
+  return true;
+}
+
+bool ChannelChunkObserver::SampleAdded() {
+  if (nof_samples_ >= chunk_size_ ||
+      first_sample_ + nof_samples_ >= NofSamples()) {
+    return Flush();
+  }
+  return true;
+}
+
+void ChannelChunkObserver::DecodeRecord(size_t position,
+                                        const uint8_t* record, size_t size) {
+  const auto first_index = static_cast<size_t>(position * array_size_);
+  for (uint64_t array_index = 0; array_index < array_size_; ++array_index) {
+    const auto index = first_index + static_cast<size_t>(array_index);
+    valid_list_[index] = decoder_->Decode(record, size, array_index,
+                                          channel_list_[index]) ? 1 : 0;
+  }
+}
+
+bool ChannelChunkObserver::OnSample(uint64_t sample, uint64_t record_id,
+                                    const std::vector<uint8_t>& record) {
+  if (record_id != record_id_) {
+    return true;
+  }
+  if (!PrepareSample(sample)) {
+    return false;
+  }
+  if (decoder_ != nullptr) {
+    DecodeRecord(nof_samples_, record.data(), record.size());
+  } else {
+    const auto first_index = static_cast<size_t>(nof_samples_ * array_size_);
+    for (uint64_t array_index = 0; array_index < array_size_; ++array_index) {
+      const auto index = first_index + static_cast<size_t>(array_index);
+      double value = 0.0;
+      valid_list_[index] = GetChannelValue(channel_, sample, record, value,
+                                           array_index) ? 1 : 0;
+      channel_list_[index] = value;
+    }
+  }
+  ++nof_samples_;
+  return SampleAdded();
+}
+
+bool ChannelChunkObserver::OnSample(uint64_t sample, uint64_t record_id,
+                                    Span<const uint8_t> record) {
+  if (decoder_ == nullptr) {
+    // Needs a record buffer.
+    return ISampleObserver::OnSample(sample, record_id, record);
+  }
+  if (record_id != record_id_) {
+    return true;
+  }
+  if (!PrepareSample(sample)) {
+    return false;
+  }
+  DecodeRecord(nof_samples_, record.data(), record.size());
+  ++nof_samples_;
+  return SampleAdded();
+}
+
+bool ChannelChunkObserver::OnSampleBlock(uint64_t first_sample,
+                                         uint64_t record_id,
+                                         Span<const uint8_t> records,
+                                         size_t record_size) {
+  if (decoder_ == nullptr) {
+    return ISampleObserver::OnSampleBlock(first_sample, record_id, records,
+                                          record_size);
+  }
+  if (record_id != record_id_ || record_size == 0) {
+    return true;
+  }
+
+  // Decode the records directly into the chunk buffer, one chunk at the
+  // time.
+  const size_t nof_records = records.size() / record_size;
+  for (size_t record = 0; record < nof_records;) {
+    if (!PrepareSample(first_sample + record)) {
+      return false;
+    }
+    const size_t count = std::min(chunk_size_ - nof_samples_,
+                                  nof_records - record);
+    const uint8_t* first = records.data() + (record * record_size);
+    if (array_size_ == 1 &&
+        decoder_->DecodeColumn(first, record_size, count,
+                               channel_list_.data() + nof_samples_)) {
+      auto* valid = valid_list_.data() + nof_samples_;
+      if (!decoder_->HasInvalidBit()) {
+        std::fill_n(valid, count, 1);
+      } else {
+        for (size_t index = 0; index < count; ++index) {
+          valid[index] = decoder_->IsValid(first + (index * record_size),
+                                           record_size, 0) ? 1 : 0;
+        }
+      }
+    } else {
+      for (size_t index = 0; index < count; ++index) {
+        DecodeRecord(nof_samples_ + index, first + (index * record_size),
+                     record_size);
+      }
+    }
+    nof_samples_ += count;
+    record += count;
+    if (!SampleAdded()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace mdf
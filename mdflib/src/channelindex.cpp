@@ -0,0 +1,172 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "mdf/channelindex.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "mdf/cncomment.h"
+#include "mdf/ichannel.h"
+#include "mdf/ichannelgroup.h"
+#include "mdf/idatagroup.h"
+#include "mdf/mdffile.h"
+#include "mdf/mdflogstream.h"
+
+namespace {
+
+std::string ToLowerKey(std::string_view name) {
+  std::string key(name);
+  std::transform(key.begin(), key.end(), key.begin(), [](unsigned char in) {
+    return static_cast<char>(std::tolower(in));
+  });
+  return key;
+}
+
+}  // namespace
+
+namespace mdf {
+
+ChannelIndex::ChannelIndex(const MdfFile& file) : file_(file) {}
+
+void ChannelIndex::IndexDisplayNames(bool index) {
+  if (display_names_ != index) {
+    display_names_ = index;
+    Clear();
+  }
+}
+
+void ChannelIndex::IndexAlternativeNames(bool index) {
+  if (alternative_names_ != index) {
+    alternative_names_ = index;
+    Clear();
+  }
+}
+
+void ChannelIndex::Clear() {
+  std::scoped_lock lock(index_mutex_);
+  name_list_.clear();
+  item_list_.clear();
+  created_ = false;
+}
+
+size_t ChannelIndex::Size() const {
+  std::scoped_lock lock(index_mutex_);
+  CreateIndex();
+  return name_list_.size();
+}
+
+std::vector<ChannelIndexItem> ChannelIndex::FindAll(
+    std::string_view name) const {
+  std::scoped_lock lock(index_mutex_);
+  CreateIndex();
+
+  std::vector<size_t> index_list;
+  const auto [first, last] = name_list_.equal_range(ToLowerKey(name));
+  for (auto itr = first; itr != last; ++itr) {
+    index_list.push_back(itr->second);
+  }
+  // The multimap doesn't keep the insert order.
+  std::sort(index_list.begin(), index_list.end());
+
+  std::vector<ChannelIndexItem> list;
+  list.reserve(index_list.size());
+  for (const size_t index : index_list) {
+    list.push_back(item_list_[index]);
+  }
+  return list;
+}
+
+bool ChannelIndex::Find(std::string_view name, ChannelIndexItem& item) const {
+  const auto list = FindAll(name);
+  bool found = false;
+  uint64_t nof_samples = 0;
+  for (const auto& match : list) {
+    if (nof_samples <= match.ChannelGroup->NofSamples()) {
+      nof_samples = match.ChannelGroup->NofSamples();
+      item = match;
+      found = true;
+    }
+  }
+  return found;
+}
+
+void ChannelIndex::CreateIndex() const {
+  if (created_) {
+    return;
+  }
+  created_ = true;
+
+  DataGroupList dg_list;
+  file_.DataGroups(dg_list);
+  for (auto* data_group : dg_list) {
+    if (data_group == nullptr) {
+      continue;
+    }
+    const auto cg_list = data_group->ChannelGroups();
+    for (const auto* channel_group : cg_list) {
+      if (channel_group == nullptr) {
+        continue;
+      }
+      const auto cn_list = channel_group->Channels();
+      for (const auto* channel : cn_list) {
+        if (channel == nullptr) {
+          continue;
+        }
+        const size_t item = item_list_.size();
+        item_list_.push_back({data_group, channel_group, channel});
+        if (!display_names_ && !alternative_names_) {
+          AddName(channel->NameView(), item);
+          continue;
+        }
+
+        std::vector<std::string> key_list;
+        key_list.push_back(ToLowerKey(channel->NameView()));
+        if (display_names_) {
+          key_list.push_back(ToLowerKey(channel->DisplayName()));
+        }
+        if (alternative_names_) {
+          AddCommentNames(*channel, key_list);
+        }
+        // The same name may exist as both channel and alternative name.
+        std::sort(key_list.begin(), key_list.end());
+        key_list.erase(std::unique(key_list.begin(), key_list.end()),
+                       key_list.end());
+        for (const auto& key : key_list) {
+          AddName(key, item);
+        }
+      }
+    }
+  }
+}
+
+void ChannelIndex::AddCommentNames(const IChannel& channel,
+                                   std::vector<std::string>& key_list) const {
+  try {
+    CnComment comment;
+    channel.GetCnComment(comment);
+    const auto& names = comment.Names();
+    key_list.push_back(ToLowerKey(names.DefaultName()));
+    for (const auto& alternative : names.AlternativeNames()) {
+      key_list.push_back(ToLowerKey(alternative.Text()));
+    }
+    if (display_names_) {
+      for (const auto& display : names.DisplayNames()) {
+        key_list.push_back(ToLowerKey(display.Text()));
+      }
+    }
+  } catch (const std::exception& err) {
+    MDF_ERROR() << "Failed to read the channel comment. Channel: "
+                << channel.Name() << ", Error: " << err.what();
+  }
+}
+
+void ChannelIndex::AddName(std::string_view name, size_t item) const {
+  if (!name.empty()) {
+    name_list_.emplace(ToLowerKey(name), item);
+  }
+}
+
+}  // namespace mdf
@@ -12,7 +12,7 @@ bool ChannelObserver<std::vector<uint8_t>>::GetSampleUnsigned(
   const auto array_size = channel_.ArraySize();
   const auto sample_index = static_cast<size_t>( (sample * array_size) + array_index );
   value = 0; // value_list is a byte array
-  return sample_index < valid_list_.size() && valid_list_[sample_index];
+  return IsValidIndex(sample_index);
 }
 
 template <>
@@ -23,7 +23,7 @@ bool ChannelObserver<std::string>::GetSampleUnsigned(uint64_t sample,
   const auto sample_index = static_cast<size_t>( (sample * array_size) + array_index );
   // Convert the string to an unsigned value
   value = sample_index < value_list_.size() ? std::stoull(value_list_[sample_index]) : 0;
-  return sample_index < valid_list_.size() && valid_list_[sample_index];
+  return IsValidIndex(sample_index);
 }
 
 template <>
@@ -32,7 +32,7 @@ bool ChannelObserver<std::vector<uint8_t>>::GetSampleSigned(
   const auto array_size = channel_.ArraySize();
   const auto sample_index = static_cast<size_t>( (sample * array_size) + array_index );
   value = 0; // value_list is a byte array
-  return sample_index < valid_list_.size() && valid_list_[sample_index];
+  return IsValidIndex(sample_index);
 }
 
 template <>
@@ -42,7 +42,7 @@ bool ChannelObserver<std::string>::GetSampleSigned(uint64_t sample,
   const auto array_size = channel_.ArraySize();
   const auto sample_index = static_cast<size_t>( (sample * array_size) + array_index );
   value = sample_index < value_list_.size() ? std::stoll(value_list_[sample_index]) : 0;
-  return sample_index < valid_list_.size() && valid_list_[sample_index];
+  return IsValidIndex(sample_index);
 }
 
 template <>
@@ -51,7 +51,7 @@ bool ChannelObserver<std::vector<uint8_t>>::GetSampleFloat(
   const auto array_size = channel_.ArraySize();
   const auto sample_index = static_cast<size_t>((sample * array_size) + array_index);
   value = 0.0; // value_list is a byte array
-  return sample_index < valid_list_.size() && valid_list_[sample_index];
+  return IsValidIndex(sample_index);
 }
 
 template <>
@@ -61,7 +61,7 @@ bool ChannelObserver<std::string>::GetSampleFloat(uint64_t sample,
   const auto array_size = channel_.ArraySize();
   const auto sample_index = static_cast<size_t>( (sample * array_size) + array_index );
   value = sample_index < value_list_.size() ? std::stod(value_list_[sample_index]) : 0;
-  return sample_index < valid_list_.size() && valid_list_[sample_index];
+  return IsValidIndex(sample_index);
 }
 
 template <>
@@ -79,7 +79,7 @@ bool ChannelObserver<std::vector<uint8_t>>::GetSampleText(
     }
   }
   value = s.str();
-  return sample_index < valid_list_.size() && valid_list_[sample_index];
+  return IsValidIndex(sample_index);
 }
 
 template <>
@@ -88,7 +88,7 @@ bool ChannelObserver<std::vector<uint8_t>>::GetSampleByteArray(
   if (sample < value_list_.size()) {
     value = value_list_[static_cast<size_t>(sample)];
   }
-  return sample < valid_list_.size() && valid_list_[static_cast<size_t>(sample)];
+  return IsValidIndex(static_cast<size_t>(sample));
 }
 
 }  // namespace mdf::detail
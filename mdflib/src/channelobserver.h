@@ -4,11 +4,18 @@
  */
 #pragma once
 #include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "mdf/ichannelgroup.h"
 #include "mdf/idatagroup.h"
 #include "mdf/ichannelobserver.h"
+#include "cg4block.h"
 
 
 namespace mdf::detail {
@@ -21,8 +28,210 @@ class ChannelObserver : public IChannelObserver {
 
   const IChannelGroup& group_;       ///< Reference to the channel group (CG) block.
 
+  /** \brief Decoder from the channel groups decode plan.
+   *
+   * Numeric MDF 4 channels are decoded by a pre-resolved decoder. The
+   * pointer is null for all other channels.
+   */
+  const ValueDecoder* decoder_ = nullptr;
+  std::shared_ptr<const DecodePlan> decode_plan_; ///< Owns the decoder.
+
+  /** \brief Ranges [first, last) of read samples.
+   *
+   * A channel without invalidation bit is valid if the sample is read, so
+   * the observer only stores the ranges of read samples instead of a valid
+   * flag per sample. Records read one by one arrive in order and extend the
+   * last range. The valid list is only created if it is requested.
+   */
+  mutable std::vector<std::pair<uint64_t, uint64_t>> valid_range_list_;
+  mutable std::atomic<bool> compact_valid_ = false; ///< Uses the ranges.
+  mutable std::mutex valid_mutex_;
+
+  [[nodiscard]] bool IsValidIndex(size_t sample_index) const {
+    if (compact_valid_.load(std::memory_order_acquire)) {
+      const auto itr = std::upper_bound(valid_range_list_.cbegin(),
+          valid_range_list_.cend(), static_cast<uint64_t>(sample_index),
+          [] (uint64_t sample, const auto& range) {
+        return sample < range.first;
+      });
+      return itr != valid_range_list_.cbegin() &&
+             sample_index < std::prev(itr)->second;
+    }
+    return sample_index < valid_list_.size() && valid_list_[sample_index];
+  }
+
+  /** \brief Adds a range of valid samples. Used by the parallel reads. */
+  void AddValidRange(uint64_t first, uint64_t count) {
+    std::lock_guard lock(valid_mutex_);
+    if (!compact_valid_.load(std::memory_order_acquire)) {
+      std::fill_n(valid_list_.begin() + static_cast<int64_t>(first), count,
+                  true);
+      return;
+    }
+    const uint64_t last = first + count;
+    auto& list = valid_range_list_;
+    // The samples are normally added in order, so try the last range first.
+    if (list.empty() || list.back().second < first) {
+      list.emplace_back(first, last);
+      return;
+    }
+    if (list.back().first <= first) {
+      list.back().second = std::max(list.back().second, last);
+      return;
+    }
+    auto itr = std::lower_bound(list.begin(), list.end(), first,
+                                [] (const auto& range, uint64_t sample) {
+      return range.first < sample;
+    });
+    itr = list.emplace(itr, first, last);
+    if (itr != list.begin() && std::prev(itr)->second >= itr->first) {
+      --itr;
+      itr->second = std::max(itr->second, std::next(itr)->second);
+      list.erase(std::next(itr));
+    }
+    while (std::next(itr) != list.end() &&
+           std::next(itr)->first <= itr->second) {
+      itr->second = std::max(itr->second, std::next(itr)->second);
+      list.erase(std::next(itr));
+    }
+  }
+
+  /** \brief Adds a valid sample that is read record by record.
+   *
+   * The records are read one by one by a single thread and in sample
+   * order, so the last range is extended without a lock.
+   */
+  void AddValidSample(uint64_t sample) {
+    auto& list = valid_range_list_;
+    if (!list.empty() && list.back().second == sample) {
+      ++list.back().second;
+    } else if (list.empty() || list.back().second < sample) {
+      list.emplace_back(sample, sample + 1);
+    } else {
+      AddValidRange(sample, 1); // Sample is already read
+    }
+  }
+
+  /** \brief Replaces the valid ranges with a valid flag per sample. */
+  void ExpandValidList() const {
+    std::lock_guard lock(valid_mutex_);
+    if (!compact_valid_.load(std::memory_order_acquire)) {
+      return;
+    }
+    valid_list_.assign(value_list_.size(), false);
+    for (const auto& [first, last] : valid_range_list_) {
+      const auto end = std::min(last, static_cast<uint64_t>(valid_list_.size()));
+      for (uint64_t sample = first; sample < end; ++sample) {
+        valid_list_[static_cast<size_t>(sample)] = true;
+      }
+    }
+    valid_range_list_.clear();
+    compact_valid_.store(false, std::memory_order_release);
+  }
+
+  /** \brief Decodes a single value without invalidation bit.
+   *
+   * @return True if the value is valid and stored.
+   */
+  bool DecodeValue(uint64_t sample, const uint8_t* record, size_t size) {
+    if constexpr (std::is_arithmetic_v<T>) {
+      const auto sample_index = static_cast<size_t>(sample);
+      T value{};
+      const bool valid = decoder_->Decode(record, size, 0, value);
+      if (sample_index < value_list_.size()) {
+        value_list_[sample_index] = value;
+        return valid;
+      }
+    }
+    return false;
+  }
+
+  void DecodeRecord(uint64_t sample, const uint8_t* record, size_t size) {
+    if constexpr (std::is_arithmetic_v<T>) {
+      if (compact_valid_.load(std::memory_order_acquire)) {
+        // Single value without invalidation bit. Keep the ranges compact.
+        if (DecodeValue(sample, record, size)) {
+          AddValidSample(sample);
+        }
+        return;
+      }
+      const auto array_size = decoder_->ArraySize();
+      for (uint64_t array_index = 0; array_index < array_size; ++array_index) {
+        const auto sample_index = static_cast<size_t>((sample * array_size) + array_index);
+        T value{};
+        const bool valid = decoder_->Decode(record, size, array_index, value);
+        if (sample_index < value_list_.size()) {
+          value_list_[sample_index] = value;
+        }
+        if (sample_index < valid_list_.size()) {
+          valid_list_[sample_index] = valid;
+        }
+      }
+    }
+  }
+
+  void DecodeColumn(uint64_t first_sample, const uint8_t* records,
+                    size_t record_size, size_t nof_records) {
+    if constexpr (std::is_arithmetic_v<T>) {
+      const auto first = static_cast<size_t>(first_sample);
+      if (decoder_->ArraySize() == 1 && first < value_list_.size()) {
+        const size_t count = std::min(nof_records, value_list_.size() - first);
+        if (decoder_->DecodeColumn(records, record_size, count,
+                                   value_list_.data() + first)) {
+          if (!decoder_->HasInvalidBit()) {
+            AddValidRange(first, count);
+          } else {
+            const auto valid_begin = valid_list_.begin() +
+                                     static_cast<int64_t>(first);
+            for (size_t record = 0; record < count; ++record) {
+              valid_begin[static_cast<int64_t>(record)] = decoder_->IsValid(
+                  records + (record * record_size), record_size, 0);
+            }
+          }
+          return;
+        }
+      }
+      if (!compact_valid_.load(std::memory_order_acquire)) {
+        for (size_t record = 0; record < nof_records; ++record) {
+          DecodeRecord(first_sample + record,
+                       records + (record * record_size), record_size);
+        }
+        return;
+      }
+      // The block may be decoded in parallel, so each run of valid samples
+      // is added as one range.
+      uint64_t run_first = first_sample;
+      uint64_t run_count = 0;
+      for (size_t record = 0; record < nof_records; ++record) {
+        const uint64_t sample = first_sample + record;
+        if (DecodeValue(sample, records + (record * record_size),
+                        record_size)) {
+          if (run_count == 0) {
+            run_first = sample;
+          }
+          ++run_count;
+        } else if (run_count > 0) {
+          AddValidRange(run_first, run_count);
+          run_count = 0;
+        }
+      }
+      if (run_count > 0) {
+        AddValidRange(run_first, run_count);
+      }
+    }
+  }
 
  protected:
+  [[nodiscard]] std::pair<const void*, size_t> SampleBuffer(
+      const std::type_info& type) const override {
+    if constexpr (std::is_arithmetic_v<T>) {
+      if (type == typeid(T)) {
+        return {value_list_.data(), value_list_.size()};
+      }
+    }
+    return {nullptr, 0};
+  }
+
   bool GetSampleUnsigned(uint64_t sample, uint64_t& value , uint64_t array_index) const override;
 
   bool GetSampleSigned(uint64_t sample, int64_t& value, uint64_t array_index) const override;
@@ -44,7 +253,18 @@ class ChannelObserver : public IChannelObserver {
 
     const auto array_size = channel_.ArraySize();
 
-    valid_list_.resize(static_cast<size_t>(group_.NofSamples() * array_size), false);
+    if constexpr (std::is_arithmetic_v<T>) {
+      if (const auto* cg4 = dynamic_cast<const Cg4Block*>(&group_);
+          cg4 != nullptr) {
+        decode_plan_ = cg4->GetDecodePlan();
+        decoder_ = decode_plan_->GetDecoder(channel_);
+      }
+    }
+    compact_valid_ = decoder_ != nullptr && !decoder_->HasInvalidBit() &&
+                     decoder_->ArraySize() == 1;
+    if (!compact_valid_) {
+      valid_list_.resize(static_cast<size_t>(group_.NofSamples() * array_size), false);
+    }
     value_list_.resize(static_cast<size_t>(group.NofSamples() * array_size), T{});
 
     if (channel_.Type() == ChannelType::VariableLength) {
@@ -63,13 +283,95 @@ class ChannelObserver : public IChannelObserver {
   ChannelObserver& operator=(const ChannelObserver&) = delete;
   ChannelObserver& operator=(ChannelObserver&&) = delete;
 
+  /** \brief Returns true if the valid flags are stored as sample ranges. */
+  [[nodiscard]] bool IsCompactValid() const {
+    return compact_valid_.load(std::memory_order_acquire);
+  }
+
   [[nodiscard]] uint64_t NofSamples() const override {
     // Note that value_list may be an array.
     return group_.NofSamples();
   }
 
+  /** \brief The observer only stores values at the sample index.
+   *
+   * Note that the valid list is a bit vector. Parallel sample ranges must
+   * start on a 64 sample boundary, so two threads never update the same word.
+   * The valid ranges are updated under a lock. Channels without a decoder,
+   * for example VLSD strings, read their values through the shared signal
+   * data and are not parallel safe.
+   */
+  [[nodiscard]] bool IsParallelSafe() const override {
+    return decoder_ != nullptr;
+  }
+
+  /** \brief Only channels with a decoder extract columns. */
+  [[nodiscard]] bool IsSampleBlockSupported() const override {
+    return decoder_ != nullptr;
+  }
+
+  [[nodiscard]] const std::vector<bool>& GetValidList() const override {
+    ExpandValidList();
+    return valid_list_;
+  }
+
+  bool GetSampleValidList(std::vector<bool>& valid_array) const override {
+    const auto nof_samples = static_cast<size_t>(NofSamples());
+    if (value_list_.size() != nof_samples) {
+      return false; // Array channel
+    }
+    std::lock_guard lock(valid_mutex_);
+    if (compact_valid_.load(std::memory_order_acquire)) {
+      valid_array.assign(nof_samples, false);
+      for (const auto& [first, last] : valid_range_list_) {
+        const auto end = std::min(last, static_cast<uint64_t>(nof_samples));
+        for (uint64_t sample = first; sample < end; ++sample) {
+          valid_array[static_cast<size_t>(sample)] = true;
+        }
+      }
+    } else {
+      valid_array = valid_list_;
+      valid_array.resize(nof_samples, false);
+    }
+    return true;
+  }
+
+  bool OnSampleBlock(uint64_t first_sample, uint64_t record_id,
+                     Span<const uint8_t> records,
+                     size_t record_size) override {
+    if (decoder_ == nullptr) {
+      return IChannelObserver::OnSampleBlock(first_sample, record_id, records,
+                                             record_size);
+    }
+    if (record_id != record_id_ || record_size == 0) {
+      return true;
+    }
+    DecodeColumn(first_sample, records.data(), record_size,
+                 records.size() / record_size);
+    return true;
+  }
+
+  bool OnSample(uint64_t sample, uint64_t record_id,
+                Span<const uint8_t> record) override {
+    if (decoder_ == nullptr) {
+      // Needs a record buffer.
+      return IChannelObserver::OnSample(sample, record_id, record);
+    }
+    if (record_id == record_id_) {
+      DecodeRecord(sample, record.data(), record.size());
+    }
+    return true;
+  }
+
   bool OnSample(uint64_t sample, uint64_t record_id,
                 const std::vector<uint8_t>& record) override {
+    if (decoder_ != nullptr) {
+      if (record_id == record_id_) {
+        DecodeRecord(sample, record.data(), record.size());
+      }
+      return true;
+    }
+
     bool parse_record = record_id == record_id_;
     if (channel_.VlsdRecordId() > 0 &&  record_id == channel_.VlsdRecordId()) {
       parse_record = true;
@@ -177,7 +479,7 @@ bool ChannelObserver<T>::GetSampleUnsigned(uint64_t sample,
   const auto sample_index = static_cast<size_t>((sample * array_size) + array_index);
   value = sample_index < value_list_.size() ?
       static_cast<uint64_t>(value_list_[sample_index]) : static_cast<uint64_t>(T{});
-  return sample_index < valid_list_.size() && valid_list_[sample_index];
+  return IsValidIndex(sample_index);
 }
 
 // Specialization of the above template function just to keep the compiler
@@ -198,7 +500,7 @@ bool ChannelObserver<T>::GetSampleSigned(uint64_t sample,
   const auto array_size = channel_.ArraySize();
   const auto sample_index = static_cast<size_t>((sample * array_size) + array_index);
   value = sample_index < value_list_.size() ? static_cast<int64_t>(value_list_[sample_index]) : 0;
-  return sample_index < valid_list_.size() && valid_list_[sample_index];
+  return IsValidIndex(sample_index);
 }
 
 template <>
@@ -216,7 +518,7 @@ bool ChannelObserver<T>::GetSampleFloat(uint64_t sample, double& value,
   const auto array_size = channel_.ArraySize();
   const auto sample_index = static_cast<size_t>( (sample * array_size) + array_index);
   value = sample_index < value_list_.size() ? static_cast<double>(value_list_[sample_index]) : 0;
-  return sample_index < valid_list_.size() && valid_list_[sample_index];
+  return IsValidIndex(sample_index);
 }
 
 template <>
@@ -242,7 +544,7 @@ bool ChannelObserver<T>::GetSampleText(uint64_t sample,
     }
 
     value = temp.str();
-    return sample_index < valid_list_.size() && valid_list_[sample_index];
+    return IsValidIndex(sample_index);
   } catch (const std::exception& ) {}
   return false;
 }
@@ -257,7 +559,7 @@ template <class T>
 bool ChannelObserver<T>::GetSampleByteArray(uint64_t sample,
                                             std::vector<uint8_t>& value) const {
   value = {};
-  return sample < valid_list_.size() && valid_list_[static_cast<size_t>(sample)];
+  return IsValidIndex(static_cast<size_t>(sample));
 }
 
 // This specialized function is actually doing the work with byte arrays
@@ -60,6 +60,10 @@ std::string Cn3Block::Name() const {
   return long_name_.empty() ? short_name_ : long_name_;
 }
 
+std::string_view Cn3Block::NameView() const {
+  return long_name_.empty() ? short_name_ : long_name_;
+}
+
 IChannelConversion *Cn3Block::ChannelConversion() const {
   return cc_block_.get();
 }
@@ -24,6 +24,7 @@ class Cn3Block : public DataListBlock, public IChannel {
   }
   void Name(const std::string& name) override;
   [[nodiscard]] std::string Name() const override;
+  [[nodiscard]] std::string_view NameView() const override;
 
   void DisplayName(const std::string& name) override;
   [[nodiscard]] std::string DisplayName() const override;
@@ -13,6 +13,7 @@
 #include "dg4block.h"
 #include "dl4block.h"
 #include "dz4block.h"
+#include "hd4block.h"
 #include "hl4block.h"
 #include "littlebuffer.h"
 #include "sd4block.h"
@@ -213,9 +214,11 @@ std::vector<int64_t> Cn4Block::XAxisLinkList() const {
 
 int64_t Cn4Block::Index() const { return FilePosition(); }
 
-void Cn4Block::Name(const std::string &name) { name_ = name; }
+void Cn4Block::Name(const std::string &name) { name_ = MakePoolString(name); }
 
-std::string Cn4Block::Name() const { return name_; }
+std::string Cn4Block::Name() const { return std::string(NameView()); }
+
+std::string_view Cn4Block::NameView() const { return ToStringView(name_); }
 
 void Cn4Block::DisplayName(const std::string &name) {
   // No support in MDF4
@@ -227,6 +230,7 @@ std::string Cn4Block::DisplayName() const {
 }
 
 void Cn4Block::Description(const std::string &description) {
+  LoadMetadata();
   if (!md_comment_) {
     if (auto* md4 = CreateMetaData(); md4 != nullptr) {
       md4->StringProperty("TX", description);
@@ -238,10 +242,12 @@ void Cn4Block::Description(const std::string &description) {
 }
 
 std::string Cn4Block::Description() const {
+  LoadMetadata();
   return MdText();
 }
 
 IChannelConversion *Cn4Block::ChannelConversion() const {
+  LoadMetadata();
   return cc_block_.get();
 }
 
@@ -289,7 +295,7 @@ bool Cn4Block::IsUnitValid() const {
 }
 
 std::string Cn4Block::Unit() const {
-
+  LoadMetadata();
   if (!unit_) {
     switch (Sync()) {
       case ChannelSyncType::Time:
@@ -316,6 +322,7 @@ std::string Cn4Block::Unit() const {
 }
 
 void Cn4Block::GetBlockProperty(BlockPropertyList &dest) const {
+  LoadMetadata();
   MdfBlock::GetBlockProperty(dest);
 
   dest.emplace_back("Links", "", "", BlockItemType::HeaderItem);
@@ -332,7 +339,7 @@ void Cn4Block::GetBlockProperty(BlockPropertyList &dest) const {
   }
   dest.emplace_back("Composition CA/CN", ToHexString(index_cx),
                     desc_cx.str(), BlockItemType::LinkItem);
-  dest.emplace_back("Name TX", ToHexString(Link(kIndexName)), name_,
+  dest.emplace_back("Name TX", ToHexString(Link(kIndexName)), Name(),
                     BlockItemType::LinkItem);
   dest.emplace_back("Source SI", ToHexString(Link(kIndexSi)),
                     "Link to source information", BlockItemType::LinkItem);
@@ -364,7 +371,7 @@ void Cn4Block::GetBlockProperty(BlockPropertyList &dest) const {
 
   dest.emplace_back("Information", "", "", BlockItemType::HeaderItem);
   dest.emplace_back("Id", std::to_string(Index()));
-  dest.emplace_back("Name", name_);
+  dest.emplace_back("Name", Name());
   dest.emplace_back("Description", Description());
   dest.emplace_back("Unit", Unit());
   dest.emplace_back("Channel Type", MakeTypeString(type_));
@@ -410,7 +417,7 @@ uint64_t Cn4Block::Read(std::streambuf& buffer) {
   bytes += ReadNumber(buffer, limit_ext_min_);
   bytes += ReadNumber(buffer, limit_ext_max_);
 
-  name_ = ReadTx4(buffer, kIndexName);
+  name_ = ReadPoolTx4(buffer, kIndexName);
 
   if (Link(kIndexCx) > 0) {
     SetFilePosition(buffer, Link(kIndexCx));
@@ -438,36 +445,22 @@ uint64_t Cn4Block::Read(std::streambuf& buffer) {
     }
   }
 
-  if (Link(kIndexSi) > 0) {
-    SetFilePosition(buffer, Link(kIndexSi));
-    si_block_ = std::make_unique<Si4Block>();
-    si_block_->Init(*this);
-    si_block_->Read(buffer);
-  }
-
-  if (Link(kIndexCc) > 0) {
-    SetFilePosition(buffer, Link(kIndexCc));
-    cc_block_ = std::make_unique<Cc4Block>();
-    cc_block_->Init(*this);
-    cc_block_->ChannelDataType(data_type_);
-    cc_block_->Read(buffer);
-  }
-
   // Need ot check if the data block is owned by this CN block or if it is a
   // reference only
   ReadBlockList(buffer, kIndexData);
 
-  if (Link(kIndexUnit) > 0) {
-    SetFilePosition(buffer, Link(kIndexUnit));
-    unit_ = std::make_unique<Md4Block>();
-    unit_->Init(*this);
-    unit_->Read(buffer);
+  // The header decides if the metadata blocks are read now or on first
+  // access.
+  const auto *header = HeaderBlock();
+  if (const auto* hd4 = dynamic_cast<const Hd4Block*>(header);
+      hd4 != nullptr && hd4->IsLazyMetadata()) {
+    lazy_metadata_ = true;
+  } else {
+    ReadMetadataBlocks(buffer);
   }
-  ReadMdComment(buffer, kIndexMd);
 
   if (nof_attachments_ > 0) {
     // Need the header block to find the AT blocks by its file position.
-    const auto *header = HeaderBlock();
     const auto at_list = AtLinkList();
 
     // Get a list of attachment file positions and convert
@@ -493,6 +486,75 @@ uint64_t Cn4Block::Read(std::streambuf& buffer) {
   return bytes;
 }
 
+void Cn4Block::ReadMetadataBlocks(std::streambuf& buffer) {
+  if (!si_block_ && Link(kIndexSi) > 0) {
+    SetFilePosition(buffer, Link(kIndexSi));
+    si_block_ = std::make_unique<Si4Block>();
+    si_block_->Init(*this);
+    si_block_->Read(buffer);
+  }
+
+  if (!cc_block_ && Link(kIndexCc) > 0) {
+    SetFilePosition(buffer, Link(kIndexCc));
+    cc_block_ = std::make_unique<Cc4Block>();
+    cc_block_->Init(*this);
+    cc_block_->ChannelDataType(data_type_);
+    cc_block_->Read(buffer);
+  }
+
+  if (!unit_ && Link(kIndexUnit) > 0) {
+    SetFilePosition(buffer, Link(kIndexUnit));
+    unit_ = std::make_unique<Md4Block>();
+    unit_->Init(*this);
+    unit_->Read(buffer);
+  }
+  ReadMdComment(buffer, kIndexMd);
+  // Cleared last, so other threads don't see the flag before the blocks exist.
+  lazy_metadata_ = false;
+}
+
+void Cn4Block::ReadMetadata(std::streambuf& buffer) {
+  for (auto& cx : cx_list_) {
+    if (auto* cn4 = dynamic_cast<Cn4Block*>(cx.get()); cn4 != nullptr) {
+      cn4->ReadMetadata(buffer);
+    }
+  }
+  if (!lazy_metadata_) {
+    return;
+  }
+  const auto* header = dynamic_cast<const Hd4Block*>(HeaderBlock());
+  if (header == nullptr) {
+    return;
+  }
+  // The lock also protects the block index and string pool of the header.
+  header->ReadLazyMetadata(buffer, [this](std::streambuf& file) {
+    if (lazy_metadata_) {
+      const int64_t position = GetFilePosition(file);
+      ReadMetadataBlocks(file);
+      SetFilePosition(file, position);
+    }
+  });
+}
+
+void Cn4Block::LoadMetadata() const {
+  if (!lazy_metadata_) {
+    return;
+  }
+  const auto* header = dynamic_cast<const Hd4Block*>(HeaderBlock());
+  if (header == nullptr) {
+    return;
+  }
+  header->ReadLazyMetadata([this](std::streambuf& buffer) {
+    // Only adds the blocks that otherwise had been read by Read().
+    if (lazy_metadata_) {
+      auto* channel = const_cast<Cn4Block*>(this);
+      const int64_t position = GetFilePosition(buffer);
+      channel->ReadMetadataBlocks(buffer);
+      SetFilePosition(buffer, position);
+    }
+  });
+}
+
 uint64_t Cn4Block::Write(std::streambuf& buffer) {
 
 
@@ -514,7 +576,7 @@ uint64_t Cn4Block::Write(std::streambuf& buffer) {
   link_list_.resize(8 + nof_attachments_ + (default_x ? 3 : 0), 0);
   WriteLink4List(buffer, cx_list_, kIndexCx,
                  UpdateOption::DoNotUpdateWrittenBlock);
-  WriteTx4(buffer, kIndexName, name_);
+  WriteTx4(buffer, kIndexName, Name());
   WriteBlock4(buffer, si_block_, kIndexSi);
   WriteBlock4(buffer, cc_block_, kIndexCc);
   // The signal data shall not be stored here. Instead, the function
@@ -597,21 +659,45 @@ MdfBlock *Cn4Block::Find(int64_t index) const {
 }
 
 void Cn4Block::ReadSignalData(std::streambuf& buffer) const {
-  const uint64_t count = DataSize();
-
-  uint64_t index = 0;
-  data_list_.resize(static_cast<size_t>(count), 0);
-  // The block list should only contain one block.
-  // A SD block is uncompressed data block
-  for (const auto &block : block_list_) {
-    const auto *data_list = dynamic_cast<const DataListBlock *>(block.get());
-    const auto *data_block = dynamic_cast<const DataBlock *>(block.get());
-    if (data_list != nullptr) {
-      data_list->CopyDataToBuffer(buffer, data_list_, index);
-    } else if (data_block != nullptr) {
-      data_block->CopyDataToBuffer(buffer, data_list_, index);
+  data_list_.clear();
+  data_list_.shrink_to_fit();
+  sd_index_.Create(*this, buffer);
+}
+
+bool Cn4Block::CopySignalData(uint64_t index, std::vector<uint8_t>& dest,
+                              bool& valid) const {
+  const bool on_demand = sd_index_.IsCreated();
+  const uint64_t data_size = on_demand ?
+      sd_index_.DataSize() : static_cast<uint64_t>(data_list_.size());
+  if (index + 4 > data_size) {
+    return false;
+  }
+  uint32_t length = 0;
+  if (on_demand) {
+    uint8_t length_bytes[4] = {};
+    if (!sd_index_.Read(index, length_bytes, sizeof(length_bytes))) {
+      return false;
+    }
+    length = LittleBuffer<uint32_t>(length_bytes).value();
+  } else {
+    length = LittleBuffer<uint32_t>(data_list_,
+                                    static_cast<size_t>(index)).value();
+  }
+  try {
+    dest.resize(length, 0);
+  } catch (const std::exception&) {
+    return false;
+  }
+  if (index + 4 + length > data_size) {
+    valid = false;
+  } else if (on_demand) {
+    if (!sd_index_.Read(index + 4, dest.data(), length)) {
+      valid = false;
     }
+  } else {
+    memcpy(dest.data(), data_list_.data() + index + 4, length);
   }
+  return true;
 }
 
 void Cn4Block::BitCount(uint32_t bits) {
@@ -649,20 +735,9 @@ bool Cn4Block::GetTextValue(const std::vector<uint8_t> &record_buffer,
     // Index into the local data buffer
     uint64_t index = 0;
     valid = GetUnsignedValue(record_buffer, index);
-    if (index + 4 > data_list_.size()) {
-      return false;
-    }
-    const LittleBuffer<uint32_t> length(data_list_, static_cast<size_t>(index) );
-    try {
-      temp.resize(length.value(), 0);
-    } catch (const std::exception&) {
+    if (!CopySignalData(index, temp, valid)) {
       return false;
     }
-    if (index + 4 + length.value() <= data_list_.size()) {
-      memcpy(temp.data(), data_list_.data() + index + 4, length.value());
-    } else {
-      valid = false;
-    }
 
   } else {
     try {
@@ -774,20 +849,9 @@ bool Cn4Block::GetByteArrayValue(const std::vector<uint8_t> &record_buffer,
     // in a SD block.
     uint64_t index = 0;  // Actual offset into the data block.
     valid = GetUnsignedValue(record_buffer, index);
-    if (index + 4 > data_list_.size()) {
-      return false;
-    }
-    const LittleBuffer<uint32_t> length(data_list_, static_cast<size_t>(index) );
-    try {
-      dest.resize(length.value(), 0);
-    } catch (const std::exception&) {
+    if (!CopySignalData(index, dest, valid)) {
       return false; // Return invalid value
     }
-    if (index + 4 + length.value() <= data_list_.size()) {
-      memcpy(dest.data(), data_list_.data() + index + 4, length.value());
-    } else {
-      valid = false;
-    }
 
   } else {
     try {
@@ -864,6 +928,7 @@ void Cn4Block::SetByteArray(const std::vector<uint8_t> &value, bool valid) {
 }
 
 void Cn4Block::Unit(const std::string &unit) {
+  LoadMetadata();
   if (unit.empty()) {
     unit_.reset();
   } else {
@@ -974,10 +1039,12 @@ std::optional<std::pair<double, double>> Cn4Block::ExtLimit() const {
 }
 
 ISourceInformation *Cn4Block::SourceInformation() const {
+  LoadMetadata();
   return si_block_.get();
 }
 
 ISourceInformation *Cn4Block::CreateSourceInformation() {
+  LoadMetadata();
   if (!si_block_) {
     si_block_ = std::make_unique<Si4Block>();
     si_block_->Init(*this);
@@ -986,6 +1053,7 @@ ISourceInformation *Cn4Block::CreateSourceInformation() {
 }
 
 IChannelConversion *Cn4Block::CreateChannelConversion() {
+  LoadMetadata();
   if (!cc_block_) {
     cc_block_ = std::make_unique<Cc4Block>();
     cc_block_->Init(*this);
@@ -1269,6 +1337,7 @@ void Cn4Block::ClearData() {
   data_list_.clear();
   data_list_.shrink_to_fit();
   data_map_.clear();
+  sd_index_.Clear();
   DataListBlock::ClearData();
 }
 
@@ -1385,7 +1454,7 @@ void Cn4Block::CopyFrom(const IChannel &source) {
     limit_ext_min_ = cn4->limit_ext_min_;
     limit_ext_max_ = cn4->limit_ext_max_;
 
-    name_ = cn4->name_;
+    name_ = MakePoolString(cn4->NameView());
     Unit(cn4->Unit());
 
     if (const IMetaData* meta = cn4->MetaData();
@@ -1458,10 +1527,12 @@ void Cn4Block::CopyConfigFrom(const IChannel &source) {
 
 
 void Cn4Block::SetCnUnit(const CnUnit &unit) {
+  LoadMetadata();
   unit_ = std::make_unique<Md4Block>(unit.ToXml());
 }
 
 void Cn4Block::GetCnUnit(CnUnit& unit) const {
+  LoadMetadata();
   if (unit_) {
     if (const std::string xml_snippet = unit_->XmlSnippet();
         !xml_snippet.empty()) {
@@ -3,6 +3,7 @@
  * SPDX-License-Identifier: MIT
  */
 #pragma once
+#include <atomic>
 #include <string>
 #include <vector>
 #include <map>
@@ -14,6 +15,7 @@
 #include "mdf/ichannel.h"
 #include "mdf/ichannelhierarchy.h"
 #include "si4block.h"
+#include "signaldataindex.h"
 #include "vlsddata.h"
 
 namespace mdf::detail {
@@ -31,6 +33,7 @@ class Cn4Block : public DataListBlock, public IChannel {
 
   void Name(const std::string& name) override;
   [[nodiscard]] std::string Name() const override;
+  [[nodiscard]] std::string_view NameView() const override;
 
   void DisplayName(const std::string& name) override;
   std::string DisplayName() const override;
@@ -72,21 +75,43 @@ class Cn4Block : public DataListBlock, public IChannel {
   [[nodiscard]] MdfBlock* Find(int64_t index) const override;
   uint64_t Read(std::streambuf& buffer) override;
   uint64_t Write(std::streambuf& buffer) override;
-  void ReadSignalData(std::streambuf& buffer) const;  ///< Reads in (VLSD) channel data (SD)
+  /** \brief Sets up the on-demand read of the (VLSD) signal data (SD).
+   *
+   * The signal data isn't read into memory. Instead, each value is read
+   * from the stream buffer when a record is parsed. The stream buffer must
+   * be valid until ClearData() is called.
+   * @param buffer Stream buffer of the file.
+   */
+  void ReadSignalData(std::streambuf& buffer) const;
   uint64_t WriteSignalData(std::streambuf& buffer, bool compress);
 
   void Init(const MdfBlock& id_block) override;
 
   [[nodiscard]] const Cx4List& Cx4() const { return cx_list_; }
 
-  [[nodiscard]] const Si4Block* Si() const { return si_block_.get(); }
+  [[nodiscard]] const Si4Block* Si() const {
+    LoadMetadata();
+    return si_block_.get();
+  }
   void AddCc4(std::unique_ptr<Cc4Block>& cc4);
-  [[nodiscard]] const Cc4Block* Cc() const { return cc_block_.get(); }
+  [[nodiscard]] const Cc4Block* Cc() const {
+    LoadMetadata();
+    return cc_block_.get();
+  }
+
+  /** \brief Reads the metadata blocks if they were deferred.
+   *
+   * Reads the CC, SI, unit and MD blocks of the channel and its
+   * composition channels. The file position is restored.
+   * @param buffer File stream buffer.
+   */
+  void ReadMetadata(std::streambuf& buffer);
 
 
   void ClearData() const {
     data_list_.clear();
     data_list_.shrink_to_fit();
+    sd_index_.Clear();
   }
   const std::vector<uint8_t>& DataList() const { return data_list_; }
 
@@ -106,9 +131,11 @@ class Cn4Block : public DataListBlock, public IChannel {
   std::optional<std::pair<double, double>> ExtLimit() const override;
 
   IMetaData *CreateMetaData() override {
+    LoadMetadata();
     return MdfBlock::CreateMetaData();
   }
   [[nodiscard]] IMetaData *MetaData() const override {
+    LoadMetadata();
     return MdfBlock::MetaData();
   }
 
@@ -119,6 +146,9 @@ class Cn4Block : public DataListBlock, public IChannel {
   void SetInvalidOffset(uint64_t bit_offset) {
     invalid_bit_pos_ = static_cast<uint32_t>(bit_offset);
   }
+  [[nodiscard]] uint32_t InvalidBitPos() const { return invalid_bit_pos_; }
+  /** \brief Returns the CG block that holds the channels record. */
+  [[nodiscard]] const Cg4Block* CgBlock() const { return cg_block_; }
 
   void SetValid(bool valid, uint64_t array_index) override;
   bool GetValid(const std::vector<uint8_t> &record_buffer,
@@ -165,6 +195,19 @@ class Cn4Block : public DataListBlock, public IChannel {
   std::vector<uint8_t>& SampleBuffer() const override;
 
  private:
+  /** \brief Copies a VLSD value from the signal data.
+   *
+   * @param index Offset of the value in the signal data.
+   * @param dest Destination of the value bytes.
+   * @param valid Set to false if the value bytes are missing.
+   * @return False if the value doesn't exist.
+   */
+  bool CopySignalData(uint64_t index, std::vector<uint8_t>& dest,
+                      bool& valid) const;
+  void ReadMetadataBlocks(std::streambuf& buffer);
+  /** \brief Reads deferred metadata blocks through the header block. */
+  void LoadMetadata() const;
+
   uint8_t type_ = 0;
   uint8_t sync_type_ = 0; ///< Normal channel type
   uint8_t data_type_ = 0;
@@ -183,7 +226,7 @@ class Cn4Block : public DataListBlock, public IChannel {
   double limit_ext_min_ = 0;
   double limit_ext_max_ = 0;
 
-  std::string name_;
+  PoolString name_;
   std::unique_ptr<Si4Block> si_block_;
   std::unique_ptr<Cc4Block> cc_block_;
   std::unique_ptr<Md4Block> unit_;
@@ -199,6 +242,10 @@ class Cn4Block : public DataListBlock, public IChannel {
   // uncompressed signal data
   mutable std::vector<uint8_t> data_list_; ///< Typical SD block data
   mutable std::map<VlsdData, uint64_t> data_map_; ///< Data->index map
+  mutable SignalDataIndex sd_index_; ///< Signal data (SD) read on demand.
+
+  /** \brief True if the CC, SI, unit and MD blocks are not read yet. */
+  mutable std::atomic<bool> lazy_metadata_ = false;
 
   const Cg4Block* cg_block_ = nullptr; ///< Pointer to its CG block
   mutable const Cn4Block* mlsd_channel_ = nullptr; ///< Pointer to length channel
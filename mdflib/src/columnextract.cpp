@@ -0,0 +1,208 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "columnextract.h"
+
+#include <cstring>
+#include <limits>
+
+#include "dbchelper.h"
+#include "simdtarget.h"
+
+namespace {
+
+using mdf::detail::DbcHelper;
+
+template <typename T, bool Swap>
+void ScalarColumn(const uint8_t* value, size_t record_size,
+                  size_t nof_records, void* dest) {
+  auto* column = static_cast<uint8_t*>(dest);
+  if (!Swap && record_size == sizeof(T)) {
+    // The records only hold this value.
+    memcpy(column, value, nof_records * sizeof(T));
+    return;
+  }
+  for (size_t record = 0; record < nof_records; ++record) {
+    T temp;
+    memcpy(&temp, value + (record * record_size), sizeof(T));
+    if constexpr (Swap && sizeof(T) > 1) {
+      temp = DbcHelper::ByteSwap(temp);
+    }
+    memcpy(column + (record * sizeof(T)), &temp, sizeof(T));
+  }
+}
+
+#if (MDF_X86_SIMD)
+
+// The gather instructions use 32-bit signed indexes, so the 8 records
+// in a gather must be within 2 GB.
+constexpr size_t kMaxGatherStride = std::numeric_limits<int32_t>::max() / 8;
+
+template <bool Swap>
+MDF_TARGET("sse4.1")
+void Sse41Column32(const uint8_t* value, size_t record_size,
+                   size_t nof_records, void* dest) {
+  auto* column = static_cast<uint8_t*>(dest);
+  const __m128i swap_mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+                                          11, 10, 9, 8, 15, 14, 13, 12);
+  size_t record = 0;
+  for (; record + 4 <= nof_records; record += 4) {
+    const uint8_t* first = value + (record * record_size);
+    int32_t temp[4];
+    for (size_t index = 0; index < 4; ++index) {
+      memcpy(&temp[index], first + (index * record_size), sizeof(int32_t));
+    }
+    __m128i values = _mm_cvtsi32_si128(temp[0]);
+    values = _mm_insert_epi32(values, temp[1], 1);
+    values = _mm_insert_epi32(values, temp[2], 2);
+    values = _mm_insert_epi32(values, temp[3], 3);
+    if constexpr (Swap) {
+      values = _mm_shuffle_epi8(values, swap_mask);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(column + (record * 4)),
+                     values);
+  }
+  ScalarColumn<uint32_t, Swap>(value + (record * record_size), record_size,
+                               nof_records - record, column + (record * 4));
+}
+
+template <bool Swap>
+MDF_TARGET("avx2")
+void Avx2Column32(const uint8_t* value, size_t record_size,
+                  size_t nof_records, void* dest) {
+  auto* column = static_cast<uint8_t*>(dest);
+  size_t record = 0;
+  if (record_size <= kMaxGatherStride) {
+    const auto stride = static_cast<int32_t>(record_size);
+    const __m256i offsets = _mm256_mullo_epi32(
+        _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+    const __m256i swap_mask = _mm256_setr_epi8(
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    for (; record + 8 <= nof_records; record += 8) {
+      const auto* first = reinterpret_cast<const int*>(
+          value + (record * record_size));
+      __m256i values = _mm256_i32gather_epi32(first, offsets, 1);
+      if constexpr (Swap) {
+        values = _mm256_shuffle_epi8(values, swap_mask);
+      }
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(column + (record * 4)),
+                          values);
+    }
+  }
+  ScalarColumn<uint32_t, Swap>(value + (record * record_size), record_size,
+                               nof_records - record, column + (record * 4));
+}
+
+template <bool Swap>
+MDF_TARGET("avx2")
+void Avx2Column64(const uint8_t* value, size_t record_size,
+                  size_t nof_records, void* dest) {
+  auto* column = static_cast<uint8_t*>(dest);
+  size_t record = 0;
+  if (record_size <= kMaxGatherStride) {
+    const auto stride = static_cast<int64_t>(record_size);
+    const __m256i offsets = _mm256_setr_epi64x(0, stride, 2 * stride,
+                                               3 * stride);
+    const __m256i swap_mask = _mm256_setr_epi8(
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    for (; record + 4 <= nof_records; record += 4) {
+      const auto* first = reinterpret_cast<const long long*>(
+          value + (record * record_size));
+      __m256i values = _mm256_i64gather_epi64(first, offsets, 1);
+      if constexpr (Swap) {
+        values = _mm256_shuffle_epi8(values, swap_mask);
+      }
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(column + (record * 8)),
+                          values);
+    }
+  }
+  ScalarColumn<uint64_t, Swap>(value + (record * record_size), record_size,
+                               nof_records - record, column + (record * 8));
+}
+
+#endif
+
+}  // namespace
+
+namespace mdf::detail {
+
+SimdLevel DetectSimdLevel() {
+#if (MDF_X86_SIMD)
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4] = {0, 0, 0, 0};
+  __cpuid(info, 0);
+  const int max_leaf = info[0];
+  __cpuid(info, 1);
+  const bool sse41 = (info[2] & (1 << 19)) != 0;
+  const bool os_xsave = (info[2] & (1 << 27)) != 0;
+  const bool avx = (info[2] & (1 << 28)) != 0;
+  if (max_leaf >= 7 && os_xsave && avx &&
+      (_xgetbv(0) & 0x06) == 0x06) { // OS saves the YMM registers
+    __cpuidex(info, 7, 0);
+    if ((info[1] & (1 << 5)) != 0) {
+      return SimdLevel::Avx2;
+    }
+  }
+  return sse41 ? SimdLevel::Sse41 : SimdLevel::None;
+#else
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return SimdLevel::Avx2;
+  }
+  if (__builtin_cpu_supports("sse4.1")) {
+    return SimdLevel::Sse41;
+  }
+  return SimdLevel::None;
+#endif
+#else
+  return SimdLevel::None;
+#endif
+}
+
+ColumnKernel SelectColumnKernel(size_t value_size, bool swap_bytes,
+                                SimdLevel level) {
+  switch (value_size) {
+    case 1:
+      return &ScalarColumn<uint8_t, false>;
+
+    case 2:
+      return swap_bytes ? &ScalarColumn<uint16_t, true> :
+                          &ScalarColumn<uint16_t, false>;
+
+    case 4:
+#if (MDF_X86_SIMD)
+      if (level == SimdLevel::Avx2) {
+        return swap_bytes ? &Avx2Column32<true> : &Avx2Column32<false>;
+      }
+      if (level == SimdLevel::Sse41) {
+        return swap_bytes ? &Sse41Column32<true> : &Sse41Column32<false>;
+      }
+#endif
+      return swap_bytes ? &ScalarColumn<uint32_t, true> :
+                          &ScalarColumn<uint32_t, false>;
+
+    case 8:
+#if (MDF_X86_SIMD)
+      if (level == SimdLevel::Avx2) {
+        return swap_bytes ? &Avx2Column64<true> : &Avx2Column64<false>;
+      }
+#endif
+      return swap_bytes ? &ScalarColumn<uint64_t, true> :
+                          &ScalarColumn<uint64_t, false>;
+
+    default:
+      break;
+  }
+  return nullptr;
+}
+
+ColumnKernel SelectColumnKernel(size_t value_size, bool swap_bytes) {
+  static const SimdLevel kSimdLevel = DetectSimdLevel();
+  return SelectColumnKernel(value_size, swap_bytes, kSimdLevel);
+}
+
+}  // namespace mdf::detail
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+/** \file
+ * This file defines the column extraction kernels. A kernel copies one
+ * byte-aligned value out of a run of fixed length records into a contiguous
+ * column.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mdf::detail {
+
+/** \brief Instruction set used by the column kernels. */
+enum class SimdLevel : int {
+  None = 0, ///< Scalar code only.
+  Sse41 = 1, ///< SSE 4.1 (x86).
+  Avx2 = 2, ///< AVX2 gather instructions (x86).
+};
+
+/** \brief Copies a value out of each record into a column.
+ *
+ * @param value Pointer to the value in the first record.
+ * @param record_size Number of bytes between the records (stride).
+ * @param nof_records Number of records.
+ * @param dest Destination column. Must hold nof_records values.
+ */
+using ColumnKernel = void (*)(const uint8_t* value, size_t record_size,
+                              size_t nof_records, void* dest);
+
+/** \brief Returns the best instruction set that the CPU supports.
+ *
+ * The CPU is checked at run-time, so the library doesn't need to be built
+ * for a specific CPU.
+ */
+[[nodiscard]] SimdLevel DetectSimdLevel();
+
+/** \brief Returns a column kernel for a specific instruction set.
+ *
+ * @param value_size Value size in bytes (1, 2, 4 or 8).
+ * @param swap_bytes True if the value has the opposite byte order of the
+ * host.
+ * @param level Instruction set to use. Mainly used for testing.
+ * @return Column kernel or null if the value size isn't supported.
+ */
+[[nodiscard]] ColumnKernel SelectColumnKernel(size_t value_size,
+                                              bool swap_bytes,
+                                              SimdLevel level);
+
+/** \brief Returns the fastest column kernel for this CPU. */
+[[nodiscard]] ColumnKernel SelectColumnKernel(size_t value_size,
+                                              bool swap_bytes);
+
+}  // namespace mdf::detail
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "conversiontable.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mdf::detail {
+
+void ConversionTable::CreateKeys(std::vector<double> key_list,
+                                 std::vector<double> value_list) {
+  key_list_ = std::move(key_list);
+  value_list_ = std::move(value_list);
+
+  // NaN keys never match, so they are not in the equal index. The stable
+  // sort keeps the first of several equal keys first.
+  equal_index_.clear();
+  equal_index_.reserve(key_list_.size());
+  for (size_t index = 0; index < key_list_.size(); ++index) {
+    if (!std::isnan(key_list_[index])) {
+      equal_index_.emplace_back(key_list_[index], index);
+    }
+  }
+  std::stable_sort(equal_index_.begin(), equal_index_.end(),
+                   [] (const auto& key1, const auto& key2) {
+    return key1.first < key2.first;
+  });
+
+  // The first key that is not less than a value is also the first
+  // position where the running max is not less than the value. The running
+  // max is sorted even if the keys are not.
+  ordered_index_ = std::none_of(key_list_.cbegin(), key_list_.cend(),
+                                [] (double key) { return std::isnan(key); });
+  max_key_list_.clear();
+  if (ordered_index_) {
+    max_key_list_.reserve(key_list_.size());
+    for (const double key : key_list_) {
+      max_key_list_.push_back(max_key_list_.empty() ?
+                              key : std::max(max_key_list_.back(), key));
+    }
+  }
+}
+
+void ConversionTable::CreateRanges(std::vector<double> min_list,
+                                   std::vector<double> max_list,
+                                   std::vector<double> value_list,
+                                   RangeType range_type) {
+  key_list_ = std::move(min_list);
+  max_list_ = std::move(max_list);
+  value_list_ = std::move(value_list);
+  range_type_ = range_type;
+
+  // A binary search requires that the ranges are sorted and don't overlap.
+  // Empty ranges are allowed as they never match.
+  range_index_ = max_list_.size() == key_list_.size();
+  for (size_t index = 0; range_index_ && index < key_list_.size(); ++index) {
+    if (std::isnan(key_list_[index]) || std::isnan(max_list_[index])) {
+      range_index_ = false;
+    } else if (index + 1 < key_list_.size()) {
+      const double next_min = key_list_[index + 1];
+      const bool sorted = key_list_[index] <= next_min;
+      const bool disjoint = range_type_ == RangeType::Inclusive ?
+                            max_list_[index] < next_min :
+                            max_list_[index] <= next_min;
+      range_index_ = sorted && disjoint;
+    }
+  }
+}
+
+ConversionTable::RangeType ConversionTable::GetRangeType(bool channel_integer,
+                                                        bool channel_float) {
+  if (channel_integer) {
+    return RangeType::Inclusive;
+  }
+  return channel_float ? RangeType::Exclusive : RangeType::NoMatch;
+}
+
+size_t ConversionTable::FindEqual(double value) const {
+  const auto itr = std::lower_bound(equal_index_.cbegin(), equal_index_.cend(),
+      value, [] (const auto& key, double val) { return key.first < val; });
+  if (itr == equal_index_.cend() || itr->first != value) {
+    return kNotFound;
+  }
+  return itr->second;
+}
+
+size_t ConversionTable::FindNotLess(double value) const {
+  if (std::isnan(value)) {
+    return kNotFound;
+  }
+  if (!ordered_index_) {
+    for (size_t index = 0; index < key_list_.size(); ++index) {
+      if (value <= key_list_[index]) {
+        return index;
+      }
+    }
+    return kNotFound;
+  }
+  const auto itr = std::lower_bound(max_key_list_.cbegin(),
+                                    max_key_list_.cend(), value);
+  return itr == max_key_list_.cend() ?
+      kNotFound : static_cast<size_t>(itr - max_key_list_.cbegin());
+}
+
+size_t ConversionTable::FindRange(double value) const {
+  if (range_type_ == RangeType::NoMatch || std::isnan(value)) {
+    return kNotFound;
+  }
+  if (!range_index_) {
+    for (size_t index = 0; index < key_list_.size(); ++index) {
+      if (InRange(index, value)) {
+        return index;
+      }
+    }
+    return kNotFound;
+  }
+
+  // Only the last range with min <= value may include the value.
+  const auto itr = std::upper_bound(key_list_.cbegin(), key_list_.cend(),
+                                    value);
+  if (itr == key_list_.cbegin()) {
+    return kNotFound;
+  }
+  const auto index = static_cast<size_t>(itr - key_list_.cbegin()) - 1;
+  return InRange(index, value) ? index : kNotFound;
+}
+
+bool ConversionTable::InRange(size_t index, double value) const {
+  const double key_min = key_list_[index];
+  const double key_max = max_list_[index];
+  switch (range_type_) {
+    case RangeType::Inclusive:
+      return value >= key_min && value <= key_max;
+
+    case RangeType::Exclusive:
+      return value >= key_min && value < key_max;
+
+    default:
+      break;
+  }
+  return false;
+}
+
+}  // namespace mdf::detail
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+/** \file
+ * This file defines the lookup table of the table based conversions.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "formulaprogram.h"
+
+namespace mdf {
+class IChannelConversion;
+}
+
+namespace mdf::detail {
+
+/** \brief Lookup table of a table based conversion.
+ *
+ * The table based conversions (value to value, value range to value, value
+ * to text and value range to text) search their key list for each value.
+ * The lookup table is created once from the parameter list and replaces the
+ * linear search with a binary search. The table also holds the
+ * pre-resolved text references, so no text block needs to be type checked
+ * when converting a value, and the compiled formula of an algebraic
+ * conversion.
+ *
+ * The search functions return the same index as a linear search from the
+ * first key, i.e. the first matching key is returned if several keys match.
+ */
+class ConversionTable final {
+ public:
+  static constexpr size_t kNotFound = std::numeric_limits<size_t>::max();
+
+  /** \brief How a value range matches a value. */
+  enum class RangeType : uint8_t {
+    Inclusive, ///< min <= value <= max (integer channels).
+    Exclusive, ///< min <= value < max (floating point channels).
+    NoMatch ///< No value matches (other channel data types).
+  };
+
+  /** \brief Pre-resolved text reference. */
+  struct TextResult {
+    /** \brief Type of reference. */
+    enum class Kind : uint8_t {
+      Empty, ///< Null reference. Converts to an empty string.
+      Text, ///< Text block.
+      Conversion, ///< Nested conversion (CC) block.
+      Invalid ///< Other block type. The value is invalid.
+    };
+    Kind Type = Kind::Invalid; ///< Type of reference.
+    std::string Text; ///< Text if a text block.
+    const IChannelConversion* Conversion = nullptr; ///< Nested CC block.
+  };
+
+  /** \brief Creates the keys and the values of a key-value table.
+   *
+   * @param key_list Keys in the order they are stored in the block.
+   * @param value_list Value per key. May be empty.
+   */
+  void CreateKeys(std::vector<double> key_list,
+                  std::vector<double> value_list = {});
+
+  /** \brief Creates the ranges of a value range table.
+   *
+   * @param min_list Range min key in the order they are stored in the block.
+   * @param max_list Range max key.
+   * @param value_list Value per range. May be empty.
+   * @param range_type Defines how a value matches a range.
+   */
+  void CreateRanges(std::vector<double> min_list,
+                    std::vector<double> max_list,
+                    std::vector<double> value_list, RangeType range_type);
+
+  /** \brief Returns the range type of a channel data type. */
+  [[nodiscard]] static RangeType GetRangeType(bool channel_integer,
+                                              bool channel_float);
+
+  [[nodiscard]] size_t NofKeys() const { return key_list_.size(); }
+  [[nodiscard]] double Key(size_t index) const { return key_list_[index]; }
+  [[nodiscard]] double Value(size_t index) const { return value_list_[index]; }
+
+  /** \brief Returns the index of the first key equal to the value. */
+  [[nodiscard]] size_t FindEqual(double value) const;
+
+  /** \brief Returns the index of the first key not less than the value. */
+  [[nodiscard]] size_t FindNotLess(double value) const;
+
+  /** \brief Returns the index of the first range that includes the value. */
+  [[nodiscard]] size_t FindRange(double value) const;
+
+  /** \brief Compiled formula of an algebraic conversion. */
+  [[nodiscard]] FormulaProgram& Formula() { return formula_; }
+  /** \brief Compiled formula of an algebraic conversion. */
+  [[nodiscard]] const FormulaProgram& Formula() const { return formula_; }
+
+  /** \brief Text references. Index is the reference index. */
+  [[nodiscard]] std::vector<TextResult>& TextResults() {
+    return text_result_list_;
+  }
+  /** \brief Text references. Index is the reference index. */
+  [[nodiscard]] const std::vector<TextResult>& TextResults() const {
+    return text_result_list_;
+  }
+
+ private:
+  std::vector<double> key_list_; ///< Keys or range min keys.
+  std::vector<double> max_list_; ///< Range max keys.
+  std::vector<double> value_list_; ///< Value per key or range.
+
+  /** \brief Sorted (key, index) list used by FindEqual(). */
+  std::vector<std::pair<double, size_t>> equal_index_;
+  /** \brief Running max of the keys used by FindNotLess(). */
+  std::vector<double> max_key_list_;
+  bool ordered_index_ = false; ///< False if FindNotLess() must scan.
+
+  RangeType range_type_ = RangeType::NoMatch;
+  bool range_index_ = false; ///< False if FindRange() must scan.
+
+  std::vector<TextResult> text_result_list_;
+  FormulaProgram formula_;
+
+  [[nodiscard]] bool InRange(size_t index, double value) const;
+};
+
+}  // namespace mdf::detail
@@ -0,0 +1,299 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "convertkernel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "simdtarget.h"
+
+namespace {
+
+void ScalarLinear(const double* in, double* out, size_t count,
+                  const double* par) {
+  for (size_t index = 0; index < count; ++index) {
+    out[index] = par[0] + (par[1] * in[index]);
+  }
+}
+
+bool ScalarRational(const double* in, double* out, uint8_t* valid,
+                    size_t count, const double* par) {
+  bool all_valid = true;
+  for (size_t index = 0; index < count; ++index) {
+    const double value = in[index];
+    const double square = value * value;
+    const double eng_value = (par[0] * square) + (par[1] * value) + par[2];
+    const double div = (par[3] * square) + (par[4] * value) + par[5];
+    const bool ok = div != 0.0;
+    out[index] = ok ? eng_value / div : eng_value;
+    valid[index] = ok ? 1 : 0;
+    all_valid = all_valid && ok;
+  }
+  return all_valid;
+}
+
+bool ScalarPolynomial(const double* in, double* out, uint8_t* valid,
+                      size_t count, const double* par) {
+  bool all_valid = true;
+  for (size_t index = 0; index < count; ++index) {
+    const double temp = in[index] - par[4] - par[5];
+    const double eng_value = par[1] - (par[3] * temp);
+    const double div = (par[2] * temp) - par[0];
+    const bool ok = div != 0.0;
+    out[index] = ok ? eng_value / div : eng_value;
+    valid[index] = ok ? 1 : 0;
+    all_valid = all_valid && ok;
+  }
+  return all_valid;
+}
+
+template <bool Exponential>
+bool TranscendentalBatch(const double* in, double* out, uint8_t* valid,
+                         size_t count, const double* par) {
+  const auto func = [] (double value) {
+    return Exponential ? std::exp(value) : std::log(value);
+  };
+  bool all_valid = true;
+  if (par[3] == 0.0) {
+    for (size_t index = 0; index < count; ++index) {
+      double eng_value = ((in[index] - par[6]) * par[5]) - par[2];
+      bool ok = par[0] != 0.0;
+      if (ok) {
+        eng_value = func(eng_value / par[0]);
+        ok = par[1] != 0.0;
+        if (ok) {
+          eng_value /= par[1];
+        }
+      }
+      out[index] = eng_value;
+      valid[index] = ok ? 1 : 0;
+      all_valid = all_valid && ok;
+    }
+  } else if (par[0] == 0.0) {
+    for (size_t index = 0; index < count; ++index) {
+      double eng_value = par[2];
+      const double temp = in[index] - par[6];
+      bool ok = temp != 0.0;
+      if (ok) {
+        eng_value /= temp;
+        eng_value -= par[5];
+        eng_value = func(eng_value / par[3]);
+        ok = par[4] != 0.0;
+        if (ok) {
+          eng_value /= par[4];
+        }
+      }
+      out[index] = eng_value;
+      valid[index] = ok ? 1 : 0;
+      all_valid = all_valid && ok;
+    }
+  } else {
+    std::fill_n(out, count, 0.0);
+    std::fill_n(valid, count, static_cast<uint8_t>(0));
+    all_valid = count == 0;
+  }
+  return all_valid;
+}
+
+#if (MDF_X86_SIMD)
+
+MDF_TARGET("sse4.1")
+void Sse41Linear(const double* in, double* out, size_t count,
+                 const double* par) {
+  const __m128d offset = _mm_set1_pd(par[0]);
+  const __m128d factor = _mm_set1_pd(par[1]);
+  size_t index = 0;
+  for (; index + 2 <= count; index += 2) {
+    const __m128d value = _mm_loadu_pd(in + index);
+    _mm_storeu_pd(out + index, _mm_add_pd(offset, _mm_mul_pd(factor, value)));
+  }
+  ScalarLinear(in + index, out + index, count - index, par);
+}
+
+/** \brief Stores the quotient or the dividend if the divisor is zero. */
+MDF_TARGET("sse4.1")
+bool Sse41Divide(__m128d eng_value, __m128d div, double* out,
+                 uint8_t* valid) {
+  const __m128d zero = _mm_cmpeq_pd(div, _mm_setzero_pd());
+  _mm_storeu_pd(out, _mm_blendv_pd(_mm_div_pd(eng_value, div), eng_value,
+                                   zero));
+  const int mask = _mm_movemask_pd(zero);
+  valid[0] = (mask & 0x01) == 0 ? 1 : 0;
+  valid[1] = (mask & 0x02) == 0 ? 1 : 0;
+  return mask == 0;
+}
+
+MDF_TARGET("sse4.1")
+bool Sse41Rational(const double* in, double* out, uint8_t* valid,
+                   size_t count, const double* par) {
+  const __m128d p0 = _mm_set1_pd(par[0]);
+  const __m128d p1 = _mm_set1_pd(par[1]);
+  const __m128d p2 = _mm_set1_pd(par[2]);
+  const __m128d p3 = _mm_set1_pd(par[3]);
+  const __m128d p4 = _mm_set1_pd(par[4]);
+  const __m128d p5 = _mm_set1_pd(par[5]);
+  bool all_valid = true;
+  size_t index = 0;
+  for (; index + 2 <= count; index += 2) {
+    const __m128d value = _mm_loadu_pd(in + index);
+    const __m128d square = _mm_mul_pd(value, value);
+    const __m128d eng_value = _mm_add_pd(
+        _mm_add_pd(_mm_mul_pd(p0, square), _mm_mul_pd(p1, value)), p2);
+    const __m128d div = _mm_add_pd(
+        _mm_add_pd(_mm_mul_pd(p3, square), _mm_mul_pd(p4, value)), p5);
+    all_valid = Sse41Divide(eng_value, div, out + index, valid + index) &&
+                all_valid;
+  }
+  return ScalarRational(in + index, out + index, valid + index, count - index,
+                        par) && all_valid;
+}
+
+MDF_TARGET("sse4.1")
+bool Sse41Polynomial(const double* in, double* out, uint8_t* valid,
+                     size_t count, const double* par) {
+  const __m128d p0 = _mm_set1_pd(par[0]);
+  const __m128d p1 = _mm_set1_pd(par[1]);
+  const __m128d p2 = _mm_set1_pd(par[2]);
+  const __m128d p3 = _mm_set1_pd(par[3]);
+  const __m128d p4 = _mm_set1_pd(par[4]);
+  const __m128d p5 = _mm_set1_pd(par[5]);
+  bool all_valid = true;
+  size_t index = 0;
+  for (; index + 2 <= count; index += 2) {
+    const __m128d value = _mm_loadu_pd(in + index);
+    const __m128d temp = _mm_sub_pd(_mm_sub_pd(value, p4), p5);
+    const __m128d eng_value = _mm_sub_pd(p1, _mm_mul_pd(p3, temp));
+    const __m128d div = _mm_sub_pd(_mm_mul_pd(p2, temp), p0);
+    all_valid = Sse41Divide(eng_value, div, out + index, valid + index) &&
+                all_valid;
+  }
+  return ScalarPolynomial(in + index, out + index, valid + index,
+                          count - index, par) && all_valid;
+}
+
+MDF_TARGET("avx2")
+void Avx2Linear(const double* in, double* out, size_t count,
+                const double* par) {
+  const __m256d offset = _mm256_set1_pd(par[0]);
+  const __m256d factor = _mm256_set1_pd(par[1]);
+  size_t index = 0;
+  for (; index + 4 <= count; index += 4) {
+    const __m256d value = _mm256_loadu_pd(in + index);
+    _mm256_storeu_pd(out + index,
+                     _mm256_add_pd(offset, _mm256_mul_pd(factor, value)));
+  }
+  ScalarLinear(in + index, out + index, count - index, par);
+}
+
+/** \brief Stores the quotient or the dividend if the divisor is zero. */
+MDF_TARGET("avx2")
+bool Avx2Divide(__m256d eng_value, __m256d div, double* out,
+                uint8_t* valid) {
+  const __m256d zero = _mm256_cmp_pd(div, _mm256_setzero_pd(), _CMP_EQ_OQ);
+  _mm256_storeu_pd(out, _mm256_blendv_pd(_mm256_div_pd(eng_value, div),
+                                         eng_value, zero));
+  const int mask = _mm256_movemask_pd(zero);
+  for (int lane = 0; lane < 4; ++lane) {
+    valid[lane] = (mask & (1 << lane)) == 0 ? 1 : 0;
+  }
+  return mask == 0;
+}
+
+MDF_TARGET("avx2")
+bool Avx2Rational(const double* in, double* out, uint8_t* valid,
+                  size_t count, const double* par) {
+  const __m256d p0 = _mm256_set1_pd(par[0]);
+  const __m256d p1 = _mm256_set1_pd(par[1]);
+  const __m256d p2 = _mm256_set1_pd(par[2]);
+  const __m256d p3 = _mm256_set1_pd(par[3]);
+  const __m256d p4 = _mm256_set1_pd(par[4]);
+  const __m256d p5 = _mm256_set1_pd(par[5]);
+  bool all_valid = true;
+  size_t index = 0;
+  for (; index + 4 <= count; index += 4) {
+    const __m256d value = _mm256_loadu_pd(in + index);
+    const __m256d square = _mm256_mul_pd(value, value);
+    const __m256d eng_value = _mm256_add_pd(
+        _mm256_add_pd(_mm256_mul_pd(p0, square), _mm256_mul_pd(p1, value)),
+        p2);
+    const __m256d div = _mm256_add_pd(
+        _mm256_add_pd(_mm256_mul_pd(p3, square), _mm256_mul_pd(p4, value)),
+        p5);
+    all_valid = Avx2Divide(eng_value, div, out + index, valid + index) &&
+                all_valid;
+  }
+  return ScalarRational(in + index, out + index, valid + index, count - index,
+                        par) && all_valid;
+}
+
+MDF_TARGET("avx2")
+bool Avx2Polynomial(const double* in, double* out, uint8_t* valid,
+                    size_t count, const double* par) {
+  const __m256d p0 = _mm256_set1_pd(par[0]);
+  const __m256d p1 = _mm256_set1_pd(par[1]);
+  const __m256d p2 = _mm256_set1_pd(par[2]);
+  const __m256d p3 = _mm256_set1_pd(par[3]);
+  const __m256d p4 = _mm256_set1_pd(par[4]);
+  const __m256d p5 = _mm256_set1_pd(par[5]);
+  bool all_valid = true;
+  size_t index = 0;
+  for (; index + 4 <= count; index += 4) {
+    const __m256d value = _mm256_loadu_pd(in + index);
+    const __m256d temp = _mm256_sub_pd(_mm256_sub_pd(value, p4), p5);
+    const __m256d eng_value = _mm256_sub_pd(p1, _mm256_mul_pd(p3, temp));
+    const __m256d div = _mm256_sub_pd(_mm256_mul_pd(p2, temp), p0);
+    all_valid = Avx2Divide(eng_value, div, out + index, valid + index) &&
+                all_valid;
+  }
+  return ScalarPolynomial(in + index, out + index, valid + index,
+                          count - index, par) && all_valid;
+}
+
+#endif
+
+}  // namespace
+
+namespace mdf::detail {
+
+const ConvertKernels& SelectConvertKernels(SimdLevel level) {
+  static const ConvertKernels kScalar = {&ScalarLinear, &ScalarRational,
+                                         &ScalarPolynomial};
+#if (MDF_X86_SIMD)
+  static const ConvertKernels kSse41 = {&Sse41Linear, &Sse41Rational,
+                                        &Sse41Polynomial};
+  static const ConvertKernels kAvx2 = {&Avx2Linear, &Avx2Rational,
+                                       &Avx2Polynomial};
+  switch (level) {
+    case SimdLevel::Avx2:
+      return kAvx2;
+
+    case SimdLevel::Sse41:
+      return kSse41;
+
+    default:
+      break;
+  }
+#endif
+  return kScalar;
+}
+
+const ConvertKernels& SelectConvertKernels() {
+  static const ConvertKernels& kKernels =
+      SelectConvertKernels(DetectSimdLevel());
+  return kKernels;
+}
+
+bool ConvertLogarithmicBatch(const double* in, double* out, uint8_t* valid,
+                             size_t count, const double* par) {
+  return TranscendentalBatch<false>(in, out, valid, count, par);
+}
+
+bool ConvertExponentialBatch(const double* in, double* out, uint8_t* valid,
+                             size_t count, const double* par) {
+  return TranscendentalBatch<true>(in, out, valid, count, par);
+}
+
+}  // namespace mdf::detail
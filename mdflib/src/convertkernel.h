@@ -0,0 +1,62 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+/** \file
+ * This file defines the batch conversion kernels. A kernel converts a run of
+ * channel values into engineering values with the conversion parameters
+ * resolved once for the whole run.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "columnextract.h"
+
+namespace mdf::detail {
+
+/** \brief Linear conversion kernel. Eng = par[0] + (par[1] * Ch). */
+using LinearKernel = void (*)(const double* in, double* out, size_t count,
+                              const double* par);
+
+/** \brief Conversion kernel that may set a value invalid.
+ *
+ * @param in Channel values.
+ * @param out Engineering values.
+ * @param valid Valid flag (0/1) per value.
+ * @param count Number of values.
+ * @param par Conversion parameters.
+ * @return True if all values are valid.
+ */
+using DivisionKernel = bool (*)(const double* in, double* out, uint8_t* valid,
+                                size_t count, const double* par);
+
+/** \brief Set of conversion kernels for one instruction set.
+ *
+ * The kernels give exactly the same result as the single value conversions
+ * in IChannelConversion. Note that fused multiply-add instructions are not
+ * used, as they round differently.
+ */
+struct ConvertKernels {
+  LinearKernel Linear = nullptr; ///< Linear conversion.
+  DivisionKernel Rational = nullptr; ///< Rational conversion (6 parameters).
+  DivisionKernel Polynomial = nullptr; ///< Polynomial conversion (MDF 3).
+};
+
+/** \brief Returns the conversion kernels for a specific instruction set. */
+[[nodiscard]] const ConvertKernels& SelectConvertKernels(SimdLevel level);
+
+/** \brief Returns the fastest conversion kernels for this CPU. */
+[[nodiscard]] const ConvertKernels& SelectConvertKernels();
+
+/** \brief Logarithmic conversion of a run of values (MDF 3, 7 parameters). */
+bool ConvertLogarithmicBatch(const double* in, double* out, uint8_t* valid,
+                             size_t count, const double* par);
+
+/** \brief Exponential conversion of a run of values (MDF 3, 7 parameters). */
+bool ConvertExponentialBatch(const double* in, double* out, uint8_t* valid,
+                             size_t count, const double* par);
+
+}  // namespace mdf::detail
@@ -77,6 +77,64 @@ using signed64 = union {
   int64_t val64 : 64;
 };
 
+
+const bool kLittleEndianHost = mdf::detail::DbcHelper::IsLittleEndian();
+
+/** \brief Loads up to 8 bytes as a little endian number. */
+uint64_t LoadLittleWindow(const uint8_t* raw, size_t nof_bytes) {
+  uint64_t window = 0;
+  if (kLittleEndianHost) {
+    memcpy(&window, raw, nof_bytes);
+  } else {
+    memcpy(reinterpret_cast<uint8_t*>(&window) + (8 - nof_bytes), raw,
+           nof_bytes);
+    window = mdf::detail::DbcHelper::ByteSwap(window);
+  }
+  return window;
+}
+
+/** \brief Loads up to 8 bytes as a big endian number.
+ *
+ * The first byte ends up in the most significant byte of the window.
+ */
+uint64_t LoadBigWindow(const uint8_t* raw, size_t nof_bytes) {
+  uint64_t window = 0;
+  if (kLittleEndianHost) {
+    memcpy(&window, raw, nof_bytes);
+    window = mdf::detail::DbcHelper::ByteSwap(window);
+  } else {
+    memcpy(&window, raw, nof_bytes);
+  }
+  return window;
+}
+
+/** \brief Reference implementation that reads one bit at the time.
+ *
+ * Only used for bit fields that don't fit in a 64-bit window.
+ */
+uint64_t BitsToUnsigned(bool little_endian, size_t start, size_t length,
+                        const uint8_t* raw) {
+  uint64_t value = 0;
+  auto byte = (little_endian ?
+      static_cast<int>(start + length - 1) : static_cast<int>(start) ) / 8;
+  auto bit = static_cast<int>( (start + length - 1) % 8);
+
+  for (size_t index = 0; index < length; ++index) {
+    if (index > 0) {
+      value <<= 1;
+    }
+    if ((raw[byte] & kMask[bit]) != 0) {
+      value |= 1;
+    }
+    --bit;
+    if (bit < 0) {
+      bit = 7;
+      little_endian ? --byte : ++byte;
+    }
+  }
+  return value;
+}
+
 } // end namespace empty
 
 namespace mdf::detail {
@@ -424,22 +482,7 @@ double DbcHelper::RawToDouble(bool little_endian, size_t start, size_t length,
                               const unsigned char* raw )
 {
   double value = 0.0;
-  uint64_t temp = 0;
-  uint64_t mask = 1ULL << ( length - 1 );
-  auto byte = (little_endian ?
-               static_cast<int>(start + length - 1) : static_cast<int>(start) ) / 8;
-  auto bit = static_cast<int>( (start + length - 1) % 8);
-  for (size_t index = 0; index < length; ++index ) {
-    if ((raw[byte] & kMask[bit] ) != 0) {
-      temp |= mask;
-    }
-    mask >>= 1;
-    --bit;
-    if (bit < 0) {
-      bit = 7;
-      little_endian ? --byte : ++byte;
-    }
-  }
+  const uint64_t temp = RawToUnsigned(little_endian, start, length, raw);
   memcpy( &value, &temp, sizeof(value));
   return value;
 }
@@ -448,22 +491,8 @@ float DbcHelper::RawToFloat(bool little_endian, size_t start, size_t length,
                             const unsigned char* raw )
 {
   float value = 0.0;
-  uint32_t temp = 0;
-  uint32_t mask = 1ULL << ( length - 1 );
-  auto byte = (little_endian ?
-               static_cast<int>(start + length - 1) : static_cast<int>(start) ) / 8;
-  auto bit = static_cast<int>( (start + length - 1) % 8);
-  for (size_t index = 0; index < length; ++index ) {
-    if ((raw[byte] & kMask[bit] ) != 0) {
-      temp |= mask;
-    }
-    mask >>= 1;
-    --bit;
-    if (bit < 0) {
-      bit = 7;
-      little_endian ? --byte : ++byte;
-    }
-  }
+  const auto temp = static_cast<uint32_t>(
+      RawToUnsigned(little_endian, start, length, raw));
   memcpy( &value, &temp, sizeof(value));
   return value;
 }
@@ -475,146 +504,73 @@ float DbcHelper::RawToHalf(bool little_endian, size_t start, size_t length,
     length = 16;
   }
 
-  uint16_t temp = 0;
-  uint16_t mask = 1ULL << ( length - 1 );
-  auto byte = (little_endian ?
-               static_cast<int>(start + length - 1) : static_cast<int>(start) ) / 8;
-  auto bit = static_cast<int>( (start + length - 1) % 8);
-  for (size_t index = 0; index < length; ++index ) {
-    if ((raw[byte] & kMask[bit] ) != 0) {
-      temp |= mask;
-    }
-    mask >>= 1;
-    --bit;
-    if (bit < 0) {
-      bit = 7;
-      little_endian ? --byte : ++byte;
-    }
-  }
-
   half_float::half value;
-  value.data_ = temp;
+  value.data_ = static_cast<uint16_t>(
+      RawToUnsigned(little_endian, start, length, raw));
   return value;
 }
 
 int64_t DbcHelper::RawToSigned(bool little_endian, size_t start, size_t length,
                                const uint8_t* raw )
 {
-  int64_t value = 0;
-
-  uint64_t temp = 0;
-  auto byte = (little_endian ?
-               static_cast<int>(start + length - 1) : static_cast<int>(start) ) / 8;
-  auto bit = static_cast<int>( (start + length - 1) % 8);
-
-  for (size_t index = 0; index < length; ++index) {
-    if ( index > 0 ) temp <<= 1;
-    if ((raw[byte] & kMask[bit]) != 0) {
-      temp |= 1;
-    }
-    --bit;
-    if (bit < 0) {
-      bit = 7;
-      little_endian ? --byte : ++byte;
-    }
+  if (length == 0 || length > 64) {
+    return 0;
   }
-
-  signed64 temp_value {};
-  memcpy( &temp_value, &temp, sizeof(temp));
-
-  switch ( length ) {
-    case 1: value = temp_value.val1; break;
-    case 2: value = temp_value.val2; break;
-    case 3: value = temp_value.val3; break;
-    case 4: value = temp_value.val4; break;
-    case 5: value = temp_value.val5; break;
-    case 6: value = temp_value.val6; break;
-    case 7: value = temp_value.val7; break;
-    case 8: value = temp_value.val8; break;
-    case 9: value = temp_value.val9; break;
-    case 10: value = temp_value.val10; break;
-    case 11: value = temp_value.val11; break;
-    case 12: value = temp_value.val12; break;
-    case 13: value = temp_value.val13; break;
-    case 14: value = temp_value.val14; break;
-    case 15: value = temp_value.val15; break;
-    case 16: value = temp_value.val16; break;
-    case 17: value = temp_value.val17; break;
-    case 18: value = temp_value.val18; break;
-    case 19: value = temp_value.val19; break;
-    case 20: value = temp_value.val20; break;
-    case 21: value = temp_value.val21; break;
-    case 22: value = temp_value.val22; break;
-    case 23: value = temp_value.val23; break;
-    case 24: value = temp_value.val24; break;
-    case 25: value = temp_value.val25; break;
-    case 26: value = temp_value.val26; break;
-    case 27: value = temp_value.val27; break;
-    case 28: value = temp_value.val28; break;
-    case 29: value = temp_value.val29; break;
-    case 30: value = temp_value.val30; break;
-    case 31: value = temp_value.val31; break;
-    case 32: value = temp_value.val32; break;
-    case 33: value = temp_value.val33; break;
-    case 34: value = temp_value.val34; break;
-    case 35: value = temp_value.val35; break;
-    case 36: value = temp_value.val36; break;
-    case 37: value = temp_value.val37; break;
-    case 38: value = temp_value.val38; break;
-    case 39: value = temp_value.val39; break;
-    case 40: value = temp_value.val40; break;
-    case 41: value = temp_value.val41; break;
-    case 42: value = temp_value.val42; break;
-    case 43: value = temp_value.val43; break;
-    case 44: value = temp_value.val44; break;
-    case 45: value = temp_value.val45; break;
-    case 46: value = temp_value.val46; break;
-    case 47: value = temp_value.val47; break;
-    case 48: value = temp_value.val48; break;
-    case 49: value = temp_value.val49; break;
-    case 50: value = temp_value.val50; break;
-    case 51: value = temp_value.val51; break;
-    case 52: value = temp_value.val52; break;
-    case 53: value = temp_value.val53; break;
-    case 54: value = temp_value.val54; break;
-    case 55: value = temp_value.val55; break;
-    case 56: value = temp_value.val56; break;
-    case 57: value = temp_value.val57; break;
-    case 58: value = temp_value.val58; break;
-    case 59: value = temp_value.val59; break;
-    case 60: value = temp_value.val60; break;
-    case 61: value = temp_value.val61; break;
-    case 62: value = temp_value.val62; break;
-    case 63: value = temp_value.val63; break;
-    case 64: value = temp_value.val64; break;
-    default:
-      break;
+  const uint64_t temp = RawToUnsigned(little_endian, start, length, raw);
+  if (length == 64) {
+    return static_cast<int64_t>(temp);
   }
-  return value;
+  // Sign extend by moving the sign bit to the top and shift it back.
+  const auto shift = static_cast<unsigned>(64 - length);
+  return static_cast<int64_t>(temp << shift) >> shift;
 }
 
 uint64_t DbcHelper::RawToUnsigned(bool little_endian, size_t start,
                                   size_t length, const uint8_t* raw)
 {
-  uint64_t value = 0;
-  auto byte = (little_endian ?
-      static_cast<int>(start + length - 1) : static_cast<int>(start) ) / 8;
-  auto bit = static_cast<int>( (start + length - 1) % 8);
-
-  for (size_t index = 0; index < length; ++index) {
-    if (index > 0) {
-      value <<= 1;
+  if (length == 0) {
+    return 0;
+  }
+  const auto* first = raw + (start / 8);
+  if ((start % 8) == 0) {
+    switch (length) {
+      case 8:
+        return *first;
+
+      case 16:
+        return little_endian ? LoadAligned<uint16_t, true>(first) :
+                               LoadAligned<uint16_t, false>(first);
+
+      case 32:
+        return little_endian ? LoadAligned<uint32_t, true>(first) :
+                               LoadAligned<uint32_t, false>(first);
+
+      case 64:
+        return little_endian ? LoadAligned<uint64_t, true>(first) :
+                               LoadAligned<uint64_t, false>(first);
+
+      default:
+        break;
     }
-    if ((raw[byte] & kMask[bit]) != 0) {
-      value |= 1;
+  }
+
+  if (little_endian) {
+    // The value starts at the bit offset in the first byte.
+    const size_t shift = start % 8;
+    if (shift + length <= 64) {
+      const uint64_t window = LoadLittleWindow(first, (shift + length + 7) / 8);
+      return length < 64 ? (window >> shift) & ((1ULL << length) - 1) : window;
     }
-    --bit;
-    if (bit < 0) {
-      bit = 7;
-      little_endian ? --byte : ++byte;
+  } else {
+    // The most significant bit is the (start + length - 1) % 8 bit in the
+    // first byte.
+    const size_t shift = 7 - ((start + length - 1) % 8);
+    if (shift + length <= 64) {
+      const uint64_t window = LoadBigWindow(first, (shift + length + 7) / 8);
+      return (window << shift) >> (64 - length);
     }
   }
-  return value;
+  return BitsToUnsigned(little_endian, start, length, raw);
 }
 
 void DbcHelper::SetAllBits(size_t start, size_t length, uint8_t* raw ) {
@@ -689,9 +645,4 @@ bool DbcHelper::FileExist(const std::string& path) {
   return temp.good();
 }
 */
-bool DbcHelper::IsLittleEndian() {
-  constexpr int temp = 1;
-  return *((const int8_t*) &temp) == 1;
-}
-
 }
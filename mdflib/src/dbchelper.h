@@ -5,9 +5,14 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
 #include <string>
 #include <vector>
 
+#if (_MSC_VER)
+#include <cstdlib>
+#endif
+
 
 namespace mdf::detail {
 class DbcHelper {
@@ -53,6 +58,59 @@ class DbcHelper {
   */
 
   static bool IsLittleEndian();
+
+  /** \brief Reverses the byte order of an integer. */
+  static uint16_t ByteSwap(uint16_t value);
+  static uint32_t ByteSwap(uint32_t value);
+  static uint64_t ByteSwap(uint64_t value);
+
+  /** \brief Loads a byte-aligned integer with one memory access.
+   *
+   * @tparam T Unsigned integer type of the stored value.
+   * @tparam LittleEndian Byte order of the stored value.
+   * @param raw Pointer to the first byte of the value.
+   * @return The value in host byte order.
+   */
+  template <typename T, bool LittleEndian>
+  static uint64_t LoadAligned(const uint8_t* raw) {
+    T value;
+    memcpy(&value, raw, sizeof(T));
+    if constexpr (sizeof(T) > 1) {
+      if (LittleEndian != IsLittleEndian()) {
+        value = ByteSwap(value);
+      }
+    }
+    return value;
+  }
 };
 
+inline bool DbcHelper::IsLittleEndian() {
+  constexpr int temp = 1;
+  return *((const int8_t*) &temp) == 1;
+}
+
+inline uint16_t DbcHelper::ByteSwap(uint16_t value) {
+#if (_MSC_VER)
+  return _byteswap_ushort(value);
+#else
+  return __builtin_bswap16(value);
+#endif
+}
+
+inline uint32_t DbcHelper::ByteSwap(uint32_t value) {
+#if (_MSC_VER)
+  return _byteswap_ulong(value);
+#else
+  return __builtin_bswap32(value);
+#endif
+}
+
+inline uint64_t DbcHelper::ByteSwap(uint64_t value) {
+#if (_MSC_VER)
+  return _byteswap_uint64(value);
+#else
+  return __builtin_bswap64(value);
+#endif
+}
+
 } // end namespace
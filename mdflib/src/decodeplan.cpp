@@ -0,0 +1,188 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "decodeplan.h"
+
+#include "cg4block.h"
+#include "cn4block.h"
+#include "dbchelper.h"
+#include "half.hpp"
+#include "mdf/mdflogstream.h"
+
+namespace {
+
+using mdf::detail::DbcHelper;
+
+template <typename T, bool LittleEndian>
+uint64_t ExtractAligned(const uint8_t* record, size_t bit_offset,
+                        size_t /* bit_count */) {
+  return DbcHelper::LoadAligned<T, LittleEndian>(record + (bit_offset / 8));
+}
+
+template <bool LittleEndian>
+uint64_t ExtractBits(const uint8_t* record, size_t bit_offset,
+                     size_t bit_count) {
+  return DbcHelper::RawToUnsigned(LittleEndian, bit_offset, bit_count, record);
+}
+
+/** \brief Selects the fastest extractor for a value layout.
+ *
+ * Byte-aligned 8/16/32/64-bit values are loaded directly. Note that array
+ * values are stored after each other, so the array values keeps the
+ * alignment of the first value.
+ */
+mdf::detail::ValueDecoder::Extractor SelectExtractor(bool little_endian,
+                                                     size_t bit_offset,
+                                                     size_t bit_count) {
+  if (bit_offset % 8 == 0) {
+    switch (bit_count) {
+      case 8:
+        return &ExtractAligned<uint8_t, true>;
+
+      case 16:
+        return little_endian ? &ExtractAligned<uint16_t, true> :
+                               &ExtractAligned<uint16_t, false>;
+
+      case 32:
+        return little_endian ? &ExtractAligned<uint32_t, true> :
+                               &ExtractAligned<uint32_t, false>;
+
+      case 64:
+        return little_endian ? &ExtractAligned<uint64_t, true> :
+                               &ExtractAligned<uint64_t, false>;
+
+      default:
+        break;
+    }
+  }
+  return little_endian ? &ExtractBits<true> : &ExtractBits<false>;
+}
+
+}  // namespace
+
+namespace mdf::detail {
+
+bool ValueDecoder::Create(const IChannel& channel) {
+  switch (channel.Type()) {
+    case ChannelType::FixedLength:
+    case ChannelType::Master:
+    case ChannelType::Sync:
+      break;
+
+    default:
+      return false; // Variable length, virtual or max length channels.
+  }
+  if (channel.VlsdRecordId() != 0) {
+    return false;
+  }
+
+  bool little_endian = true;
+  bit_count_ = channel.BitCount();
+  switch (channel.DataType()) {
+    case ChannelDataType::UnsignedIntegerLe:
+      kind_ = ValueKind::Unsigned;
+      break;
+
+    case ChannelDataType::UnsignedIntegerBe:
+      kind_ = ValueKind::Unsigned;
+      little_endian = false;
+      break;
+
+    case ChannelDataType::SignedIntegerLe:
+      kind_ = ValueKind::Signed;
+      break;
+
+    case ChannelDataType::SignedIntegerBe:
+      kind_ = ValueKind::Signed;
+      little_endian = false;
+      break;
+
+    case ChannelDataType::FloatLe:
+    case ChannelDataType::FloatBe:
+      little_endian = channel.DataType() == ChannelDataType::FloatLe;
+      switch (bit_count_) {
+        case 16:
+          kind_ = ValueKind::Half;
+          break;
+
+        case 32:
+          kind_ = ValueKind::Float;
+          break;
+
+        case 64:
+          kind_ = ValueKind::Double;
+          break;
+
+        default:
+          kind_ = ValueKind::Invalid;
+          break;
+      }
+      break;
+
+    default:
+      return false; // Text, byte arrays and CANopen dates.
+  }
+
+  channel_ = &channel;
+  bit_offset_ = (static_cast<size_t>(channel.ByteOffset()) * 8) +
+                channel.BitOffset();
+  array_size_ = channel.ArraySize();
+  extractor_ = SelectExtractor(little_endian, bit_offset_, bit_count_);
+  if (bit_offset_ % 8 == 0 && kind_ != ValueKind::Invalid &&
+      (bit_count_ == 8 || bit_count_ == 16 || bit_count_ == 32 ||
+       bit_count_ == 64)) {
+    value_size_ = bit_count_ / 8;
+    column_kernel_ = SelectColumnKernel(value_size_,
+        little_endian != DbcHelper::IsLittleEndian());
+  }
+
+  // Only MDF 4 channels have invalidation bits.
+  const auto* cn4 = dynamic_cast<const Cn4Block*>(&channel);
+  invalid_bit_ = cn4 != nullptr && cn4->CgBlock() != nullptr &&
+                 (channel.Flags() & CnFlag::InvalidValid) != 0;
+  if (invalid_bit_) {
+    // The invalid bytes are stored after the data bytes.
+    const size_t nof_data_bytes = cn4->CgBlock()->NofDataBytes();
+    invalid_bit_pos_ = (nof_data_bytes * 8) + cn4->InvalidBitPos();
+  }
+  return true;
+}
+
+float ValueDecoder::HalfToFloat(uint16_t raw) {
+  half_float::half value;
+  value.data_ = raw;
+  return value;
+}
+
+void ValueDecoder::RangeError(size_t bit_offset, size_t size) const {
+  const size_t range_check = (bit_offset + bit_count_ + 7) / 8;
+  MDF_ERROR() << "Range check error. Byte Index: "
+    << range_check << "(" << size << "). "
+    << "Channel: " << (channel_ != nullptr ? channel_->Name() : "");
+}
+
+void DecodePlan::Create(const Cg4Block& channel_group) {
+  decoder_list_.clear();
+  channel_index_.clear();
+  const auto channel_list = channel_group.Channels();
+  decoder_list_.reserve(channel_list.size());
+  for (const auto* channel : channel_list) {
+    if (channel == nullptr) {
+      continue;
+    }
+    ValueDecoder decoder;
+    if (decoder.Create(*channel)) {
+      channel_index_.emplace(channel, decoder_list_.size());
+      decoder_list_.push_back(decoder);
+    }
+  }
+}
+
+const ValueDecoder* DecodePlan::GetDecoder(const IChannel& channel) const {
+  const auto itr = channel_index_.find(&channel);
+  return itr != channel_index_.cend() ? &decoder_list_[itr->second] : nullptr;
+}
+
+}  // namespace mdf::detail
@@ -0,0 +1,300 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+/** \file
+ * This file defines the decode plan of a channel group.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "mdf/ichannel.h"
+#include "columnextract.h"
+
+namespace mdf::detail {
+
+class Cg4Block;
+
+/** \brief Pre-resolved extractor of one channel in a record.
+ *
+ * The decoder holds everything needed to extract a numeric channel value
+ * from a sample record, i.e. bit offset, bit count, byte order, value kind
+ * and the invalidation bit. The extractor function is selected when the
+ * decoder is created, so no virtual channel properties are called when
+ * parsing the records.
+ */
+class ValueDecoder final {
+ public:
+  /** \brief Function that extracts the raw bits of a value. */
+  using Extractor = uint64_t (*)(const uint8_t* record, size_t bit_offset,
+                                 size_t bit_count);
+
+  /** \brief Interpretation of the raw bits. */
+  enum class ValueKind : uint8_t {
+    Unsigned,
+    Signed,
+    Half,
+    Float,
+    Double,
+    Invalid ///< Not a valid float size. All values are invalid.
+  };
+
+  /** \brief Creates a decoder for a channel.
+   *
+   * @param channel Channel to decode.
+   * @return True if the channel can be decoded by a decoder.
+   */
+  bool Create(const IChannel& channel);
+
+  [[nodiscard]] const IChannel* Channel() const { return channel_; }
+  [[nodiscard]] uint64_t ArraySize() const { return array_size_; }
+  /** \brief Returns true if the channel has an invalidation bit. */
+  [[nodiscard]] bool HasInvalidBit() const { return invalid_bit_; }
+
+  /** \brief Decodes a channel value from a record.
+   *
+   * The function returns the same value and valid flag as the
+   * IChannel::GetChannelValue() function.
+   * @tparam T Type of value.
+   * @param record Pointer to the record (excluding the record ID).
+   * @param size Record size in bytes.
+   * @param array_index Array index for channel arrays.
+   * @param dest Destination value.
+   * @return True if the value is valid.
+   */
+  template <typename T>
+  bool Decode(const uint8_t* record, size_t size, uint64_t array_index,
+              T& dest) const {
+    const size_t bit_offset = bit_offset_ +
+        static_cast<size_t>(array_index * bit_count_);
+    if (bit_offset + bit_count_ > size * 8) {
+      RangeError(bit_offset, size);
+      dest = static_cast<T>(0);
+      return false;
+    }
+
+    const uint64_t raw = extractor_(record, bit_offset, bit_count_);
+    switch (kind_) {
+      case ValueKind::Unsigned:
+        dest = static_cast<T>(raw);
+        break;
+
+      case ValueKind::Signed:
+        dest = static_cast<T>(ToSigned(raw));
+        break;
+
+      case ValueKind::Half:
+        dest = static_cast<T>(HalfToFloat(static_cast<uint16_t>(raw)));
+        break;
+
+      case ValueKind::Float: {
+        float value = 0;
+        const auto temp = static_cast<uint32_t>(raw);
+        memcpy(&value, &temp, sizeof(value));
+        dest = static_cast<T>(value);
+        break;
+      }
+
+      case ValueKind::Double: {
+        double value = 0;
+        memcpy(&value, &raw, sizeof(value));
+        dest = static_cast<T>(value);
+        break;
+      }
+
+      default:
+        dest = static_cast<T>(0);
+        return false;
+    }
+    return IsValid(record, size, array_index);
+  }
+
+  /** \brief Decodes a column of values from a run of records.
+   *
+   * The records are stored after each other with a fixed record size. The
+   * values are extracted by a column kernel that may use SIMD instructions.
+   * Only byte-aligned 8/16/32/64-bit values that aren't arrays are decoded
+   * this way. Note that the function doesn't check the invalidation bit.
+   * @tparam T Type of value.
+   * @param records Pointer to the first record.
+   * @param record_size Record size in bytes.
+   * @param nof_records Number of records.
+   * @param dest Destination column.
+   * @return False if the values must be decoded record by record instead.
+   */
+  template <typename T>
+  bool DecodeColumn(const uint8_t* records, size_t record_size,
+                    size_t nof_records, T* dest) const {
+    if (column_kernel_ == nullptr || array_size_ != 1 ||
+        bit_offset_ + bit_count_ > record_size * 8) {
+      return false;
+    }
+    const uint8_t* first = records + (bit_offset_ / 8);
+    if (IsNativeColumn<T>()) {
+      // Same type as stored. Extract directly into the destination.
+      column_kernel_(first, record_size, nof_records, dest);
+      return true;
+    }
+
+    // Extract into a small column that stays in the cache and convert it.
+    constexpr size_t kChunkSize = 1024;
+    uint8_t temp[kChunkSize * sizeof(uint64_t)];
+    for (size_t record = 0; record < nof_records; record += kChunkSize) {
+      const size_t count = std::min(kChunkSize, nof_records - record);
+      column_kernel_(first + (record * record_size), record_size, count, temp);
+      ConvertColumn(temp, count, dest + record);
+    }
+    return true;
+  }
+
+  /** \brief Returns true if the invalidation bit isn't set. */
+  [[nodiscard]] bool IsValid(const uint8_t* record, size_t size,
+                             uint64_t array_index) const {
+    if (!invalid_bit_) {
+      return true;
+    }
+    const auto invalid_pos = invalid_bit_pos_ +
+                             static_cast<size_t>(array_index);
+    const size_t byte_offset = invalid_pos / 8;
+    const auto mask = static_cast<uint8_t>(0x01 << (invalid_pos % 8));
+    return byte_offset >= size || (record[byte_offset] & mask) == 0;
+  }
+
+ private:
+  const IChannel* channel_ = nullptr;
+  Extractor extractor_ = nullptr;
+  ValueKind kind_ = ValueKind::Unsigned;
+  size_t bit_offset_ = 0; ///< Bit offset of the first array value.
+  size_t bit_count_ = 0;
+  uint64_t array_size_ = 1;
+  bool invalid_bit_ = false; ///< True if the channel has an invalid bit.
+  size_t invalid_bit_pos_ = 0; ///< Bit position in the record.
+  ColumnKernel column_kernel_ = nullptr; ///< Null if not byte-aligned.
+  size_t value_size_ = 0; ///< Value size in bytes for the column kernel.
+
+  template <typename T>
+  [[nodiscard]] bool IsNativeColumn() const {
+    if (sizeof(T) != value_size_ || std::is_same_v<T, bool>) {
+      return false;
+    }
+    switch (kind_) {
+      case ValueKind::Unsigned:
+        return std::is_integral_v<T> && std::is_unsigned_v<T>;
+
+      case ValueKind::Signed:
+        return std::is_integral_v<T> && std::is_signed_v<T>;
+
+      case ValueKind::Float:
+        return std::is_same_v<T, float>;
+
+      case ValueKind::Double:
+        return std::is_same_v<T, double>;
+
+      default:
+        break;
+    }
+    return false;
+  }
+
+  template <typename S, typename T>
+  static void CastColumn(const uint8_t* raw, size_t count, T* dest) {
+    for (size_t index = 0; index < count; ++index) {
+      S value;
+      memcpy(&value, raw + (index * sizeof(S)), sizeof(S));
+      dest[index] = static_cast<T>(value);
+    }
+  }
+
+  template <typename T>
+  void ConvertColumn(const uint8_t* raw, size_t count, T* dest) const {
+    switch (kind_) {
+      case ValueKind::Unsigned:
+        switch (value_size_) {
+          case 1: CastColumn<uint8_t>(raw, count, dest); break;
+          case 2: CastColumn<uint16_t>(raw, count, dest); break;
+          case 4: CastColumn<uint32_t>(raw, count, dest); break;
+          default: CastColumn<uint64_t>(raw, count, dest); break;
+        }
+        break;
+
+      case ValueKind::Signed:
+        switch (value_size_) {
+          case 1: CastColumn<int8_t>(raw, count, dest); break;
+          case 2: CastColumn<int16_t>(raw, count, dest); break;
+          case 4: CastColumn<int32_t>(raw, count, dest); break;
+          default: CastColumn<int64_t>(raw, count, dest); break;
+        }
+        break;
+
+      case ValueKind::Half:
+        for (size_t index = 0; index < count; ++index) {
+          uint16_t value;
+          memcpy(&value, raw + (index * sizeof(uint16_t)), sizeof(uint16_t));
+          dest[index] = static_cast<T>(HalfToFloat(value));
+        }
+        break;
+
+      case ValueKind::Float:
+        CastColumn<float>(raw, count, dest);
+        break;
+
+      case ValueKind::Double:
+        CastColumn<double>(raw, count, dest);
+        break;
+
+      default:
+        std::fill_n(dest, count, static_cast<T>(0));
+        break;
+    }
+  }
+
+  [[nodiscard]] int64_t ToSigned(uint64_t raw) const {
+    if (bit_count_ == 0 || bit_count_ > 64) {
+      return 0;
+    }
+    if (bit_count_ == 64) {
+      return static_cast<int64_t>(raw);
+    }
+    const auto shift = static_cast<unsigned>(64 - bit_count_);
+    return static_cast<int64_t>(raw << shift) >> shift;
+  }
+
+  static float HalfToFloat(uint16_t raw);
+  void RangeError(size_t bit_offset, size_t size) const;
+};
+
+/** \brief Decode plan of a channel group.
+ *
+ * The plan is a flat list of value decoders, one for each numeric channel
+ * in the channel group. It is created once per channel group and used by
+ * the channel observers, so the records are parsed without any channel
+ * type and data type dispatch. Channels that can't be decoded by a plain
+ * bit extraction (text, byte arrays, VLSD and virtual channels) are not in
+ * the plan and are parsed the normal way.
+ */
+class DecodePlan final {
+ public:
+  /** \brief Creates the decoders for all channels in a channel group. */
+  void Create(const Cg4Block& channel_group);
+
+  /** \brief Returns the decoder of a channel or null if not in the plan. */
+  [[nodiscard]] const ValueDecoder* GetDecoder(const IChannel& channel) const;
+
+  [[nodiscard]] const std::vector<ValueDecoder>& Decoders() const {
+    return decoder_list_;
+  }
+
+ private:
+  std::vector<ValueDecoder> decoder_list_;
+  /** \brief Channel to decoder index. */
+  std::unordered_map<const IChannel*, size_t> channel_index_;
+};
+
+}  // namespace mdf::detail
@@ -6,7 +6,9 @@
 
 #include <stdexcept>
 #include <algorithm>
+#include <atomic>
 #include <map>
+#include <thread>
 
 #include "dl4block.h"
 #include "dt4block.h"
@@ -16,6 +18,7 @@
 #include "sr4block.h"
 #include "mdf/mdflogstream.h"
 #include "readcache.h"
+#include "mappedfilebuf.h"
 
 namespace {
 constexpr size_t kIndexCg = 1;
@@ -23,6 +26,11 @@ constexpr size_t kIndexData = 2;
 constexpr size_t kIndexMd = 3;
 constexpr size_t kIndexNext = 0;
 
+// Parallel parsing of sorted data groups.
+constexpr uint64_t kMinParallelBytes = 16'000'000; ///< Min bytes per thread.
+constexpr uint64_t kParallelSampleAlignment = 64; ///< Valid bit vector word.
+constexpr size_t kRangesPerThread = 4; ///< Balance the load between threads.
+
 struct CgCounter {
   mdf::detail::Cg4Block* CgBlock = nullptr;
   uint64_t NofSamples = 0;
@@ -64,6 +72,9 @@ IChannelGroup* Dg4Block::CreateChannelGroup() {
 }
 
 MdfBlock* Dg4Block::Find(int64_t index) const {
+  if (auto* block = FindIndexed(index); block != nullptr) {
+    return block;
+  }
   for (auto& cg : cg_list_) {
     if (!cg) {
       continue;
@@ -208,6 +219,10 @@ void Dg4Block::ReadData(std::streambuf& buffer) {
     return;
   }
   InitFastObserverList();
+  // Read any deferred metadata now, so the observers don't access the
+  // file while the records are parsed.
+  ReadMetadata(buffer);
+
   // First scan through all CN blocks and set up any VLSD CG or MLSD channel
   // relations.
 
@@ -226,7 +241,7 @@ void Dg4Block::ReadData(std::streambuf& buffer) {
 
     // Fetch all signal data (SD)
     const auto channel_list = cg4->Channels();
-    for (const auto* channel :channel_list) {
+    for (auto* channel :channel_list) {
       if (channel == nullptr) {
         continue;
       }
@@ -234,7 +249,7 @@ void Dg4Block::ReadData(std::streambuf& buffer) {
       if (!IsSubscribingOnChannel(*channel) ) {
         continue;
       }
-      const auto* cn_block = dynamic_cast<const Cn4Block*>(channel);
+      auto* cn_block = dynamic_cast<Cn4Block*>(channel);
       if (cn_block == nullptr) {
         continue;
       }
@@ -325,8 +340,27 @@ void Dg4Block::ReadData(std::streambuf& buffer) {
       channel_group->ResetSampleCounter();
     }
   }
-  ReadCache read_cache(this, buffer);
-  while (read_cache.ParseRecord()) {
+  if (!ReadSortedDataParallel(buffer)) {
+    ReadCache read_cache(this, buffer);
+    if (read_buffer_size_ > 0) {
+      read_cache.BufferSize(read_buffer_size_);
+    }
+    if (read_threads_ > 0) {
+      read_cache.MaxInflateJobs(read_threads_ - 1);
+    }
+    if (read_cache.IsSorted() &&
+        IsSampleBlockSupported(cg_list_[0]->RecordId())) {
+      // Parse the data block by block instead of record by record.
+      const auto& channel_group = *cg_list_[0];
+      const uint64_t nof_samples = channel_group.NofSamples();
+      // The counter is only valid if all records were parsed.
+      if (read_cache.ParseSortedRecords(0, nof_samples)) {
+        channel_group.SampleCounter(static_cast<size_t>(nof_samples));
+      }
+    } else {
+      while (read_cache.ParseRecord()) {
+      }
+    }
   }
 
   for (const auto& cg : cg_list_) {
@@ -342,6 +376,331 @@ void Dg4Block::ReadData(std::streambuf& buffer) {
   }
 }
 
+bool Dg4Block::FindTimeRange(std::streambuf& buffer, double t_start,
+                             double t_stop, DgRange& range) {
+  if (DataBlockList().empty()) {
+    return false;
+  }
+  ReadCache read_cache(this, buffer);
+  if (read_buffer_size_ > 0) {
+    read_cache.BufferSize(read_buffer_size_);
+  }
+  // Only single records are read, so no meaning to decompress ahead.
+  read_cache.MaxInflateJobs(0);
+  // Unsorted data groups needs an index to find the records.
+  const bool sorted = read_cache.IsSorted();
+  if (!sorted && !sample_index_ &&
+      !CreateSampleIndex(buffer, DgIndex::kDefaultSampleInterval)) {
+    return false;
+  }
+
+  std::vector<uint8_t> record;
+  for (const auto& cg4 : cg_list_) {
+    if (!cg4 || (cg4->Flags() & CgFlag::VlsdChannel) != 0) {
+      continue;
+    }
+    const uint64_t record_id = cg4->RecordId();
+    auto* cg_range = range.GetCgRange(record_id);
+    if (cg_range == nullptr || !cg_range->IsUsed()) {
+      continue;
+    }
+    const auto* master = cg4->GetMasterChannel();
+    const uint64_t nof_samples = cg4->NofSamples();
+    if (master == nullptr || nof_samples == 0) {
+      cg_range->IsUsed(false);
+      continue;
+    }
+    const uint64_t record_size = cg4->NofDataBytes() + cg4->NofInvalidBytes();
+    const auto* conversion = master->ChannelConversion();
+
+    auto master_value = [&] (uint64_t sample) -> double {
+      double value = static_cast<double>(sample);
+      if (master->Type() != ChannelType::VirtualMaster) {
+        uint64_t data_offset = sample * record_size;
+        uint64_t nof_skip = 0;
+        if (!sorted) {
+          // Start at the nearest checkpoint and count the records.
+          const auto* checkpoint = sample_index_->FindCheckpoint(record_id,
+                                                                 sample);
+          const auto cg_index = static_cast<size_t>(
+              sample_index_->RecordIdIndex(record_id));
+          data_offset = checkpoint != nullptr ? checkpoint->DataOffset : 0;
+          nof_skip = checkpoint != nullptr ?
+              sample - checkpoint->SampleList[cg_index] : sample;
+        }
+        if (!read_cache.ReadRecord(data_offset, record_id, nof_skip, record)) {
+          throw std::runtime_error("Failed to read the master record.");
+        }
+        master->GetChannelValue(record, value);
+      }
+      double eng_value = value;
+      if (conversion != nullptr) {
+        conversion->Convert(value, eng_value);
+      }
+      return eng_value;
+    };
+
+    // Binary search for the first sample >= start time and the first sample
+    // > stop time.
+    uint64_t low = 0;
+    uint64_t high = nof_samples;
+    while (low < high) {
+      const uint64_t middle = low + ((high - low) / 2);
+      if (master_value(middle) < t_start) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+    const uint64_t first_sample = low;
+    high = nof_samples;
+    while (low < high) {
+      const uint64_t middle = low + ((high - low) / 2);
+      if (master_value(middle) <= t_stop) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+    const uint64_t end_sample = low;
+    if (first_sample >= end_sample) {
+      cg_range->IsUsed(false);
+      continue;
+    }
+    // Note that the range read compares the range with the sample index + 1.
+    cg_range->MinSample(static_cast<size_t>(first_sample + 1));
+    cg_range->MaxSample(static_cast<size_t>(end_sample));
+  }
+
+  // A VLSD channel group have the same samples as its parent channel group.
+  for (const auto& vlsd_group : cg_list_) {
+    if (!vlsd_group || (vlsd_group->Flags() & CgFlag::VlsdChannel) == 0) {
+      continue;
+    }
+    auto* vlsd_range = range.GetCgRange(vlsd_group->RecordId());
+    if (vlsd_range == nullptr) {
+      continue;
+    }
+    const CgRange* parent_range = nullptr;
+    for (const auto& cg4 : cg_list_) {
+      if (!cg4) {
+        continue;
+      }
+      const auto channel_list = cg4->Channels();
+      const bool parent = std::any_of(channel_list.cbegin(),
+                                      channel_list.cend(),
+          [&] (const IChannel* channel) {
+        return channel != nullptr &&
+               channel->VlsdRecordId() == vlsd_group->RecordId();
+      });
+      if (parent) {
+        parent_range = range.GetCgRange(cg4->RecordId());
+        break;
+      }
+    }
+    if (parent_range == nullptr || !parent_range->IsUsed()) {
+      vlsd_range->IsUsed(false);
+      continue;
+    }
+    vlsd_range->MinSample(parent_range->MinSample());
+    vlsd_range->MaxSample(parent_range->MaxSample());
+  }
+  return true;
+}
+
+bool Dg4Block::CreateSampleIndex(std::streambuf& buffer,
+                                 uint64_t sample_interval) {
+  sample_index_.reset();
+  std::vector<uint64_t> record_id_list;
+  for (const auto& channel_group : cg_list_) {
+    if (channel_group) {
+      record_id_list.push_back(channel_group->RecordId());
+    }
+  }
+  if (record_id_list.empty() || DataBlockList().empty()) {
+    return false;
+  }
+  auto index = std::make_unique<DgIndex>(std::move(record_id_list),
+                                         sample_interval);
+  index->DgPosition(FilePosition());
+  index->DataSize(DataSize());
+
+  ReadCache read_cache(this, buffer);
+  if (read_buffer_size_ > 0) {
+    read_cache.BufferSize(read_buffer_size_);
+  }
+  if (!read_cache.BuildSampleIndex(*index)) {
+    return false;
+  }
+  sample_index_ = std::move(index);
+  return true;
+}
+
+bool Dg4Block::SampleIndex(std::unique_ptr<DgIndex> index) {
+  if (!index) {
+    sample_index_.reset();
+    return true;
+  }
+  if (index->DgPosition() != FilePosition() ||
+      index->DataSize() != DataSize()) {
+    return false;
+  }
+  for (const auto record_id : index->RecordIdList()) {
+    if (FindCgRecordId(record_id) == nullptr) {
+      return false;
+    }
+  }
+  sample_index_ = std::move(index);
+  return true;
+}
+
+bool Dg4Block::IsSampleBlockSupported(uint64_t record_id) const {
+  const auto itr = fast_observer_list_.find(record_id);
+  if (itr == fast_observer_list_.cend() ||
+      observer_list_.size() != itr->second.size()) {
+    return false;
+  }
+  return std::all_of(itr->second.cbegin(), itr->second.cend(),
+                     [] (const ISampleObserver* observer) {
+    return observer != nullptr && observer->IsSampleBlockSupported();
+  });
+}
+
+bool Dg4Block::NotifySampleBlock(uint64_t first_sample, uint64_t record_id,
+                                 Span<const uint8_t> records,
+                                 size_t record_size) const {
+  const auto itr = fast_observer_list_.find(record_id);
+  if (itr == fast_observer_list_.cend()) {
+    return true;
+  }
+  for (ISampleObserver* observer : itr->second) {
+    if (observer != nullptr &&
+        !observer->OnSampleBlock(first_sample, record_id, records,
+                                 record_size)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Dg4Block::ReadMetadata(std::streambuf& buffer) {
+  for (const auto& cg4 : cg_list_) {
+    if (!cg4) {
+      continue;
+    }
+    for (auto* channel : cg4->Channels()) {
+      if (channel == nullptr || !IsSubscribingOnChannel(*channel)) {
+        continue;
+      }
+      if (auto* cn_block = dynamic_cast<Cn4Block*>(channel);
+          cn_block != nullptr) {
+        cn_block->ReadMetadata(buffer);
+      }
+    }
+  }
+}
+
+bool Dg4Block::ReadSortedDataParallel(std::streambuf& buffer) {
+  // Only sorted data groups have records at fixed positions. The threads
+  // read directly from the memory mapped file, so the file position isn't
+  // shared between the threads.
+  if (cg_list_.size() != 1 || !cg_list_[0] || RecordIdSize() != 0 ||
+      dynamic_cast<const MappedFileBuf*>(&buffer) == nullptr) {
+    return false;
+  }
+  const auto& channel_group = *cg_list_[0];
+  const uint64_t record_size = channel_group.NofDataBytes()
+                               + channel_group.NofInvalidBytes();
+  if ((channel_group.Flags() & CgFlag::VlsdChannel) != 0 ||
+      record_size == 0 || !IsSubscribingOnRecord(channel_group.RecordId())) {
+    return false;
+  }
+
+  // All observers must accept samples out of order from several threads.
+  const auto itr_observer = fast_observer_list_.find(channel_group.RecordId());
+  if (itr_observer == fast_observer_list_.cend() ||
+      observer_list_.size() != itr_observer->second.size()) {
+    return false;
+  }
+  const bool parallel_safe = std::all_of(itr_observer->second.cbegin(),
+      itr_observer->second.cend(), [] (const ISampleObserver* observer) {
+    return observer != nullptr && observer->IsParallelSafe();
+  });
+  // The threads deliver blocks of records, so the observers only get
+  // single records from one thread.
+  if (!parallel_safe || !IsSampleBlockSupported(channel_group.RecordId())) {
+    return false;
+  }
+
+  // A block outside the mapping is read through the stream buffer, which
+  // can't be shared by the threads. This happens if the file is truncated.
+  const auto& mapped_buffer = dynamic_cast<const MappedFileBuf&>(buffer);
+  std::vector<DataBlock*> data_block_list;
+  GetDataBlockList(data_block_list);
+  const bool mapped = std::all_of(data_block_list.cbegin(),
+      data_block_list.cend(), [&] (const DataBlock* block) -> bool {
+    if (block == nullptr) {
+      return false;
+    }
+    const auto* dz_block = dynamic_cast<const Dz4Block*>(block);
+    const uint64_t size = dz_block != nullptr ?
+        dz_block->CompressedDataSize() : block->DataSize();
+    return mapped_buffer.Data(block->DataPosition(), size) != nullptr;
+  });
+  if (!mapped) {
+    return false;
+  }
+
+  const uint64_t nof_samples = std::min(channel_group.NofSamples(),
+                                        DataSize() / record_size);
+  const uint64_t data_size = nof_samples * record_size;
+  const auto nof_cores = static_cast<uint64_t>(read_threads_ > 0 ?
+      read_threads_ : std::max(std::thread::hardware_concurrency(), 1U));
+  const auto nof_threads = static_cast<size_t>(
+      std::min(nof_cores, data_size / kMinParallelBytes));
+  if (nof_threads < 2) {
+    return false;
+  }
+
+  // Split the samples in ranges. Each range starts on an aligned sample.
+  const uint64_t nof_ranges = nof_threads * kRangesPerThread;
+  uint64_t range_size = (nof_samples + nof_ranges - 1) / nof_ranges;
+  range_size = ((range_size + kParallelSampleAlignment - 1)
+      / kParallelSampleAlignment) * kParallelSampleAlignment;
+
+  std::atomic<uint64_t> next_sample = 0;
+  std::atomic<bool> continue_reading = true;
+  auto worker = [&] () -> void {
+    ReadCache read_cache(this, buffer);
+    // The threads already run in parallel.
+    read_cache.MaxInflateJobs(0);
+    while (continue_reading) {
+      const uint64_t first_sample = next_sample.fetch_add(range_size);
+      if (first_sample >= nof_samples) {
+        break;
+      }
+      const uint64_t count = std::min(range_size, nof_samples - first_sample);
+      if (!read_cache.ParseSortedRecords(first_sample, count)) {
+        continue_reading = false;
+      }
+    }
+  };
+
+  std::vector<std::thread> thread_list;
+  thread_list.reserve(nof_threads - 1);
+  for (size_t thread = 1; thread < nof_threads; ++thread) {
+    thread_list.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : thread_list) {
+    thread.join();
+  }
+  if (continue_reading) {
+    channel_group.SampleCounter(static_cast<size_t>(nof_samples));
+  }
+  return true;
+}
+
 void Dg4Block::ReadRangeData(std::streambuf& buffer, DgRange& range) {
   const auto& block_list = DataBlockList();
   if (block_list.empty()) {
@@ -373,7 +732,7 @@ void Dg4Block::ReadRangeData(std::streambuf& buffer, DgRange& range) {
 
     // Fetch all signal data (SD)
     const auto channel_list = cg4->Channels();
-    for (const auto* channel :channel_list) {
+    for (auto* channel :channel_list) {
       if (channel == nullptr) {
         continue;
       }
@@ -381,7 +740,7 @@ void Dg4Block::ReadRangeData(std::streambuf& buffer, DgRange& range) {
       if (!IsSubscribingOnChannel(*channel) ) {
         continue;
       }
-      const auto* cn_block = dynamic_cast<const Cn4Block*>(channel);
+      auto* cn_block = dynamic_cast<Cn4Block*>(channel);
       if (cn_block == nullptr) {
         continue;
       }
@@ -430,7 +789,33 @@ void Dg4Block::ReadRangeData(std::streambuf& buffer, DgRange& range) {
     }
   }
   ReadCache read_cache(this, buffer);
-  while (read_cache.ParseRangeRecord(range)) {
+  if (read_buffer_size_ > 0) {
+    read_cache.BufferSize(read_buffer_size_);
+  }
+  if (read_threads_ > 0) {
+    read_cache.MaxInflateJobs(read_threads_ - 1);
+  }
+  if (read_cache.IsSorted()) {
+    // Fixed record positions. Seek directly to the first sample.
+    read_cache.ParseSortedRange(range);
+  } else {
+    // Start at the nearest index checkpoint if an index exists.
+    const auto* checkpoint = sample_index_ ?
+        sample_index_->FindCheckpoint(range) : nullptr;
+    if (checkpoint != nullptr) {
+      read_cache.SeekData(checkpoint->DataOffset);
+      const auto& record_id_list = sample_index_->RecordIdList();
+      for (size_t index = 0; index < record_id_list.size(); ++index) {
+        const auto* channel_group = FindCgRecordId(record_id_list[index]);
+        if (channel_group != nullptr &&
+            index < checkpoint->SampleList.size()) {
+          channel_group->SampleCounter(
+              static_cast<size_t>(checkpoint->SampleList[index]));
+        }
+      }
+    }
+    while (read_cache.ParseRangeRecord(range)) {
+    }
   }
 
   for (const auto& cg : cg_list_) {
@@ -492,6 +877,9 @@ void  Dg4Block::ReadVlsdData(std::streambuf& buffer,Cn4Block& channel,
 
   if (read_signal_data) {
     ReadCache read_cache(&channel, buffer);
+    if (read_buffer_size_ > 0) {
+      read_cache.BufferSize(read_buffer_size_);
+    }
     read_cache.SetOffsetFilter(offset_list);
     read_cache.SetCallback(callback);
     const std::set<uint64_t>& offset_filter = read_cache.GetSortedOffsetList();
@@ -507,16 +895,46 @@ void  Dg4Block::ReadVlsdData(std::streambuf& buffer,Cn4Block& channel,
     }
   } else if (read_vlsd_cg_data) {
     ReadCache read_cache(this, buffer);
+    if (read_buffer_size_ > 0) {
+      read_cache.BufferSize(read_buffer_size_);
+    }
     read_cache.SetRecordId(channel.VlsdRecordId());
     read_cache.SetOffsetFilter(offset_list);
     read_cache.SetCallback(callback);
 
-    while (read_cache.ParseVlsdCgData()) {
+    // A list of offsets is read through the VLSD index, so the records
+    // before each offset aren't scanned.
+    const VlsdIndex* index = offset_list.empty() ?
+        nullptr : GetVlsdIndex(buffer, channel.VlsdRecordId());
+    if (index != nullptr) {
+      read_cache.ParseVlsdCgOffsets(*index);
+    } else {
+      while (read_cache.ParseVlsdCgData()) {
+      }
     }
   }
 
 }
 
+const VlsdIndex* Dg4Block::GetVlsdIndex(std::streambuf& buffer,
+                                        uint64_t record_id) {
+  if (const auto itr = vlsd_index_list_.find(record_id);
+      itr != vlsd_index_list_.cend()) {
+    return itr->second.get();
+  }
+  auto index = std::make_unique<VlsdIndex>(record_id);
+  ReadCache read_cache(this, buffer);
+  if (read_buffer_size_ > 0) {
+    read_cache.BufferSize(read_buffer_size_);
+  }
+  if (!read_cache.BuildVlsdIndex(*index)) {
+    return nullptr;
+  }
+  const auto* vlsd_index = index.get();
+  vlsd_index_list_.emplace(record_id, std::move(index));
+  return vlsd_index;
+}
+
 void Dg4Block::ParseDataRecords(std::streambuf& buffer, uint64_t nof_data_bytes) const {
   if (nof_data_bytes == 0) {
     return;
@@ -3,6 +3,7 @@
  * SPDX-License-Identifier: MIT
  */
 #pragma once
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -14,6 +15,7 @@
 #include "datalistblock.h"
 #include "mdf/idatagroup.h"
 #include "dgrange.h"
+#include "dgindex.h"
 
 namespace mdf::detail {
 class Dg4Block : public DataListBlock, public IDataGroup {
@@ -42,6 +44,18 @@ class Dg4Block : public DataListBlock, public IDataGroup {
 
   void ReadData(std::streambuf& buffer);
   void ReadRangeData(std::streambuf& buffer, DgRange& range);
+  /** \brief Converts a time range to a sample range per channel group.
+   *
+   * The first and last sample are found by a binary search over the master
+   * channel. Only a few records are read for each channel group.
+   * @param buffer File stream buffer.
+   * @param t_start Start of the time range (master value).
+   * @param t_stop End of the time range (master value).
+   * @param range Range that is updated with a sample range per channel group.
+   * @return True if the range was found.
+   */
+  bool FindTimeRange(std::streambuf& buffer, double t_start, double t_stop,
+                     DgRange& range);
   void ReadVlsdData(std::streambuf& buffer,Cn4Block& channel,
                     const std::vector<uint64_t>& offset_list,
                     std::function<void(uint64_t, const std::vector<uint8_t>&)>& callback);
@@ -63,16 +77,59 @@ class Dg4Block : public DataListBlock, public IDataGroup {
   [[nodiscard]] IChannelGroup *FindParentChannelGroup(
       const IChannel &channel) const override;
   [[nodiscard]] Cg4Block* FindCgRecordId(uint64_t record_id) const;
+
+  /** \brief Scans the data and creates a sample index.
+   *
+   * The index is used by partial reads of unsorted data groups.
+   * @param buffer File stream buffer.
+   * @param sample_interval Number of samples between index checkpoints.
+   * @return True if the index was created.
+   */
+  bool CreateSampleIndex(std::streambuf& buffer, uint64_t sample_interval);
+  /** \brief Attach a sample index. Returns false if it doesn't match. */
+  bool SampleIndex(std::unique_ptr<DgIndex> index);
+  [[nodiscard]] const DgIndex* SampleIndex() const {
+    return sample_index_.get();
+  }
+
+  /** \brief Returns true if all observers of a record handle sample blocks.
+   */
+  [[nodiscard]] bool IsSampleBlockSupported(uint64_t record_id) const;
+  /** \brief Notifies the observers with a run of sorted records. */
+  bool NotifySampleBlock(uint64_t first_sample, uint64_t record_id,
+                         Span<const uint8_t> records, size_t record_size) const;
+
+  /** \brief Size of the read window when reading data. 0 = default size. */
+  void ReadBufferSize(size_t buffer_size) { read_buffer_size_ = buffer_size; }
+  [[nodiscard]] size_t ReadBufferSize() const { return read_buffer_size_; }
+
+  /** \brief Max number of threads when reading data. 0 = number of cores.
+   *
+   * Limits the DZ decompression jobs and the threads that parse a sorted
+   * data group. 1 reads everything in the calling thread.
+   */
+  void ReadThreads(unsigned nof_threads) { read_threads_ = nof_threads; }
+  [[nodiscard]] unsigned ReadThreads() const { return read_threads_; }
+
+  /** \brief Reads deferred metadata of the subscribed channels. */
+  void ReadMetadata(std::streambuf& buffer);
  private:
   uint8_t rec_id_size_ = 0;
   /* 7 byte reserved */
   Cg4List cg_list_;
+  size_t read_buffer_size_ = 0;
+  unsigned read_threads_ = 0;
+  std::unique_ptr<DgIndex> sample_index_; ///< Optional sample index.
+  /** \brief VLSD index per VLSD record ID. Created on first use. */
+  std::map<uint64_t, std::unique_ptr<VlsdIndex>> vlsd_index_list_;
 
   void ParseDataRecords(std::streambuf& buffer, uint64_t nof_data_bytes) const;
   uint64_t ReadRecordId(std::streambuf& buffer, uint64_t& record_id) const;
 
+  bool ReadSortedDataParallel(std::streambuf& buffer);
   void UpdateVlsdChannel(std::streambuf& buffer, const Cg4Block& cg4) const;
   static void UpdateDefaultX(std::streambuf& buffer, Cn4Block& cn4);
+  const VlsdIndex* GetVlsdIndex(std::streambuf& buffer, uint64_t record_id);
 
 };
 
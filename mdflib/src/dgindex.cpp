@@ -0,0 +1,168 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "dgindex.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+constexpr uint64_t kMaxListSize = 0x10000000; ///< Sanity check when reading.
+
+void WriteValue(std::ostream& output, uint64_t value) {
+  output.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+bool ReadValue(std::istream& input, uint64_t& value) {
+  input.read(reinterpret_cast<char*>(&value), sizeof(value));
+  return input.good();
+}
+
+}  // namespace
+
+namespace mdf::detail {
+
+DgIndex::DgIndex(std::vector<uint64_t> record_id_list,
+                 uint64_t sample_interval)
+: sample_interval_(std::max(sample_interval, static_cast<uint64_t>(1))),
+  record_id_list_(std::move(record_id_list)) {
+}
+
+int64_t DgIndex::RecordIdIndex(uint64_t record_id) const {
+  const auto itr = std::find(record_id_list_.cbegin(), record_id_list_.cend(),
+                             record_id);
+  return itr == record_id_list_.cend() ? -1 :
+         static_cast<int64_t>(std::distance(record_id_list_.cbegin(), itr));
+}
+
+void DgIndex::AddCheckpoint(uint64_t data_offset,
+                            const std::vector<uint64_t>& sample_list) {
+  Checkpoint checkpoint;
+  checkpoint.DataOffset = data_offset;
+  checkpoint.SampleList = sample_list;
+  checkpoint_list_.push_back(std::move(checkpoint));
+}
+
+const DgIndex::Checkpoint* DgIndex::FindCheckpoint(
+    const DgRange& range) const {
+  auto nearest = checkpoint_list_.cend();
+  bool used = false;
+  for (size_t index = 0; index < record_id_list_.size(); ++index) {
+    const auto* cg_range = range.GetCgRange(record_id_list_[index]);
+    if (cg_range == nullptr || !cg_range->IsUsed()) {
+      continue;
+    }
+    used = true;
+    // Note that the range read compares the range with the sample index + 1.
+    const uint64_t first_sample = cg_range->MinSample() > 0 ?
+                                  cg_range->MinSample() - 1 : 0;
+    // The sample counters are ascending, so find the first checkpoint that
+    // has passed the first sample.
+    const auto itr = std::upper_bound(checkpoint_list_.cbegin(), nearest,
+        first_sample, [index] (uint64_t sample, const Checkpoint& checkpoint) {
+      return index < checkpoint.SampleList.size() &&
+             sample < checkpoint.SampleList[index];
+    });
+    nearest = itr;
+  }
+  if (!used || nearest == checkpoint_list_.cbegin()) {
+    return nullptr;
+  }
+  return &(*std::prev(nearest));
+}
+
+const DgIndex::Checkpoint* DgIndex::FindCheckpoint(uint64_t record_id,
+                                                   uint64_t sample) const {
+  const int64_t index = RecordIdIndex(record_id);
+  if (index < 0) {
+    return nullptr;
+  }
+  const auto itr = std::upper_bound(checkpoint_list_.cbegin(),
+                                    checkpoint_list_.cend(), sample,
+      [index] (uint64_t value, const Checkpoint& checkpoint) {
+    const auto cg_index = static_cast<size_t>(index);
+    return cg_index < checkpoint.SampleList.size() &&
+           value < checkpoint.SampleList[cg_index];
+  });
+  return itr == checkpoint_list_.cbegin() ? nullptr : &(*std::prev(itr));
+}
+
+void DgIndex::Write(std::ostream& output) const {
+  WriteValue(output, static_cast<uint64_t>(dg_position_));
+  WriteValue(output, data_size_);
+  WriteValue(output, sample_interval_);
+  WriteValue(output, record_id_list_.size());
+  for (const auto record_id : record_id_list_) {
+    WriteValue(output, record_id);
+  }
+  WriteValue(output, checkpoint_list_.size());
+  for (const auto& checkpoint : checkpoint_list_) {
+    WriteValue(output, checkpoint.DataOffset);
+    for (size_t index = 0; index < record_id_list_.size(); ++index) {
+      WriteValue(output, index < checkpoint.SampleList.size() ?
+                         checkpoint.SampleList[index] : 0);
+    }
+  }
+}
+
+bool DgIndex::Read(std::istream& input) {
+  uint64_t position = 0;
+  uint64_t nof_records = 0;
+  uint64_t nof_checkpoints = 0;
+  if (!ReadValue(input, position) || !ReadValue(input, data_size_) ||
+      !ReadValue(input, sample_interval_) || !ReadValue(input, nof_records) ||
+      nof_records > kMaxListSize) {
+    return false;
+  }
+  dg_position_ = static_cast<int64_t>(position);
+  record_id_list_.resize(static_cast<size_t>(nof_records));
+  for (auto& record_id : record_id_list_) {
+    if (!ReadValue(input, record_id)) {
+      return false;
+    }
+  }
+
+  if (!ReadValue(input, nof_checkpoints) || nof_checkpoints > kMaxListSize) {
+    return false;
+  }
+  checkpoint_list_.resize(static_cast<size_t>(nof_checkpoints));
+  for (auto& checkpoint : checkpoint_list_) {
+    checkpoint.SampleList.resize(record_id_list_.size());
+    if (!ReadValue(input, checkpoint.DataOffset)) {
+      return false;
+    }
+    for (auto& sample : checkpoint.SampleList) {
+      if (!ReadValue(input, sample)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+VlsdIndex::VlsdIndex(uint64_t record_id, uint64_t distance)
+    : record_id_(record_id),
+      distance_(std::max<uint64_t>(distance, 1)) {
+}
+
+void VlsdIndex::AddRecord(uint64_t vlsd_offset, uint64_t data_offset) {
+  if (checkpoint_list_.empty() ||
+      data_offset >= checkpoint_list_.back().DataOffset + distance_) {
+    checkpoint_list_.push_back({vlsd_offset, data_offset});
+  }
+}
+
+const VlsdIndex::Checkpoint* VlsdIndex::FindCheckpoint(
+    uint64_t vlsd_offset) const {
+  const auto itr = std::upper_bound(checkpoint_list_.cbegin(),
+                                    checkpoint_list_.cend(), vlsd_offset,
+      [] (uint64_t value, const Checkpoint& checkpoint) {
+    return value < checkpoint.VlsdOffset;
+  });
+  return itr == checkpoint_list_.cbegin() ? nullptr : &(*std::prev(itr));
+}
+
+}  // namespace mdf::detail
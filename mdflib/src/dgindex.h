@@ -0,0 +1,166 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+/** \file
+ * This file defines the sample index of unsorted data groups.
+ */
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "dgrange.h"
+
+namespace mdf::detail {
+
+/** \brief Sample-to-offset index of an unsorted data group.
+ *
+ * An unsorted data group (DG) interleaves records from several channel
+ * groups (CG), so the position of a sample can't be calculated. The index
+ * stores a checkpoint every N samples per record ID. A checkpoint holds the
+ * data offset of a record and the sample counters of all channel groups at
+ * that record. A partial read may then start at the nearest checkpoint
+ * instead of scanning all records from the start of the data.
+ *
+ * The index is created by scanning the data group once and can be saved to
+ * and restored from a stream, typically a sidecar file next to the MDF file.
+ */
+class DgIndex final {
+ public:
+  /** \brief Index checkpoint. */
+  struct Checkpoint {
+    uint64_t DataOffset = 0; ///< Offset of the record in the data.
+    std::vector<uint64_t> SampleList; ///< Sample counter per record ID.
+  };
+
+  static constexpr uint64_t kDefaultSampleInterval = 10'000;
+
+  DgIndex() = default;
+  /** \brief Creates an empty index.
+   *
+   * @param record_id_list Record ID of all channel groups.
+   * @param sample_interval Samples between checkpoints.
+   */
+  DgIndex(std::vector<uint64_t> record_id_list, uint64_t sample_interval);
+
+  /** \brief File position of the DG block. Used to validate the index. */
+  void DgPosition(int64_t position) { dg_position_ = position; }
+  [[nodiscard]] int64_t DgPosition() const { return dg_position_; }
+
+  /** \brief Total number of data bytes. Used to validate the index. */
+  void DataSize(uint64_t data_size) { data_size_ = data_size; }
+  [[nodiscard]] uint64_t DataSize() const { return data_size_; }
+
+  [[nodiscard]] uint64_t SampleInterval() const { return sample_interval_; }
+  [[nodiscard]] const std::vector<uint64_t>& RecordIdList() const {
+    return record_id_list_;
+  }
+  [[nodiscard]] const std::vector<Checkpoint>& Checkpoints() const {
+    return checkpoint_list_;
+  }
+
+  /** \brief Returns the index of a record ID or -1 if not found. */
+  [[nodiscard]] int64_t RecordIdIndex(uint64_t record_id) const;
+
+  /** \brief Adds a checkpoint. The data offset must be ascending. */
+  void AddCheckpoint(uint64_t data_offset,
+                     const std::vector<uint64_t>& sample_list);
+
+  /** \brief Returns the nearest checkpoint before a range.
+   *
+   * Returns the last checkpoint where no used channel group has passed the
+   * first sample in the range. All records before that checkpoint would be
+   * skipped by a range read.
+   * @param range Sample range to read.
+   * @return Pointer to the checkpoint or null if the read should start
+   * from the beginning.
+   */
+  [[nodiscard]] const Checkpoint* FindCheckpoint(const DgRange& range) const;
+
+  /** \brief Returns the nearest checkpoint before a channel group sample.
+   *
+   * @param record_id Record ID of the channel group.
+   * @param sample Sample index in the channel group.
+   * @return Pointer to the checkpoint or null if the sample is before the
+   * first checkpoint.
+   */
+  [[nodiscard]] const Checkpoint* FindCheckpoint(uint64_t record_id,
+                                                 uint64_t sample) const;
+
+  /** \brief Writes the index to a binary stream. */
+  void Write(std::ostream& output) const;
+  /** \brief Reads the index from a binary stream. */
+  bool Read(std::istream& input);
+
+ private:
+  int64_t dg_position_ = 0;
+  uint64_t data_size_ = 0;
+  uint64_t sample_interval_ = kDefaultSampleInterval;
+  std::vector<uint64_t> record_id_list_;
+  std::vector<Checkpoint> checkpoint_list_;
+};
+
+/** \brief Offset-to-position index of a VLSD channel group.
+ *
+ * A VLSD channel group stores variable length values as records in the
+ * data group. The channel value is an offset that is the sum of the sizes
+ * of all previous VLSD records. The index stores checkpoints with the VLSD
+ * offset and the data offset of a VLSD record, so a read of a few values may
+ * start at the nearest checkpoint instead of scanning all records from the
+ * start of the data.
+ *
+ * A checkpoint is added when the data offset has moved a distance from the
+ * previous checkpoint, so the number of bytes that are scanned to reach an
+ * offset is limited even if the values are large.
+ */
+class VlsdIndex final {
+ public:
+  /** \brief Index checkpoint. */
+  struct Checkpoint {
+    uint64_t VlsdOffset = 0; ///< Offset of the VLSD value (channel value).
+    uint64_t DataOffset = 0; ///< Offset of the record in the data.
+  };
+
+  static constexpr uint64_t kDefaultCheckpointDistance = 1'000'000; ///< 1 MB
+
+  /** \brief Creates an empty index.
+   *
+   * @param record_id Record ID of the VLSD channel group.
+   * @param distance Min number of data bytes between checkpoints.
+   */
+  explicit VlsdIndex(uint64_t record_id,
+                     uint64_t distance = kDefaultCheckpointDistance);
+
+  [[nodiscard]] uint64_t RecordId() const { return record_id_; }
+  [[nodiscard]] uint64_t CheckpointDistance() const { return distance_; }
+  [[nodiscard]] const std::vector<Checkpoint>& Checkpoints() const {
+    return checkpoint_list_;
+  }
+
+  /** \brief Adds a VLSD record to the index.
+   *
+   * Shall be called for each VLSD record in ascending order. The function
+   * decides if the record is a checkpoint.
+   * @param vlsd_offset VLSD offset of the record.
+   * @param data_offset Data offset of the record.
+   */
+  void AddRecord(uint64_t vlsd_offset, uint64_t data_offset);
+
+  /** \brief Returns the nearest checkpoint at or before a VLSD offset.
+   *
+   * @param vlsd_offset VLSD offset to find.
+   * @return Pointer to the checkpoint or null if the index is empty.
+   */
+  [[nodiscard]] const Checkpoint* FindCheckpoint(uint64_t vlsd_offset) const;
+
+ private:
+  uint64_t record_id_ = 0;
+  uint64_t distance_ = kDefaultCheckpointDistance;
+  std::vector<Checkpoint> checkpoint_list_;
+};
+
+}  // namespace mdf::detail
@@ -38,6 +38,8 @@ DgRange::DgRange(const IDataGroup& data_group, size_t min_sample,
 
     CgRange cg_range(*channel_group);
     cg_range.IsUsed(used);
+    cg_range.MinSample(min_sample_);
+    cg_range.MaxSample(max_sample_);
     cg_list_.emplace(record_id, cg_range);
 
   }
@@ -54,6 +56,11 @@ CgRange* DgRange::GetCgRange(uint64_t record_id) {
   return itr == cg_list_.cend() ? nullptr : &itr->second;
 }
 
+const CgRange* DgRange::GetCgRange(uint64_t record_id) const {
+  const auto itr = cg_list_.find(record_id);
+  return itr == cg_list_.cend() ? nullptr : &itr->second;
+}
+
 bool DgRange::IsReady() const {
   return std::all_of(cg_list_.begin(), cg_list_.cend(),
                      [&] (const auto& itr) -> bool {
@@ -25,6 +25,7 @@ class DgRange final {
   [[nodiscard]] bool IsUsed(uint64_t record_id) const;
   [[nodiscard]] bool IsReady() const;
   [[nodiscard]] CgRange* GetCgRange(uint64_t record_id);
+  [[nodiscard]] const CgRange* GetCgRange(uint64_t record_id) const;
   [[nodiscard]] size_t MinSample() const { return min_sample_;}
   [[nodiscard]] size_t MaxSample() const { return max_sample_;};
  private:
@@ -119,40 +119,50 @@ uint64_t Dz4Block::CopyDataToBuffer(std::streambuf& from_file,
     return 0;
   }
 
+  ByteArray temp;
+  ReadCompressedData(from_file, temp);
+  ByteArray out;
+  if (!InflateData(temp, out)) {
+    return 0;
+  }
+  const auto count = static_cast<uint64_t>(out.size());
+  memcpy(dest.data() + buffer_index, out.data(), static_cast<size_t>(count) );
+  buffer_index += count;
+  return count;
+}
+
+void Dz4Block::ReadCompressedData(std::streambuf& from_file,
+                                  std::vector<uint8_t>& dest) const {
+  dest.resize(static_cast<size_t>(data_length_), 0);
+  if (dest.empty()) {
+    return;
+  }
   SetFilePosition(from_file, data_position_);
+  from_file.sgetn( reinterpret_cast<char*>(dest.data()),
+                   static_cast<std::streamsize>(dest.size()) );
+}
 
-  uint64_t count = 0;
+bool Dz4Block::InflateData(const std::vector<uint8_t>& compressed,
+                           std::vector<uint8_t>& dest) const {
+  dest.resize(static_cast<size_t>(orig_data_length_), 0);
   switch (static_cast<Dz4ZipType>(type_)) {
-    case Dz4ZipType::Deflate: {
-      ByteArray temp(static_cast<size_t>(data_length_), 0);
-      from_file.sgetn( reinterpret_cast<char*>(temp.data()),
-                              static_cast<std::streamsize>(temp.size()) );
-      ByteArray out(static_cast<size_t>(orig_data_length_), 0);
-      Inflate(temp, out);
-      count = orig_data_length_;
-      memcpy(dest.data() + buffer_index, out.data(), static_cast<size_t>(count) );
-      buffer_index += count;
+    case Dz4ZipType::Deflate:
+      Inflate(compressed, dest);
       break;
-    }
 
-    case Dz4ZipType::TransposeAndDeflate: {
-      ByteArray temp(static_cast<size_t>(data_length_), 0);
-      from_file.sgetn(reinterpret_cast<char*>(temp.data()),
-                      static_cast<std::streamsize>(temp.size()) );
-      ByteArray out(static_cast<size_t>( orig_data_length_ ), 0);
-      Inflate(temp, out);
-      InvTranspose(out, parameter_);
 
-      count = orig_data_length_;
-      memcpy(dest.data() + buffer_index, out.data(), static_cast<size_t>(count) );
-      buffer_index += count;
+    case Dz4ZipType::TransposeAndDeflate:
+      Inflate(compressed, dest);
+      InvTranspose(dest, parameter_);
       break;
-    }
 
     default:
-      break;
+      dest.clear();
+      return false;
   }
-  return count;
+  // A corrupt block may give less bytes than expected.
+  dest.resize(static_cast<size_t>(orig_data_length_), 0);
+  return true;
 }
 
 bool Dz4Block::Data(const std::vector<uint8_t> &uncompressed_data) {
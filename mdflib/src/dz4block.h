@@ -38,6 +38,20 @@ class Dz4Block : public DataBlock {
 
   bool Data(const std::vector<uint8_t>& uncompressed_data) override;
 
+  /** \brief Reads in the compressed data bytes. */
+  void ReadCompressedData(std::streambuf& from_file,
+                          std::vector<uint8_t>& dest) const;
+  /** \brief Decompress the data bytes.
+   *
+   * The function doesn't use the file, so it can be called from a worker
+   * thread.
+   * @param compressed Compressed data bytes.
+   * @param dest Destination buffer. Resized to the original data length.
+   * @return True if the zip type is supported.
+   */
+  bool InflateData(const std::vector<uint8_t>& compressed,
+                   std::vector<uint8_t>& dest) const;
+
  private:
   std::string orig_block_type_ = "DT";
   uint8_t type_ = 0; ///< Default is Deflate
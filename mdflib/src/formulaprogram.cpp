@@ -0,0 +1,675 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "formulaprogram.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <initializer_list>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <string_view>
+
+namespace {
+
+using mdf::detail::FormulaProgram;
+using OpCode = FormulaProgram::OpCode;
+using Instruction = FormulaProgram::Instruction;
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+/** \brief Max number of nested parentheses and unary operators. */
+constexpr size_t kMaxNesting = 256;
+
+struct FunctionDef {
+  std::string_view Name;
+  double (*Function1)(double) = nullptr;
+  double (*Function2)(double, double) = nullptr;
+};
+
+const std::array<FunctionDef, 25> kFunctionList = {{
+    {"abs", [] (double a) { return std::fabs(a); }},
+    {"sign", [] (double a) {
+       return a > 0.0 ? 1.0 : (a < 0.0 ? -1.0 : a);
+     }},
+    {"sqrt", [] (double a) { return std::sqrt(a); }},
+    {"exp", [] (double a) { return std::exp(a); }},
+    {"ln", [] (double a) { return std::log(a); }},
+    {"log", [] (double a) { return std::log(a); }},
+    {"log10", [] (double a) { return std::log10(a); }},
+    {"sin", [] (double a) { return std::sin(a); }},
+    {"cos", [] (double a) { return std::cos(a); }},
+    {"tan", [] (double a) { return std::tan(a); }},
+    {"asin", [] (double a) { return std::asin(a); }},
+    {"acos", [] (double a) { return std::acos(a); }},
+    {"atan", [] (double a) { return std::atan(a); }},
+    {"sinh", [] (double a) { return std::sinh(a); }},
+    {"cosh", [] (double a) { return std::cosh(a); }},
+    {"tanh", [] (double a) { return std::tanh(a); }},
+    {"floor", [] (double a) { return std::floor(a); }},
+    {"ceil", [] (double a) { return std::ceil(a); }},
+    {"round", [] (double a) { return std::round(a); }},
+    {"trunc", [] (double a) { return std::trunc(a); }},
+    {"pow", nullptr, [] (double a, double b) { return std::pow(a, b); }},
+    {"atan2", nullptr, [] (double a, double b) { return std::atan2(a, b); }},
+    {"min", nullptr, [] (double a, double b) { return std::min(a, b); }},
+    {"max", nullptr, [] (double a, double b) { return std::max(a, b); }},
+    {"fmod", nullptr, [] (double a, double b) { return std::fmod(a, b); }},
+}};
+
+bool ToInteger(double value, int64_t& integer) {
+  // The range check also fails on NaN.
+  constexpr double kLimit = 9223372036854775807.0;
+  if (!(value >= -kLimit && value < kLimit)) {
+    return false;
+  }
+  integer = static_cast<int64_t>(value);
+  return true;
+}
+
+template <typename Op>
+void ApplyUnary(double* a, size_t count, Op op) {
+  for (size_t index = 0; index < count; ++index) {
+    a[index] = op(a[index]);
+  }
+}
+
+template <typename Op>
+void ApplyBinary(double* a, const double* b, size_t count, Op op) {
+  for (size_t index = 0; index < count; ++index) {
+    a[index] = op(a[index], b[index]);
+  }
+}
+
+template <typename Op>
+void ApplyInteger(double* a, const double* b, size_t count, Op op) {
+  for (size_t index = 0; index < count; ++index) {
+    int64_t value1 = 0;
+    int64_t value2 = 0;
+    a[index] = ToInteger(a[index], value1) && ToInteger(b[index], value2) ?
+        op(value1, value2) : kNaN;
+  }
+}
+
+/** \brief Recursive descent parser that emits the program. */
+class FormulaParser final {
+ public:
+  FormulaParser(std::string_view text, std::vector<Instruction>& program,
+                std::vector<double>& constant_list)
+      : text_(text),
+        program_(program),
+        constant_list_(constant_list) {}
+
+  bool Parse() {
+    SkipSpace();
+    if (pos_ >= text_.size()) {
+      return Fail("Empty formula");
+    }
+    if (!ParseOr()) {
+      return false;
+    }
+    SkipSpace();
+    if (pos_ < text_.size()) {
+      return Fail("Unexpected character");
+    }
+    return true;
+  }
+
+  [[nodiscard]] size_t StackDepth() const { return max_depth_; }
+  [[nodiscard]] const std::string& Error() const { return error_; }
+
+ private:
+  struct OperatorDef {
+    std::string_view Token;
+    std::string_view NotFollowedBy;
+    OpCode Code;
+  };
+
+  std::string_view text_;
+  size_t pos_ = 0;
+  std::vector<Instruction>& program_;
+  std::vector<double>& constant_list_;
+  size_t depth_ = 0;
+  size_t max_depth_ = 0;
+  size_t nesting_ = 0;
+  std::string error_;
+
+  bool Fail(const std::string& error) {
+    if (error_.empty()) {
+      error_ = error + ". Position: " + std::to_string(pos_);
+    }
+    return false;
+  }
+
+  void SkipSpace() {
+    while (pos_ < text_.size() &&
+           std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+      ++pos_;
+    }
+  }
+
+  bool Match(std::string_view token, std::string_view not_followed_by = {}) {
+    SkipSpace();
+    if (text_.substr(pos_, token.size()) != token) {
+      return false;
+    }
+    const size_t next = pos_ + token.size();
+    if (next < text_.size() &&
+        not_followed_by.find(text_[next]) != std::string_view::npos) {
+      return false;
+    }
+    pos_ = next;
+    return true;
+  }
+
+  bool Emit(OpCode code, uint16_t argument = 0) {
+    switch (code) {
+      case OpCode::Variable:
+      case OpCode::Constant:
+        ++depth_;
+        break;
+
+      case OpCode::Negate:
+      case OpCode::Not:
+      case OpCode::BitNot:
+      case OpCode::Function1:
+        break;
+
+      default:
+        --depth_;
+        break;
+    }
+    max_depth_ = std::max(max_depth_, depth_);
+    if (max_depth_ > FormulaProgram::kMaxStackDepth) {
+      return Fail("Too complex formula");
+    }
+    program_.push_back({code, argument});
+    return true;
+  }
+
+  bool EmitConstant(double value) {
+    if (constant_list_.size() >= std::numeric_limits<uint16_t>::max()) {
+      return Fail("Too many constants");
+    }
+    constant_list_.push_back(value);
+    return Emit(OpCode::Constant,
+                static_cast<uint16_t>(constant_list_.size() - 1));
+  }
+
+  bool ParseBinary(bool (FormulaParser::*next)(),
+                   std::initializer_list<OperatorDef> operator_list) {
+    if (!(this->*next)()) {
+      return false;
+    }
+    for (bool found = true; found;) {
+      found = false;
+      for (const auto& oper : operator_list) {
+        if (Match(oper.Token, oper.NotFollowedBy)) {
+          if (!(this->*next)() || !Emit(oper.Code)) {
+            return false;
+          }
+          found = true;
+          break;
+        }
+      }
+    }
+    return true;
+  }
+
+  bool ParseOr() {
+    return ParseBinary(&FormulaParser::ParseAnd,
+                       {{"||", {}, OpCode::Or}});
+  }
+
+  bool ParseAnd() {
+    return ParseBinary(&FormulaParser::ParseBitOr,
+                       {{"&&", {}, OpCode::And}});
+  }
+
+  bool ParseBitOr() {
+    return ParseBinary(&FormulaParser::ParseBitAnd,
+                       {{"|", "|", OpCode::BitOr}});
+  }
+
+  bool ParseBitAnd() {
+    return ParseBinary(&FormulaParser::ParseEquality,
+                       {{"&", "&", OpCode::BitAnd}});
+  }
+
+  bool ParseEquality() {
+    return ParseBinary(&FormulaParser::ParseRelational,
+                       {{"==", {}, OpCode::Equal},
+                        {"!=", {}, OpCode::NotEqual},
+                        {"<>", {}, OpCode::NotEqual},
+                        {"=", {}, OpCode::Equal}});
+  }
+
+  bool ParseRelational() {
+    return ParseBinary(&FormulaParser::ParseShift,
+                       {{"<=", {}, OpCode::LessEqual},
+                        {">=", {}, OpCode::GreaterEqual},
+                        {"<", "<>", OpCode::Less},
+                        {">", ">", OpCode::Greater}});
+  }
+
+  bool ParseShift() {
+    return ParseBinary(&FormulaParser::ParseAdditive,
+                       {{"<<", {}, OpCode::ShiftLeft},
+                        {">>", {}, OpCode::ShiftRight}});
+  }
+
+  bool ParseAdditive() {
+    return ParseBinary(&FormulaParser::ParseMultiplicative,
+                       {{"+", {}, OpCode::Add},
+                        {"-", {}, OpCode::Subtract}});
+  }
+
+  bool ParseMultiplicative() {
+    return ParseBinary(&FormulaParser::ParseUnary,
+                       {{"*", "*", OpCode::Multiply},
+                        {"/", {}, OpCode::Divide},
+                        {"%", {}, OpCode::Modulo}});
+  }
+
+  bool ParseUnary() {
+    if (++nesting_ > kMaxNesting) {
+      return Fail("Too deep nesting");
+    }
+    bool valid;
+    if (Match("-")) {
+      valid = ParseUnary() && Emit(OpCode::Negate);
+    } else if (Match("+")) {
+      valid = ParseUnary();
+    } else if (Match("!", "=")) {
+      valid = ParseUnary() && Emit(OpCode::Not);
+    } else if (Match("~")) {
+      valid = ParseUnary() && Emit(OpCode::BitNot);
+    } else {
+      valid = ParsePower();
+    }
+    --nesting_;
+    return valid;
+  }
+
+  bool ParsePower() {
+    // The power operator is right associative and binds harder than the
+    // unary minus, i.e. -X^2 = -(X^2) and 2^-X = 2^(-X).
+    if (!ParsePrimary()) {
+      return false;
+    }
+    if (Match("^") || Match("**")) {
+      return ParseUnary() && Emit(OpCode::Power);
+    }
+    return true;
+  }
+
+  bool ParsePrimary() {
+    SkipSpace();
+    if (pos_ >= text_.size()) {
+      return Fail("Unexpected end of formula");
+    }
+    const char first = text_[pos_];
+    if (first == '(') {
+      ++pos_;
+      if (!ParseOr()) {
+        return false;
+      }
+      return Match(")") ? true : Fail("Missing ')'");
+    }
+    if (std::isdigit(static_cast<unsigned char>(first)) ||
+        (first == '.' && pos_ + 1 < text_.size() &&
+         std::isdigit(static_cast<unsigned char>(text_[pos_ + 1])))) {
+      return ParseNumber();
+    }
+    if (std::isalpha(static_cast<unsigned char>(first)) || first == '_') {
+      return ParseIdentifier();
+    }
+    return Fail("Unexpected character");
+  }
+
+  bool ParseNumber() {
+    const size_t start = pos_;
+    if (text_.substr(pos_, 2) == "0x" || text_.substr(pos_, 2) == "0X") {
+      pos_ += 2;
+      uint64_t value = 0;
+      size_t nof_digits = 0;
+      for (; pos_ < text_.size() &&
+             std::isxdigit(static_cast<unsigned char>(text_[pos_]));
+             ++pos_, ++nof_digits) {
+        const char digit = static_cast<char>(
+            std::tolower(static_cast<unsigned char>(text_[pos_])));
+        value = (value * 16) +
+            static_cast<uint64_t>(std::isdigit(static_cast<unsigned char>(
+                digit)) ? digit - '0' : digit - 'a' + 10);
+      }
+      if (nof_digits == 0 || nof_digits > 16) {
+        return Fail("Invalid hexadecimal number");
+      }
+      return EmitConstant(static_cast<double>(value));
+    }
+
+    const auto is_digit = [&] (size_t pos) {
+      return pos < text_.size() &&
+             std::isdigit(static_cast<unsigned char>(text_[pos]));
+    };
+    while (is_digit(pos_)) {
+      ++pos_;
+    }
+    if (pos_ < text_.size() && text_[pos_] == '.') {
+      ++pos_;
+      while (is_digit(pos_)) {
+        ++pos_;
+      }
+    }
+    if (pos_ < text_.size() && (text_[pos_] == 'e' || text_[pos_] == 'E')) {
+      size_t exponent = pos_ + 1;
+      if (exponent < text_.size() &&
+          (text_[exponent] == '+' || text_[exponent] == '-')) {
+        ++exponent;
+      }
+      if (is_digit(exponent)) {
+        pos_ = exponent;
+        while (is_digit(pos_)) {
+          ++pos_;
+        }
+      }
+    }
+
+    // Note that the number is independent of the global locale.
+    std::istringstream number(std::string(text_.substr(start, pos_ - start)));
+    number.imbue(std::locale::classic());
+    double value = 0.0;
+    number >> value;
+    if (number.fail()) {
+      return Fail("Invalid number");
+    }
+    return EmitConstant(value);
+  }
+
+  bool ParseIdentifier() {
+    const size_t start = pos_;
+    while (pos_ < text_.size() &&
+           (std::isalnum(static_cast<unsigned char>(text_[pos_])) ||
+            text_[pos_] == '_')) {
+      ++pos_;
+    }
+    const auto name = text_.substr(start, pos_ - start);
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [] (char in) {
+      return static_cast<char>(std::tolower(static_cast<unsigned char>(in)));
+    });
+
+    if (!Match("(")) {
+      if (lower == "x" || lower == "x1") {
+        return Emit(OpCode::Variable);
+      }
+      if (lower == "pi") {
+        return EmitConstant(kPi);
+      }
+      pos_ = start;
+      return Fail("Unknown variable");
+    }
+
+    size_t function = 0;
+    for (; function < kFunctionList.size(); ++function) {
+      if (kFunctionList[function].Name == lower) {
+        break;
+      }
+    }
+    if (function >= kFunctionList.size()) {
+      pos_ = start;
+      return Fail("Unknown function");
+    }
+    const auto& def = kFunctionList[function];
+    if (!ParseOr()) {
+      return false;
+    }
+    if (def.Function2 != nullptr) {
+      if (!Match(",")) {
+        return Fail("Missing function argument");
+      }
+      if (!ParseOr()) {
+        return false;
+      }
+    }
+    if (!Match(")")) {
+      return Fail("Missing ')'");
+    }
+    return Emit(def.Function2 != nullptr ? OpCode::Function2 :
+                OpCode::Function1, static_cast<uint16_t>(function));
+  }
+};
+
+}  // namespace
+
+namespace mdf::detail {
+
+bool FormulaProgram::Compile(const std::string& formula) {
+  program_.clear();
+  constant_list_.clear();
+  stack_depth_ = 0;
+  error_.clear();
+
+  FormulaParser parser(formula, program_, constant_list_);
+  if (!parser.Parse()) {
+    program_.clear();
+    constant_list_.clear();
+    error_ = parser.Error();
+    return false;
+  }
+  stack_depth_ = parser.StackDepth();
+  return true;
+}
+
+bool FormulaProgram::Evaluate(double value, double& result) const {
+  if (!IsCompiled()) {
+    return false;
+  }
+  double stack[kMaxStackDepth];
+  Run(&value, &result, 1, stack);
+  return std::isfinite(result);
+}
+
+bool FormulaProgram::Evaluate(const double* in, double* out, uint8_t* valid,
+                              size_t count) const {
+  if (!IsCompiled()) {
+    std::fill_n(out, count, 0.0);
+    std::fill_n(valid, count, static_cast<uint8_t>(0));
+    return count == 0;
+  }
+
+  // Each stack level is a column of values. The chunk size keeps the
+  // columns in the cache.
+  constexpr size_t kChunkSize = 256;
+  std::vector<double> stack(stack_depth_ * std::min(count, kChunkSize));
+  bool all_valid = true;
+  for (size_t first = 0; first < count; first += kChunkSize) {
+    const size_t nof_values = std::min(kChunkSize, count - first);
+    Run(in + first, out + first, nof_values, stack.data());
+    for (size_t index = first; index < first + nof_values; ++index) {
+      const bool ok = std::isfinite(out[index]);
+      valid[index] = ok ? 1 : 0;
+      all_valid = all_valid && ok;
+    }
+  }
+  return all_valid;
+}
+
+void FormulaProgram::Run(const double* in, double* out, size_t count,
+                         double* stack) const {
+  size_t depth = 0;
+  const auto level = [stack, count] (size_t index) {
+    return stack + (index * count);
+  };
+  for (const auto& instruction : program_) {
+    switch (instruction.Code) {
+      case OpCode::Variable:
+        std::copy_n(in, count, level(depth++));
+        break;
+
+      case OpCode::Constant:
+        std::fill_n(level(depth++), count,
+                    constant_list_[instruction.Argument]);
+        break;
+
+      case OpCode::Negate:
+        ApplyUnary(level(depth - 1), count, [] (double a) { return -a; });
+        break;
+
+      case OpCode::Not:
+        ApplyUnary(level(depth - 1), count, [] (double a) {
+          return a == 0.0 ? 1.0 : 0.0;
+        });
+        break;
+
+      case OpCode::BitNot:
+        ApplyUnary(level(depth - 1), count, [] (double a) {
+          int64_t value = 0;
+          return ToInteger(a, value) ? static_cast<double>(~value) : kNaN;
+        });
+        break;
+
+      case OpCode::Function1:
+        ApplyUnary(level(depth - 1), count,
+                   kFunctionList[instruction.Argument].Function1);
+        break;
+
+      default: {
+        // Binary operation. The result replaces the left operand.
+        double* a = level(depth - 2);
+        const double* b = level(depth - 1);
+        --depth;
+        switch (instruction.Code) {
+          case OpCode::Add:
+            ApplyBinary(a, b, count, [] (double a1, double b1) {
+              return a1 + b1;
+            });
+            break;
+
+          case OpCode::Subtract:
+            ApplyBinary(a, b, count, [] (double a1, double b1) {
+              return a1 - b1;
+            });
+            break;
+
+          case OpCode::Multiply:
+            ApplyBinary(a, b, count, [] (double a1, double b1) {
+              return a1 * b1;
+            });
+            break;
+
+          case OpCode::Divide:
+            ApplyBinary(a, b, count, [] (double a1, double b1) {
+              return a1 / b1;
+            });
+            break;
+
+          case OpCode::Modulo:
+            ApplyBinary(a, b, count, [] (double a1, double b1) {
+              return std::fmod(a1, b1);
+            });
+            break;
+
+          case OpCode::Power:
+            ApplyBinary(a, b, count, [] (double a1, double b1) {
+              return std::pow(a1, b1);
+            });
+            break;
+
+          case OpCode::Less:
+            ApplyBinary(a, b, count, [] (double a1, double b1) {
+              return a1 < b1 ? 1.0 : 0.0;
+            });
+            break;
+
+          case OpCode::LessEqual:
+            ApplyBinary(a, b, count, [] (double a1, double b1) {
+              return a1 <= b1 ? 1.0 : 0.0;
+            });
+            break;
+
+          case OpCode::Greater:
+            ApplyBinary(a, b, count, [] (double a1, double b1) {
+              return a1 > b1 ? 1.0 : 0.0;
+            });
+            break;
+
+          case OpCode::GreaterEqual:
+            ApplyBinary(a, b, count, [] (double a1, double b1) {
+              return a1 >= b1 ? 1.0 : 0.0;
+            });
+            break;
+
+          case OpCode::Equal:
+            ApplyBinary(a, b, count, [] (double a1, double b1) {
+              return a1 == b1 ? 1.0 : 0.0;
+            });
+            break;
+
+          case OpCode::NotEqual:
+            ApplyBinary(a, b, count, [] (double a1, double b1) {
+              return a1 != b1 ? 1.0 : 0.0;
+            });
+            break;
+
+          case OpCode::And:
+            ApplyBinary(a, b, count, [] (double a1, double b1) {
+              return a1 != 0.0 && b1 != 0.0 ? 1.0 : 0.0;
+            });
+            break;
+
+          case OpCode::Or:
+            ApplyBinary(a, b, count, [] (double a1, double b1) {
+              return a1 != 0.0 || b1 != 0.0 ? 1.0 : 0.0;
+            });
+            break;
+
+          case OpCode::BitAnd:
+            ApplyInteger(a, b, count, [] (int64_t a1, int64_t b1) {
+              return static_cast<double>(a1 & b1);
+            });
+            break;
+
+          case OpCode::BitOr:
+            ApplyInteger(a, b, count, [] (int64_t a1, int64_t b1) {
+              return static_cast<double>(a1 | b1);
+            });
+            break;
+
+          case OpCode::ShiftLeft:
+            ApplyInteger(a, b, count, [] (int64_t a1, int64_t b1) {
+              return b1 >= 0 && b1 < 64 ?
+                  static_cast<double>(static_cast<int64_t>(
+                      static_cast<uint64_t>(a1) << b1)) : kNaN;
+            });
+            break;
+
+          case OpCode::ShiftRight:
+            ApplyInteger(a, b, count, [] (int64_t a1, int64_t b1) {
+              return b1 >= 0 && b1 < 64 ?
+                  static_cast<double>(a1 >> b1) : kNaN;
+            });
+            break;
+
+          case OpCode::Function2:
+            ApplyBinary(a, b, count,
+                        kFunctionList[instruction.Argument].Function2);
+            break;
+
+          default:
+            break;
+        }
+        break;
+      }
+    }
+  }
+  std::copy_n(level(0), count, out);
+}
+
+}  // namespace mdf::detail
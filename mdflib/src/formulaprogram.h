@@ -0,0 +1,127 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+/** \file
+ * This file defines the compiled formula of an algebraic conversion.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mdf::detail {
+
+/** \brief Compiled formula of an algebraic conversion.
+ *
+ * The formula text is parsed once into a small stack based program. The
+ * program is evaluated on a column of values, one instruction at the time,
+ * so the instruction dispatch is done once per column instead of once per
+ * value.
+ *
+ * The formula uses the ASAM general expression syntax. The channel value is
+ * named X (or x, X1 and x1). The following is supported.
+ * - Decimal and hexadecimal (0x) numbers and the constant PI.
+ * - Arithmetic operators: + - * / % and ^ or ** (power).
+ * - Relational and logical operators: < <= > >= == != <> ! && ||.
+ * - Bit operators on integers: ~ & | << >>.
+ * - Functions: abs, sign, sqrt, exp, ln, log, log10, sin, cos, tan, asin,
+ * acos, atan, sinh, cosh, tanh, floor, ceil, round, trunc, pow, atan2, min,
+ * max and fmod.
+ *
+ * Relational and logical operators give 1.0 or 0.0. A result that is not a
+ * finite number is an invalid value.
+ */
+class FormulaProgram final {
+ public:
+  /** \brief Program instruction codes. */
+  enum class OpCode : uint8_t {
+    Variable, ///< Push the channel value.
+    Constant, ///< Push a constant. Argument is the constant index.
+    Negate, ///< -a
+    Not, ///< !a
+    BitNot, ///< ~a
+    Add, ///< a + b
+    Subtract, ///< a - b
+    Multiply, ///< a * b
+    Divide, ///< a / b
+    Modulo, ///< fmod(a, b)
+    Power, ///< pow(a, b)
+    Less, ///< a < b
+    LessEqual, ///< a <= b
+    Greater, ///< a > b
+    GreaterEqual, ///< a >= b
+    Equal, ///< a == b
+    NotEqual, ///< a != b
+    And, ///< a && b
+    Or, ///< a || b
+    BitAnd, ///< a & b
+    BitOr, ///< a | b
+    ShiftLeft, ///< a << b
+    ShiftRight, ///< a >> b
+    Function1, ///< f(a). Argument is the function index.
+    Function2 ///< f(a, b). Argument is the function index.
+  };
+
+  /** \brief Program instruction. */
+  struct Instruction {
+    OpCode Code = OpCode::Constant; ///< Instruction code.
+    uint16_t Argument = 0; ///< Constant or function index.
+  };
+
+  /** \brief Compiles a formula.
+   *
+   * @param formula Formula text.
+   * @return True if the formula is valid.
+   */
+  bool Compile(const std::string& formula);
+
+  /** \brief Returns true if a formula is successfully compiled. */
+  [[nodiscard]] bool IsCompiled() const { return !program_.empty(); }
+
+  /** \brief Returns the error text if the compile failed. */
+  [[nodiscard]] const std::string& Error() const { return error_; }
+
+  /** \brief Evaluates a single value.
+   *
+   * @param value Channel value.
+   * @param result Engineering value.
+   * @return True if the engineering value is valid.
+   */
+  bool Evaluate(double value, double& result) const;
+
+  /** \brief Evaluates a run of values.
+   *
+   * Gives exactly the same result as the single value function.
+   * @param in Channel values.
+   * @param out Engineering values.
+   * @param valid Valid flag (0/1) per value.
+   * @param count Number of values.
+   * @return True if all values are valid.
+   */
+  bool Evaluate(const double* in, double* out, uint8_t* valid,
+                size_t count) const;
+
+  /** \brief Max number of stack levels a program may use. */
+  static constexpr size_t kMaxStackDepth = 64;
+
+ private:
+  std::vector<Instruction> program_;
+  std::vector<double> constant_list_;
+  size_t stack_depth_ = 0; ///< Number of stack levels the program uses.
+  std::string error_;
+
+  /** \brief Runs the program on a column of values.
+   *
+   * @param in Channel values.
+   * @param out Engineering values.
+   * @param count Number of values.
+   * @param stack Stack memory with stack_depth_ * count values.
+   */
+  void Run(const double* in, double* out, size_t count, double* stack) const;
+};
+
+}  // namespace mdf::detail
@@ -29,8 +29,10 @@ T GetCommonProperty(const mdf::detail::Hd4Block& block,
   if (md4 == nullptr || md4->IsTxtBlock()) {
     return {};
   }
-  auto xml_file = mdf::CreateXmlFile("Expat");
-  xml_file->ParseString(md4->Text());
+  const auto* xml_file = md4->XmlFile();
+  if (xml_file == nullptr) {
+    return {};
+  }
   const auto* common = xml_file->GetNode("common_properties");
   if (common == nullptr) {
     return {};
@@ -69,15 +71,30 @@ void SetCommonProperty(mdf::detail::Hd4Block& block, const std::string& key,
 namespace mdf::detail {
 
 Hd4Block::Hd4Block() {
+  block_index_ = &file_index_;
+  string_pool_ = &file_strings_;
   block_type_ = "##HD";
   UtcTimestamp now(MdfHelper::NowNs());
   timestamp_.SetTime(now);
 }
 
+Hd4Block::~Hd4Block() {
+  // The comment block is owned by the base class, so it is deleted before
+  // the index.
+  md_comment_.reset();
+  block_index_ = nullptr;
+  string_pool_ = nullptr;
+}
+
 MdfBlock* Hd4Block::Find(int64_t index) const {
   if (index <= 0) {
     return nullptr;
   }
+  // Most blocks are in the index. The search below finds blocks that
+  // were added without an index, e.g. created before attached to the file.
+  if (auto* block = FindIndexed(index); block != nullptr) {
+    return block;
+  }
 
   for (auto& dg : dg_list_) {
     if (!dg) {
@@ -131,6 +148,22 @@ MdfBlock* Hd4Block::Find(int64_t index) const {
   return MdfBlock::Find(index);
 }
 
+bool Hd4Block::ReadLazyMetadata(
+    const std::function<void(std::streambuf&)>& read) const {
+  if (!lazy_reader_) {
+    return false;
+  }
+  std::lock_guard lock(lazy_mutex_);
+  return lazy_reader_(read);
+}
+
+void Hd4Block::ReadLazyMetadata(
+    std::streambuf& buffer,
+    const std::function<void(std::streambuf&)>& read) const {
+  std::lock_guard lock(lazy_mutex_);
+  read(buffer);
+}
+
 void Hd4Block::GetBlockProperty(BlockPropertyList& dest) const {
   MdfBlock::GetBlockProperty(dest);
 
@@ -4,11 +4,14 @@
  */
 #pragma once
 #include <cstdio>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "at4block.h"
+#include "blockindex.h"
 #include "ch4block.h"
 #include "dg4block.h"
 #include "ev4block.h"
@@ -40,6 +43,7 @@ class Hd4Block : public MdfBlock, public IHeader {
   using Ev4List = std::vector<std::unique_ptr<Ev4Block>>;
 
   Hd4Block();
+  ~Hd4Block() override;
 
   [[nodiscard]] int64_t Index() const override;
   [[nodiscard]] std::string BlockType() const override {
@@ -122,10 +126,47 @@ class Hd4Block : public MdfBlock, public IHeader {
       const override;
   IDataGroup *CreateDataGroup() override;
 
+  /** \brief Function that calls a read function with an open file. */
+  using LazyReader = std::function<bool(
+      const std::function<void(std::streambuf&)>& read)>;
+
+  /** \brief Defers the reading of the channel metadata.
+   *
+   * If a reader function is set before the blocks are read, the channel
+   * conversion (CC), source information (SI), unit and comment (MD) blocks
+   * of the channels are read on first access.
+   * @param reader Function that gives access to the file.
+   */
+  void LazyMetadata(LazyReader reader) { lazy_reader_ = std::move(reader); }
+  [[nodiscard]] bool IsLazyMetadata() const {
+    return static_cast<bool>(lazy_reader_);
+  }
+  /** \brief Calls a read function with the file.
+   *
+   * @param read Read function.
+   * @return False if the file couldn't be accessed.
+   */
+  bool ReadLazyMetadata(const std::function<void(std::streambuf&)>& read) const;
+  /** \brief Calls a read function with a caller owned stream buffer.
+   *
+   * Takes the same lock as above. The function is used when the caller
+   * already has the file open, for example when reading data.
+   * @param buffer Stream buffer of the file.
+   * @param read Read function.
+   */
+  void ReadLazyMetadata(std::streambuf& buffer,
+                        const std::function<void(std::streambuf&)>& read) const;
+
   bool FinalizeDtBlocks(std::streambuf& buffer) const;
   bool FinalizeCgAndVlsdBlocks(std::streambuf& buffer, bool update_cg, bool update_vlsd) const;
   bool UpdateVlsdBlocks(std::streambuf& buffer);
  private:
+  /** \brief File position index of all blocks below the header.
+   *
+   * Must be declared before the blocks, so it is deleted after them.
+   */
+  BlockIndex file_index_;
+  StringPool file_strings_; ///< Shared texts of all blocks below the header.
   Mdf4Timestamp timestamp_;
 
   uint8_t time_class_ = 0;
@@ -139,5 +180,8 @@ class Hd4Block : public MdfBlock, public IHeader {
   Ch4List ch_list_;
   At4List at_list_;
   Ev4List ev_list_;
+
+  LazyReader lazy_reader_;
+  mutable std::mutex lazy_mutex_; ///< Serialize the lazy reads.
 };
 }  // namespace mdf::detail
@@ -15,20 +15,37 @@
 
 namespace mdf {
 
+namespace {
+
+/** \brief Returns true if the value bits are inside the record.
+ *
+ * The check is done in bits, so there is no rounding per sample.
+ */
+inline bool InRange(size_t bit_offset, size_t bit_count, size_t nof_bytes) {
+  return bit_offset + bit_count <= nof_bytes * 8;
+}
+
+/** \brief Reports a range error. Kept out of line as it never happens in a
+ * valid file.
+ */
+void RangeError(size_t bit_offset, size_t bit_count, size_t nof_bytes,
+                const std::string& name) {
+  const size_t range_check = (bit_offset + bit_count + 7) / 8;
+  MDF_ERROR() << "Range check error. Byte Index: "
+    << range_check << "(" << nof_bytes << "). "
+    << "Channel: " << name;
+}
+
+}  // namespace
+
 bool IChannel::GetUnsignedValue(const std::vector<uint8_t> &record_buffer,
                                 uint64_t &dest,
                                 uint64_t array_index) const {
 
   const size_t bit_offset = (ByteOffset() * 8 + BitOffset())
     + static_cast<size_t>( (array_index * BitCount()) );
-  size_t range_check = (bit_offset + BitCount()) / 8;
-  if ((bit_offset + BitCount()) % 8 != 0) {
-    ++range_check;
-  }
-  if (range_check > record_buffer.size()) {
-    MDF_ERROR() << "Range check error. Byte Index: "
-      << range_check << "(" << record_buffer.size() << "). "
-      << "Channel: " << Name();
+  if (!InRange(bit_offset, BitCount(), record_buffer.size())) {
+    RangeError(bit_offset, BitCount(), record_buffer.size(), Name());
     return false;
   }
 
@@ -78,14 +95,8 @@ bool IChannel::GetSignedValue(const std::vector<uint8_t> &record_buffer,
   const size_t bit_offset = (ByteOffset() * 8 + BitOffset())
       + static_cast<size_t>( (array_index * BitCount()) );
 
-  size_t range_check = (bit_offset + BitCount()) / 8;
-  if ((bit_offset + BitCount()) % 8 != 0) {
-    ++range_check;
-  }
-  if (range_check > record_buffer.size()) {
-    MDF_ERROR() << "Range check error. Byte Index: "
-      << range_check << "(" << record_buffer.size() << "). "
-      << "Channel: " << Name();
+  if (!InRange(bit_offset, BitCount(), record_buffer.size())) {
+    RangeError(bit_offset, BitCount(), record_buffer.size(), Name());
     return false;
   }
 
@@ -103,14 +114,8 @@ bool IChannel::GetFloatValue(const std::vector<uint8_t> &record_buffer,
   const size_t bit_offset = (ByteOffset() * 8 + BitOffset())
         + static_cast<size_t>( (array_index * BitCount()) );
 
-  size_t range_check = (bit_offset + BitCount()) / 8;
-  if ((bit_offset + BitCount()) % 8 != 0) {
-    ++range_check;
-  }
-  if (range_check > record_buffer.size()) {
-    MDF_ERROR() << "Range check error. Byte Index: "
-      << range_check << "(" << record_buffer.size() << "). "
-      << "Channel: " << Name();
+  if (!InRange(bit_offset, BitCount(), record_buffer.size())) {
+    RangeError(bit_offset, BitCount(), record_buffer.size(), Name());
     return false;
   }
 
@@ -1073,7 +1078,7 @@ void IChannel::SetTimestamp(double timestamp,
 IChannel *IChannel::CreateChannelComposition(const std::string_view &name) {
   auto list = ChannelCompositions();
   auto itr = std::find_if(list.begin(), list.end(), [&] (auto* channel) {
-    return channel != nullptr && channel->Name() == name;
+    return channel != nullptr && channel->NameView() == name;
   });
   if (itr != list.end()) {
     return *itr;
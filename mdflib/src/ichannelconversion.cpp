@@ -5,9 +5,17 @@
 
 #include "mdf/ichannelconversion.h"
 
+#include <algorithm>
 #include <cmath>
 
+#include "conversiontable.h"
+#include "convertkernel.h"
+#include "mdf/mdflogstream.h"
+
 namespace mdf {
+
+IChannelConversion::~IChannelConversion() = default;
+
 IChannelConversion *IChannelConversion::CreateInverse() { return nullptr; }
 
 IChannelConversion *IChannelConversion::Inverse() const {
@@ -26,6 +34,7 @@ std::optional<std::pair<double, double>> IChannelConversion::Range() const {
 
 void IChannelConversion::ChannelDataType(uint8_t channel_data_type) {
   channel_data_type_ = channel_data_type;
+  ResetLookupTable();
 }
 
 void IChannelConversion::CopyFrom(const IChannelConversion &source) {
@@ -35,6 +44,7 @@ void IChannelConversion::CopyFrom(const IChannelConversion &source) {
   formula_ = source.formula_;
   text_conversion_list_ = source.text_conversion_list_;
   text_range_conversion_list_ = source.text_range_conversion_list_;
+  ResetLookupTable();
 }
 
 bool IChannelConversion::IsChannelInteger() const {
@@ -64,9 +74,12 @@ bool IChannelConversion::ConvertRational(double channel_value,
     return false;
   }
 
-  eng_value = (Parameter(0) * std::pow(channel_value, 2)) +
+  // Note that x * x is correctly rounded while std::pow(x, 2) may differ in
+  // the last bit. It also gives the same result as the batch conversion.
+  const double square = channel_value * channel_value;
+  eng_value = (Parameter(0) * square) +
               (Parameter(1) * channel_value) + Parameter(2);
-  const double div = (Parameter(3) * std::pow(channel_value, 2)) +
+  const double div = (Parameter(3) * square) +
                      (Parameter(4) * channel_value) + Parameter(5);
   if (div == 0.0) {
     return false;
@@ -171,11 +184,95 @@ bool IChannelConversion::ConvertExponential(double channel_value,
   }
   return true;
 }
+bool IChannelConversion::IsBatchConversion() const {
+  switch (Type()) {
+    case ConversionType::Linear:
+    case ConversionType::Rational:
+    case ConversionType::Polynomial:
+    case ConversionType::Logarithmic:
+    case ConversionType::Exponential:
+    case ConversionType::Algebraic:
+      return true;
+
+    default:
+      break;
+  }
+  return false;
+}
+
+bool IChannelConversion::ConvertDoubles(const double *in, double *out,
+                                        uint8_t *valid, size_t count) const {
+  if (Type() == ConversionType::Algebraic) {
+    return LookupTable().Formula().Evaluate(in, out, valid, count);
+  }
+
+  // Resolve the parameters once. Missing parameters give invalid values
+  // in the same way as the single value conversions.
+  constexpr size_t kMaxParameters = 7;
+  size_t nof_parameters = 0;
+  switch (Type()) {
+    case ConversionType::Linear:
+      nof_parameters = 2;
+      break;
+
+    case ConversionType::Rational:
+    case ConversionType::Polynomial:
+      nof_parameters = 6;
+      break;
+
+    case ConversionType::Logarithmic:
+    case ConversionType::Exponential:
+      nof_parameters = kMaxParameters;
+      break;
+
+    default:
+      break;
+  }
+  if (nof_parameters == 0 || value_list_.empty() ||
+      (Type() != ConversionType::Linear &&
+       value_list_.size() < nof_parameters)) {
+    std::fill_n(out, count, 0.0);
+    std::fill_n(valid, count, static_cast<uint8_t>(0));
+    return count == 0;
+  }
+  double par[kMaxParameters] = {};
+  for (size_t index = 0; index < nof_parameters; ++index) {
+    par[index] = Parameter(static_cast<uint16_t>(index));
+  }
+
+  const auto& kernels = detail::SelectConvertKernels();
+  switch (Type()) {
+    case ConversionType::Linear:
+      if (value_list_.size() == 1) {
+        std::fill_n(out, count, par[0]);  // Constant value
+      } else {
+        kernels.Linear(in, out, count, par);
+      }
+      std::fill_n(valid, count, static_cast<uint8_t>(1));
+      return true;
+
+    case ConversionType::Rational:
+      return kernels.Rational(in, out, valid, count, par);
+
+    case ConversionType::Polynomial:
+      return kernels.Polynomial(in, out, valid, count, par);
+
+    case ConversionType::Logarithmic:
+      return detail::ConvertLogarithmicBatch(in, out, valid, count, par);
+
+    case ConversionType::Exponential:
+      return detail::ConvertExponentialBatch(in, out, valid, count, par);
+
+    default:
+      break;
+  }
+  return false;
+}
+
 bool IChannelConversion::ConvertAlgebraic(double channel_value,
                                           double &eng_value) const {
-  // Todo (ihedvall): This requires a flex and bison formula calculator.
-  // Currently not supported.
-  return false;
+  // The formula is compiled once into a program.
+  return LookupTable().Formula().Evaluate(channel_value, eng_value);
 }
 
 bool IChannelConversion::ConvertValueToValueInterpolate(
@@ -184,37 +281,29 @@ bool IChannelConversion::ConvertValueToValueInterpolate(
     return false;
   }
 
-  for (uint16_t n = 0; n < nof_values_; ++n) {
-    const uint32_t key_index = n * 2;
-    const uint32_t value_index = key_index + 1;
-    if (value_index >= value_list_.size()) {
-      break;
-    }
-    const auto key = Parameter(key_index);
-    const auto value = Parameter(value_index);
-    if (channel_value == key) {
-      eng_value = value;
-      return true;
-    }
-    if (channel_value < key) {
-      if (n == 0) {
-        eng_value = value;
-        return true;
-      }
-      const auto prev_key = Parameter(key_index - 2);
-      const auto prev_value = Parameter(value_index - 2);
-      const double key_range = key - prev_key;
-      const double value_range = value - prev_value;
+  // Find the first key that is equal or larger than the channel value.
+  const auto& table = LookupTable();
+  const size_t n = table.FindNotLess(channel_value);
+  if (n == detail::ConversionTable::kNotFound) {
+    eng_value = std::get<double>(value_list_.back());
+    return true;
+  }
+  const double key = table.Key(n);
+  const double value = table.Value(n);
+  if (channel_value == key || n == 0) {
+    eng_value = value;
+    return true;
+  }
+  const double prev_key = table.Key(n - 1);
+  const double prev_value = table.Value(n - 1);
+  const double key_range = key - prev_key;
+  const double value_range = value - prev_value;
 
-      if (key_range == 0.0) {
-        return false;
-      }
-      const double x = (channel_value - prev_key) / key_range;
-      eng_value = prev_value + (x * value_range);
-      return true;
-    }
+  if (key_range == 0.0) {
+    return false;
   }
-  eng_value = std::get<double>(value_list_.back());
+  const double x = (channel_value - prev_key) / key_range;
+  eng_value = prev_value + (x * value_range);
   return true;
 }
 
@@ -224,37 +313,28 @@ bool IChannelConversion::ConvertValueToValue(double channel_value,
     return false;
   }
 
-  for (uint16_t n = 0; n < nof_values_; ++n) {
-    const uint32_t key_index = n * 2;
-    const uint32_t value_index = key_index + 1;
-    if (value_index >= value_list_.size()) {
-      break;
-    }
-    const double key = Parameter(key_index);
-    const double value = Parameter(value_index);
-    if (channel_value == key) {
-      eng_value = value;
-      return true;
-    }
-
-    if (channel_value < key) {
-      if (n == 0) {
-        eng_value = value;
-        return true;
-      }
+  // Find the first key that is equal or larger than the channel value.
+  const auto& table = LookupTable();
+  const size_t n = table.FindNotLess(channel_value);
+  if (n == detail::ConversionTable::kNotFound) {
+    eng_value = std::get<double>(value_list_.back());
+    return true;
+  }
+  const double key = table.Key(n);
+  const double value = table.Value(n);
+  if (channel_value == key || n == 0) {
+    eng_value = value;
+    return true;
+  }
 
-      const double prev_key = Parameter(key_index - 2);
-      const double prev_value = Parameter(value_index - 2);
-      const double key_range = key - prev_key;
-      if (key_range == 0.0) {
-        return false;
-      }
-      const double x = (channel_value - prev_key) / key_range;
-      eng_value = x <= 0.5 ? prev_value : value;
-      return true;
-    }
+  const double prev_key = table.Key(n - 1);
+  const double prev_value = table.Value(n - 1);
+  const double key_range = key - prev_key;
+  if (key_range == 0.0) {
+    return false;
   }
-  eng_value = std::get<double>(value_list_.back());
+  const double x = (channel_value - prev_key) / key_range;
+  eng_value = x <= 0.5 ? prev_value : value;
   return true;
 }
 
@@ -264,27 +344,11 @@ bool IChannelConversion::ConvertValueRangeToValue(double channel_value,
     return false;
   }
 
-  for (uint16_t n = 0; n < nof_values_; ++n) {
-    const uint32_t key_min_index = n * 3;
-    const uint32_t key_max_index = key_min_index + 1;
-    const uint32_t value_index = key_min_index + 2;
-    if (value_index >= value_list_.size()) {
-      break;
-    }
-    const double key_min = Parameter(key_min_index);
-    const double key_max = Parameter(key_max_index);
-    const double value = Parameter(value_index);
-    if (IsChannelInteger() && channel_value >= key_min &&
-        channel_value <= key_max) {
-      eng_value = value;
-      return true;
-    }
-
-    if (IsChannelFloat() && channel_value >= key_min &&
-        channel_value < key_max) {
-      eng_value = value;
-      return true;
-    }
+  const auto& table = LookupTable();
+  const size_t n = table.FindRange(channel_value);
+  if (n != detail::ConversionTable::kNotFound) {
+    eng_value = table.Value(n);
+    return true;
   }
   eng_value = std::get<double>(value_list_.back());
   return true;
@@ -310,6 +374,141 @@ bool IChannelConversion::ConvertTextToTranslation(
   return false;
 }
 
+const detail::ConversionTable& IChannelConversion::LookupTable() const {
+  if (!lookup_table_created_.load(std::memory_order_acquire)) {
+    std::lock_guard lock(lookup_table_mutex_);
+    if (!lookup_table_) {
+      auto table = std::make_unique<detail::ConversionTable>();
+      CreateLookupTable(*table);
+      lookup_table_ = std::move(table);
+    }
+    lookup_table_created_.store(true, std::memory_order_release);
+  }
+  return *lookup_table_;
+}
+
+void IChannelConversion::CreateLookupTable(
+    detail::ConversionTable &table) const {
+  // Note that the number of values limits the number of keys. The values
+  // are stored as key-value pairs or min-max-value triplets.
+  std::vector<double> key_list;
+  std::vector<double> max_list;
+  std::vector<double> eng_list;
+  switch (Type()) {
+    case ConversionType::ValueToValueInterpolation:
+    case ConversionType::ValueToValue: {
+      const size_t nof_keys = std::min(static_cast<size_t>(nof_values_),
+                                       value_list_.size() / 2);
+      for (size_t n = 0; n < nof_keys; ++n) {
+        key_list.push_back(Parameter(static_cast<uint16_t>(n * 2)));
+        eng_list.push_back(Parameter(static_cast<uint16_t>((n * 2) + 1)));
+      }
+      table.CreateKeys(std::move(key_list), std::move(eng_list));
+      break;
+    }
+
+    case ConversionType::ValueRangeToValue: {
+      const size_t nof_keys = std::min(static_cast<size_t>(nof_values_),
+                                       value_list_.size() / 3);
+      for (size_t n = 0; n < nof_keys; ++n) {
+        key_list.push_back(Parameter(static_cast<uint16_t>(n * 3)));
+        max_list.push_back(Parameter(static_cast<uint16_t>((n * 3) + 1)));
+        eng_list.push_back(Parameter(static_cast<uint16_t>((n * 3) + 2)));
+      }
+      table.CreateRanges(std::move(key_list), std::move(max_list),
+                         std::move(eng_list),
+                         detail::ConversionTable::GetRangeType(
+                             IsChannelInteger(), IsChannelFloat()));
+      break;
+    }
+
+    case ConversionType::Algebraic:
+      if (!table.Formula().Compile(Formula())) {
+        MDF_ERROR() << "Invalid formula. Formula: " << Formula()
+                    << ", Error: " << table.Formula().Error();
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+void IChannelConversion::ResetLookupTable() {
+  {
+    std::lock_guard lock(lookup_table_mutex_);
+    lookup_table_created_.store(false, std::memory_order_release);
+    lookup_table_.reset();
+  }
+  std::lock_guard lock(eng_value_table_mutex_);
+  eng_value_table_created_.store(false, std::memory_order_release);
+  eng_value_table_.reset();
+}
+
+IChannelConversion::EngValueTable::EngValueTable(
+    const IChannelConversion &conversion, uint32_t bit_count,
+    bool signed_value)
+    : conversion_(conversion),
+      bit_count_(bit_count),
+      signed_(signed_value) {
+  const size_t size = size_t{1} << bit_count_;
+  min_value_ = signed_ ? -(int64_t{1} << (bit_count_ - 1)) : 0;
+  valid_list_.resize(size, 0);
+
+  const bool text = conversion_.Type() == ConversionType::ValueToText ||
+                    conversion_.Type() == ConversionType::ValueRangeToText;
+  if (text) {
+    text_list_.resize(size);
+  } else {
+    value_list_.resize(size, 0.0);
+  }
+  for (size_t index = 0; index < size; ++index) {
+    const int64_t channel_value = min_value_ + static_cast<int64_t>(index);
+    const bool valid = text ?
+        conversion_.Convert(channel_value, text_list_[index]) :
+        conversion_.Convert(channel_value, value_list_[index]);
+    valid_list_[index] = valid ? 1 : 0;
+  }
+}
+
+const IChannelConversion::EngValueTable *IChannelConversion::GetEngValueTable(
+    uint32_t bit_count, bool signed_value, uint64_t nof_values) const {
+  if (bit_count == 0 || bit_count > kMaxEngValueTableBits ||
+      nof_values < (uint64_t{1} << bit_count)) {
+    return nullptr;
+  }
+  switch (Type()) {
+    case ConversionType::Rational:
+    case ConversionType::Algebraic:
+    case ConversionType::ValueToValueInterpolation:
+    case ConversionType::ValueToValue:
+    case ConversionType::ValueRangeToValue:
+    case ConversionType::ValueToText:
+    case ConversionType::ValueRangeToText:
+    case ConversionType::Polynomial:
+    case ConversionType::Exponential:
+    case ConversionType::Logarithmic:
+      break;
+
+    default:
+      return nullptr; // Cheap or not a value conversion.
+  }
+
+  if (!eng_value_table_created_.load(std::memory_order_acquire)) {
+    std::lock_guard lock(eng_value_table_mutex_);
+    if (!eng_value_table_) {
+      eng_value_table_ = std::make_unique<EngValueTable>(*this, bit_count,
+                                                         signed_value);
+    }
+    eng_value_table_created_.store(true, std::memory_order_release);
+  }
+
+  // The table is created for the channel that owns the conversion.
+  const auto* table = eng_value_table_.get();
+  return table->BitCount() == bit_count && table->IsSigned() == signed_value ?
+         table : nullptr;
+}
+
 uint16_t IChannelConversion::NofParameters() const {
   return nof_values_;
 } 
@@ -319,6 +518,7 @@ void IChannelConversion::Parameter(uint16_t index, double parameter) {
     value_list_.emplace_back(0.0);
   }
   value_list_[index] = parameter;
+  ResetLookupTable();
 }
 
 double IChannelConversion::Parameter(uint16_t index) const {
@@ -376,6 +576,7 @@ IMetaData *IChannelConversion::MetaData() const { return nullptr; }
 
 void IChannelConversion::Formula(const std::string &formula) {
   formula_ = formula;
+  ResetLookupTable();
 }
 
 const std::string &IChannelConversion::Formula() const {
@@ -64,8 +64,8 @@ IChannel *IChannelGroup::GetChannel(const std::string_view &name) const {
                     if (!channel) {
                       return false;
                     }
-                    const auto pos = channel->Name().find(name);
-                    return pos != std::string::npos;
+                    const auto pos = channel->NameView().find(name);
+                    return pos != std::string_view::npos;
                   });
   return itr != cn_list.end() ? *itr : nullptr;
 }
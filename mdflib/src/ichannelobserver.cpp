@@ -71,6 +71,35 @@ uint64_t IChannelObserver::ArraySize() const {
   return channel_.ArraySize();
 }
 
+const IChannelConversion::EngValueTable* IChannelObserver::GetEngValueTable(
+    const IChannelConversion& conversion) const {
+  bool signed_value = false;
+  switch (channel_.DataType()) {
+    case ChannelDataType::UnsignedIntegerLe:
+    case ChannelDataType::UnsignedIntegerBe:
+      break;
+
+    case ChannelDataType::SignedIntegerLe:
+    case ChannelDataType::SignedIntegerBe:
+      signed_value = true;
+      break;
+
+    default:
+      return nullptr;
+  }
+  return conversion.GetEngValueTable(channel_.BitCount(), signed_value,
+                                     NofSamples());
+}
+
+std::pair<const void*, size_t> IChannelObserver::SampleBuffer(
+    const std::type_info&) const {
+  return {nullptr, 0};
+}
+
+bool IChannelObserver::GetSampleValidList(std::vector<bool>&) const {
+  return false;
+}
+
 std::string IChannelObserver::EngValueToString(uint64_t sample) const {
   bool valid = false;
   std::string value;
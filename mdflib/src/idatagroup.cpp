@@ -11,6 +11,23 @@
 #include "mdf/ichannelobserver.h"
 
 
+namespace {
+
+/** \brief Record buffer used by the record view adapter.
+ *
+ * Each thread that parses records has its own buffer, so data groups
+ * may be read in parallel.
+ */
+struct RecordCopy {
+  uint64_t notification = 0; ///< Incremented for each new record.
+  uint64_t copied = 0; ///< Notification that the buffer holds.
+  std::vector<uint8_t> buffer;
+};
+
+thread_local RecordCopy kRecordCopy;
+
+}  // namespace
+
 namespace mdf {
 
 void IDataGroup::AttachSampleObserver(ISampleObserver *observer) const {
@@ -75,6 +92,54 @@ bool IDataGroup::NotifySampleObservers(uint64_t sample, uint64_t record_id,
   return true;
 }
 
+bool IDataGroup::NotifySampleObservers(uint64_t sample, uint64_t record_id,
+    Span<const uint8_t> record) const {
+  if (fast_observer_list_.empty()) {
+    return false; // No meaning to continue reading
+  }
+  // New record. Any vector observer needs a new copy.
+  ++kRecordCopy.notification;
+
+  if ( fast_observer_list_.size() == 1) {
+    for (ISampleObserver* observer : observer_list_) {
+      if (observer == nullptr) {
+        continue;
+      }
+      const bool continue_reading = observer->OnSample(sample, record_id, record);
+      if (!continue_reading) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  auto itr = fast_observer_list_.find(record_id);
+  if (itr == fast_observer_list_.end()) {
+    return true;
+  }
+  auto& observer_list = itr->second;
+  for (ISampleObserver* observer : observer_list ) {
+    if (observer != nullptr) {
+      const bool continue_reading = observer->OnSample(sample, record_id, record);
+      if (!continue_reading) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+const std::vector<uint8_t>& IDataGroup::RecordBuffer(
+    Span<const uint8_t> record) const {
+  if (kRecordCopy.copied != kRecordCopy.notification) {
+    // Note that the assign doesn't allocate memory if the capacity is enough.
+    kRecordCopy.buffer.assign(record.begin(), record.end());
+    kRecordCopy.copied = kRecordCopy.notification;
+  }
+  return kRecordCopy.buffer;
+}
+
 void IDataGroup::ClearData() {
   auto list = ChannelGroups();
   std::for_each(list.begin(),list.end(),
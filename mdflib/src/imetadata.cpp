@@ -7,9 +7,26 @@
 #include "mdf/mdflogstream.h"
 
 #include "ixmlfile.h"
+#include "md4block.h"
 
 namespace {
 
+/** Returns the parsed XML snippet. The MD blocks keeps the parsed XML while
+ * other meta data objects are parsed into the temporary XML object.
+ */
+const mdf::IXmlFile* GetXmlFile(const mdf::IMetaData& meta_data,
+                                std::unique_ptr<mdf::IXmlFile>& temp) {
+  if (const auto* md4 = dynamic_cast<const mdf::detail::Md4Block*>(&meta_data);
+      md4 != nullptr) {
+    return md4->XmlFile();
+  }
+  temp = mdf::CreateXmlFile();
+  if (!temp || !temp->ParseString(meta_data.XmlSnippet())) {
+    return nullptr;
+  }
+  return temp.get();
+}
+
 void InsertETag(const mdf::ETag& e_tag, mdf::IXmlNode& root) {  // NOLINT
   // First check if this is a tree. If so we create a new node and
   const auto& tree_list = e_tag.TreeList();
@@ -103,12 +120,9 @@ void IMetaData::StringProperty(const std::string& tag,
 }
 
 std::string IMetaData::StringProperty(const std::string& tag) const {
-  auto xml = CreateXmlFile();
-  if (!xml) {
-    return {};
-  }
-
-  if (const bool parse = xml->ParseString(XmlSnippet()); !parse) {
+  std::unique_ptr<IXmlFile> temp;
+  const auto* xml = GetXmlFile(*this, temp);
+  if (xml == nullptr) {
     MDF_ERROR() << "Failed to parse XML string. XML: " << XmlSnippet()
       << ", Block Type: " << BlockType();
     return {};
@@ -126,10 +140,9 @@ void IMetaData::FloatProperty(const std::string& tag, double value) {
 }
 
 double IMetaData::FloatProperty(const std::string& tag) const {
-  auto xml = CreateXmlFile();
-  xml->ParseString(XmlSnippet());
-  auto value = xml->Property<double>(tag);
-  return value;
+  std::unique_ptr<IXmlFile> temp;
+  const auto* xml = GetXmlFile(*this, temp);
+  return xml != nullptr ? xml->Property<double>(tag) : 0.0;
 }
 
 void IMetaData::CommonProperty(const ETag& e_tag) {
@@ -143,9 +156,10 @@ void IMetaData::CommonProperty(const ETag& e_tag) {
 }
 
 ETag IMetaData::CommonProperty(const std::string& name) const {
-  auto xml = CreateXmlFile();
-  xml->ParseString(XmlSnippet());
-  const auto* common = xml->GetNode("common_properties");
+  std::unique_ptr<IXmlFile> temp;
+  const auto* xml = GetXmlFile(*this, temp);
+  const auto* common = xml != nullptr ?
+      xml->GetNode("common_properties") : nullptr;
   ETag tag;
   if (common != nullptr) {
     const auto* tree_tag = common->GetNode("tree", "name", name);
@@ -173,8 +187,11 @@ void IMetaData::CommonProperties(const std::vector<ETag>& tag_list) {
 
 std::vector<ETag> IMetaData::Properties() const {
   std::vector<ETag> tag_list;
-  auto xml = CreateXmlFile();
-  xml->ParseString(XmlSnippet());
+  std::unique_ptr<IXmlFile> temp;
+  const auto* xml = GetXmlFile(*this, temp);
+  if (xml == nullptr) {
+    return tag_list;
+  }
   IXmlNode::ChildList list;
   xml->GetChildList(list);
   for (const auto* child : list) {
@@ -194,9 +211,10 @@ std::vector<ETag> IMetaData::Properties() const {
 
 std::vector<ETag> IMetaData::CommonProperties() const {
   std::vector<ETag> tag_list;
-  auto xml = CreateXmlFile();
-  xml->ParseString(XmlSnippet());
-  const auto* common = xml->GetNode("common_properties");
+  std::unique_ptr<IXmlFile> temp;
+  const auto* xml = GetXmlFile(*this, temp);
+  const auto* common = xml != nullptr ?
+      xml->GetNode("common_properties") : nullptr;
   if (common != nullptr) {
     IXmlNode::ChildList list;
     common->GetChildList(list);
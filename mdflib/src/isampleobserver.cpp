@@ -48,6 +48,29 @@ bool ISampleObserver::OnSample(uint64_t sample, uint64_t record_id,
   return continue_reading;
 }
 
+bool ISampleObserver::OnSample(uint64_t sample, uint64_t record_id,
+                               Span<const uint8_t> record) {
+  if (data_group_ == nullptr) {
+    return true;
+  }
+  return OnSample(sample, record_id, data_group_->RecordBuffer(record));
+}
+
+bool ISampleObserver::OnSampleBlock(uint64_t first_sample, uint64_t record_id,
+                                    Span<const uint8_t> records,
+                                    size_t record_size) {
+  if (record_size == 0) {
+    return true;
+  }
+  const size_t nof_records = records.size() / record_size;
+  for (size_t index = 0; index < nof_records; ++index) {
+    const auto view = records.subspan(index * record_size, record_size);
+    if (!OnSample(first_sample + index, record_id, view)) {
+      return false;
+    }
+  }
+  return true;
+}
 
 void ISampleObserver::FindVlsdRecord(const IChannelGroup& channel_group) {
   const auto channel_list = channel_group.Channels();
@@ -18,6 +18,7 @@ class LittleBuffer {
   LittleBuffer() = default;
   explicit LittleBuffer(const T& value);
   LittleBuffer(const std::vector<uint8_t>& buffer, size_t offset);
+  explicit LittleBuffer(const uint8_t* buffer);
 
 
   [[nodiscard]] auto cbegin() const {
@@ -60,6 +61,11 @@ LittleBuffer<T>::LittleBuffer(const std::vector<uint8_t>& buffer,
     memcpy(buffer_.data(), buffer.data() + offset, sizeof(T));
 }
 
+template <typename T>
+LittleBuffer<T>::LittleBuffer(const uint8_t* buffer) {
+    memcpy(buffer_.data(), buffer, sizeof(T));
+}
+
 template <typename T>
 const uint8_t* LittleBuffer<T>::data() const {
   return buffer_.data();
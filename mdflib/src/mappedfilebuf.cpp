@@ -0,0 +1,185 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "mappedfilebuf.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#if (_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "platform.h"
+
+#if INCLUDE_STD_FILESYSTEM_EXPERIMENTAL
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#else
+#include <filesystem>
+namespace fs = std::filesystem;
+#endif
+
+namespace mdf::detail {
+
+MappedFileBuf::~MappedFileBuf() {
+  Close();
+}
+
+bool MappedFileBuf::Open(const std::wstring& filename) {
+  Close();
+  if (filename.empty()) {
+    return false;
+  }
+#if (_WIN32)
+  HANDLE file = CreateFileW(filename.c_str(), GENERIC_READ,
+                            FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0 ||
+      static_cast<uint64_t>(file_size.QuadPart) >
+          std::numeric_limits<size_t>::max()) {
+    CloseHandle(file);
+    return false;
+  }
+  HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0,
+                                      nullptr);
+  if (mapping == nullptr) {
+    CloseHandle(file);
+    return false;
+  }
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (view == nullptr) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+  file_handle_ = file;
+  map_handle_ = mapping;
+  data_ = static_cast<uint8_t*>(view);
+  size_ = static_cast<uint64_t>(file_size.QuadPart);
+#else
+  const fs::path fname(filename);
+  const int file = open(fname.c_str(), O_RDONLY);
+  if (file < 0) {
+    return false;
+  }
+  struct stat file_info {};
+  if (fstat(file, &file_info) != 0 || file_info.st_size <= 0 ||
+      static_cast<uint64_t>(file_info.st_size) >
+          std::numeric_limits<size_t>::max()) {
+    close(file);
+    return false;
+  }
+  const auto file_size = static_cast<size_t>(file_info.st_size);
+  void* view = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, file, 0);
+  // The mapping holds its own reference to the file.
+  close(file);
+  if (view == MAP_FAILED) {
+    return false;
+  }
+  // Records are mostly read from the beginning to the end.
+  madvise(view, file_size, MADV_SEQUENTIAL);
+  data_ = static_cast<uint8_t*>(view);
+  size_ = file_size;
+#endif
+  auto* begin = reinterpret_cast<char_type*>(data_);
+  setg(begin, begin, begin + size_);
+  return true;
+}
+
+void MappedFileBuf::Close() {
+  setg(nullptr, nullptr, nullptr);
+  if (data_ == nullptr) {
+    return;
+  }
+#if (_WIN32)
+  UnmapViewOfFile(data_);
+  if (map_handle_ != nullptr) {
+    CloseHandle(map_handle_);
+  }
+  if (file_handle_ != nullptr) {
+    CloseHandle(file_handle_);
+  }
+  map_handle_ = nullptr;
+  file_handle_ = nullptr;
+#else
+  munmap(data_, static_cast<size_t>(size_));
+#endif
+  data_ = nullptr;
+  size_ = 0;
+}
+
+const uint8_t* MappedFileBuf::Data(int64_t position,
+                                   uint64_t nof_bytes) const {
+  if (data_ == nullptr || position < 0 ||
+      static_cast<uint64_t>(position) > size_ ||
+      nof_bytes > size_ - static_cast<uint64_t>(position)) {
+    return nullptr;
+  }
+  return data_ + position;
+}
+
+MappedFileBuf::pos_type MappedFileBuf::seekoff(off_type offset,
+                                               std::ios_base::seekdir direction,
+                                               std::ios_base::openmode mode) {
+  if (data_ == nullptr || (mode & std::ios_base::in) == 0) {
+    return {off_type(-1)};
+  }
+  off_type position = offset;
+  switch (direction) {
+    case std::ios_base::cur:
+      position += static_cast<off_type>(gptr() - eback());
+      break;
+
+    case std::ios_base::end:
+      position += static_cast<off_type>(size_);
+      break;
+
+    default:
+      break;
+  }
+  if (position < 0 || static_cast<uint64_t>(position) > size_) {
+    return {off_type(-1)};
+  }
+  setg(eback(), eback() + position, egptr());
+  return {position};
+}
+
+MappedFileBuf::pos_type MappedFileBuf::seekpos(pos_type position,
+                                               std::ios_base::openmode mode) {
+  return seekoff(off_type(position), std::ios_base::beg, mode);
+}
+
+std::streamsize MappedFileBuf::showmanyc() {
+  const auto available = egptr() - gptr();
+  return available > 0 ? available : -1;
+}
+
+std::streamsize MappedFileBuf::xsgetn(char_type* dest,
+                                      std::streamsize count) {
+  const auto nof_bytes = std::min(count,
+                         static_cast<std::streamsize>(egptr() - gptr()));
+  if (nof_bytes <= 0) {
+    return 0;
+  }
+  std::memcpy(dest, gptr(), static_cast<size_t>(nof_bytes));
+  setg(eback(), gptr() + nof_bytes, egptr());
+  return nof_bytes;
+}
+
+}  // namespace mdf::detail
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <streambuf>
+#include <string>
+
+namespace mdf::detail {
+
+/** \brief Read-only stream buffer that memory maps a file.
+ *
+ * The buffer maps the entire file into the address space and exposes the
+ * mapping as the get area of the stream buffer. All the normal block readers
+ * work unchanged through the std::streambuf interface but without any
+ * read system call or intermediate copy. The read cache uses the Data()
+ * function to parse records directly out of the mapping.
+ *
+ * The mapping fails on empty files or when the file doesn't fit in the
+ * address space (32-bit builds). The caller should then fall back to an
+ * ordinary std::filebuf.
+ */
+class MappedFileBuf : public std::streambuf {
+ public:
+  MappedFileBuf() = default;
+  ~MappedFileBuf() override;
+
+  MappedFileBuf(const MappedFileBuf&) = delete;
+  MappedFileBuf& operator=(const MappedFileBuf&) = delete;
+
+  bool Open(const std::wstring& filename);
+  [[nodiscard]] bool IsOpen() const { return data_ != nullptr; }
+  void Close();
+
+  /** \brief Returns the mapped file size. */
+  [[nodiscard]] uint64_t Size() const { return size_; }
+
+  /** \brief Returns a pointer into the mapping.
+   *
+   * @param position File position.
+   * @param nof_bytes Number of bytes that must be available.
+   * @return Pointer to the file position or null if outside the mapping.
+   */
+  [[nodiscard]] const uint8_t* Data(int64_t position,
+                                    uint64_t nof_bytes) const;
+
+ protected:
+  pos_type seekoff(off_type offset, std::ios_base::seekdir direction,
+                   std::ios_base::openmode mode) override;
+  pos_type seekpos(pos_type position, std::ios_base::openmode mode) override;
+  std::streamsize showmanyc() override;
+  std::streamsize xsgetn(char_type* dest, std::streamsize count) override;
+
+ private:
+  uint8_t* data_ = nullptr;
+  uint64_t size_ = 0;
+#if (_WIN32)
+  void* file_handle_ = nullptr;
+  void* map_handle_ = nullptr;
+#endif
+};
+
+}  // namespace mdf::detail
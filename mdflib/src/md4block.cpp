@@ -273,6 +273,18 @@ Md4Block::Md4Block(const std::string &text) {
   text_ = text;
 }
 
+Md4Block::~Md4Block() = default;
+
+uint64_t Md4Block::Read(std::streambuf &buffer) {
+  ResetXmlFile();
+  return Tx4Block::Read(buffer);
+}
+
+void Md4Block::Text(const std::string &text) {
+  ResetXmlFile();
+  Tx4Block::Text(text);
+}
+
 void Md4Block::TxComment(const std::string &tx_comment) {
   block_type_ = "##MD";
   auto xml = CreateXmlFile();
@@ -289,17 +301,13 @@ std::string Md4Block::TxComment() const {
     // Not an XML string. Assume mistake of TX block instead of MD block.
     return text_;
   }
-  auto xml = CreateXmlFile();
-  if (!xml) {
-    return {};
-  }
-  if (bool parse = xml->ParseString(text_); !parse) {
+  const auto* xml = XmlFile();
+  if (xml == nullptr) {
     MDF_ERROR() << "Parse of XML snippet failed. XML: " << text_
       << ", Block Type: " << BlockType();
     return text_;
-  };
+  }
   return xml->Property<std::string>("TX");
-
 }
 
 void Md4Block::GetBlockProperty(BlockPropertyList &dest) const {
@@ -308,9 +316,8 @@ void Md4Block::GetBlockProperty(BlockPropertyList &dest) const {
     return Tx4Block::GetBlockProperty(dest);
   }
   // Parse out the XML data
-  auto xml = CreateXmlFile();
-  const bool parse = xml->ParseString(Text());
-  if (!parse) {
+  const auto* xml = XmlFile();
+  if (xml == nullptr) {
     return Tx4Block::GetBlockProperty(dest);
   }
 
@@ -475,8 +482,29 @@ void Md4Block::GetBlockProperty(BlockPropertyList &dest) const {
   }
 }
 
-void Md4Block::XmlSnippet(const std::string &text) { text_ = text; }
+void Md4Block::XmlSnippet(const std::string &text) {
+  ResetXmlFile();
+  text_ = text;
+}
 
 const std::string &Md4Block::XmlSnippet() const { return text_; }
 
+const IXmlFile *Md4Block::XmlFile() const {
+  std::lock_guard lock(xml_mutex_);
+  if (!xml_parsed_) {
+    // Only parse once even if the parse fails.
+    xml_parsed_ = true;
+    if (auto xml = CreateXmlFile(); xml && xml->ParseString(text_)) {
+      xml_file_ = std::move(xml);
+    }
+  }
+  return xml_file_.get();
+}
+
+void Md4Block::ResetXmlFile() {
+  std::lock_guard lock(xml_mutex_);
+  xml_file_.reset();
+  xml_parsed_ = false;
+}
+
 }  // namespace mdf::detail
\ No newline at end of file
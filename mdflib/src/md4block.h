@@ -3,16 +3,23 @@
  * SPDX-License-Identifier: MIT
  */
 #pragma once
+#include <memory>
+#include <mutex>
 #include <string>
 
 #include "tx4block.h"
 
+namespace mdf {
+class IXmlFile;
+}
+
 namespace mdf::detail {
 class Md4Block : public Tx4Block, public IMetaData {
  public:
 
   Md4Block();
   explicit Md4Block(const std::string& text);
+  ~Md4Block() override;
 
   [[nodiscard]] int64_t Index() const override {
     return MdfBlock::Index();
@@ -21,11 +28,30 @@ class Md4Block : public Tx4Block, public IMetaData {
     return MdfBlock::BlockType();
   }
   void GetBlockProperty(BlockPropertyList& dest) const override;
+  uint64_t Read(std::streambuf& buffer) override;
+
+  using Tx4Block::Text;
+  void Text(const std::string& text) override;
 
   void TxComment(const std::string& tx_comment);
   [[nodiscard]] std::string TxComment() const override;
 
   void XmlSnippet(const std::string& text) override;
   [[nodiscard]] const std::string& XmlSnippet() const override;
+
+  /** \brief Returns the parsed XML snippet.
+   *
+   * The XML snippet is parsed on first access. The result is kept until the
+   * text is changed.
+   * @return The parsed XML or null if the text couldn't be parsed.
+   */
+  [[nodiscard]] const IXmlFile* XmlFile() const;
+
+ private:
+  mutable std::mutex xml_mutex_;
+  mutable std::unique_ptr<IXmlFile> xml_file_; ///< Parsed XML snippet.
+  mutable bool xml_parsed_ = false;
+
+  void ResetXmlFile();
 };
 }  // namespace mdf::detail
@@ -13,6 +13,7 @@
 #include <string>
 #include <thread>
 
+#include "blockindex.h"
 #include "ixmlfile.h"
 #include "md4block.h"
 #include "mdf/mdflogstream.h"
@@ -411,8 +412,10 @@ size_t MdfBlock::ReadHeader4(std::FILE *file) {
 */
 
 uint64_t MdfBlock::ReadHeader3(std::streambuf& buffer) {
+  const int64_t old_position = file_position_;
   file_position_ = GetFilePosition(buffer);
   uint64_t bytes = ReadStr(buffer, block_type_, 2);
+  UpdateBlockIndex(old_position);
   if (block_type_ == "##") {
     throw std::runtime_error("MDF 4 header detected. This is not an MDF 3 file.");
   }
@@ -435,8 +438,10 @@ uint64_t MdfBlock::ReadLinks3(std::streambuf& buffer, size_t nof_links) {
 
 
 uint64_t MdfBlock::ReadHeader4(std::streambuf& buffer) {
+  const int64_t old_position = file_position_;
   file_position_ = GetFilePosition(buffer);
   uint64_t bytes = ReadStr(buffer, block_type_, 4);
+  UpdateBlockIndex(old_position);
   uint32_t reserved = 0;
   bytes += ReadNumber(buffer, reserved);
   bytes += ReadNumber(buffer, block_length_);
@@ -454,10 +459,65 @@ uint64_t MdfBlock::ReadHeader4(std::streambuf& buffer) {
 }
 
 
+MdfBlock::~MdfBlock() {
+  if (IsIndexed()) {
+    block_index_->Remove(file_position_, *this);
+  }
+}
+
 void MdfBlock::Init(const MdfBlock &id_block) {
   byte_order_ = id_block.byte_order_;
   version_ = id_block.version_;
   parent_ = &id_block;
+  if (id_block.string_pool_ != nullptr) {
+    string_pool_ = id_block.string_pool_;
+  }
+  // The ID block has no index, so the header block keeps its own index.
+  if (id_block.block_index_ != nullptr &&
+      id_block.block_index_ != block_index_) {
+    if (IsIndexed()) {
+      block_index_->Remove(file_position_, *this);
+    }
+    block_index_ = id_block.block_index_;
+    if (IsIndexed()) {
+      block_index_->Add(*this);
+    }
+  }
+}
+
+bool MdfBlock::IsIndexed() const {
+  // The text blocks are often temporary and are found through their owner.
+  return block_index_ != nullptr && file_position_ > 0 &&
+         block_type_ != "##TX" && block_type_ != "##MD";
+}
+
+void MdfBlock::UpdateBlockIndex(int64_t old_position) {
+  if (block_index_ == nullptr || old_position == file_position_) {
+    return;
+  }
+  if (old_position > 0) {
+    block_index_->Remove(old_position, *this);
+  }
+  if (IsIndexed()) {
+    block_index_->Add(*this);
+  }
+}
+
+MdfBlock* MdfBlock::FindIndexed(int64_t index) const {
+  if (block_index_ == nullptr) {
+    return nullptr;
+  }
+  MdfBlock* block = block_index_->Find(index);
+  if (block == nullptr || block->FilePosition() != index) {
+    return nullptr;
+  }
+  for (const MdfBlock* parent = block; parent != nullptr;
+       parent = parent->parent_) {
+    if (parent == this) {
+      return block;
+    }
+  }
+  return nullptr;
 }
 
 const MdfBlock* MdfBlock::HeaderBlock() const {
@@ -568,6 +628,20 @@ std::string MdfBlock::ReadTx4(std::streambuf& buffer, size_t index_tx) const {
   return {};
 }
 
+PoolString MdfBlock::ReadPoolTx4(std::streambuf& buffer,
+                                size_t index_tx) const {
+  return Link(index_tx) > 0 ? MakePoolString(ReadTx4(buffer, index_tx))
+                            : PoolString();
+}
+
+PoolString MdfBlock::MakePoolString(std::string_view text) const {
+  if (string_pool_ != nullptr) {
+    return string_pool_->Intern(text);
+  }
+  return text.empty() ? PoolString()
+                      : std::make_shared<const std::string>(text);
+}
+
 const Md4Block *MdfBlock::Md4() const {
   return !md_comment_ ? nullptr
                       : dynamic_cast<const Md4Block *>(md_comment_.get());
@@ -621,7 +695,9 @@ std::string MdfBlock::MdText() const {
 
 uint64_t MdfBlock::Write(std::streambuf& buffer) {
   SetLastFilePosition(buffer);
+  const int64_t old_position = file_position_;
   file_position_ = GetFilePosition(buffer);
+  UpdateBlockIndex(old_position);
 
   uint64_t bytes = 0;
   if (IsMdf4()) {
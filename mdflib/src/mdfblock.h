@@ -16,6 +16,7 @@
 #include "littlebuffer.h"
 #include "mdf/imetadata.h"
 #include "platform.h"
+#include "stringpool.h"
 
 namespace mdf::detail {
 
@@ -25,6 +26,7 @@ enum class UpdateOption : int {
   DoUpdateAllBlocks = 2
 };
 
+class BlockIndex;
 class Md4Block;
 using BlockPropertyList = std::vector<BlockProperty>;
 /*
@@ -99,7 +101,7 @@ bool OpenMdfFile(std::streambuf& buffer, const std::wstring &filename,
 
 class MdfBlock {
  public:
-  virtual ~MdfBlock() = default;
+  virtual ~MdfBlock();
   [[nodiscard]] virtual int64_t Index() const;
   [[nodiscard]] int64_t FilePosition() const;
   [[nodiscard]] virtual std::string BlockType() const;
@@ -187,6 +189,11 @@ class MdfBlock {
   std::unique_ptr<MdfBlock>
       md_comment_;  ///< Most MDF4 block has a MD block referenced
 
+  /** \brief File position index. Set by the Init() function. */
+  BlockIndex* block_index_ = nullptr;
+  /** \brief Shared texts of the file. Set by the Init() function. */
+  StringPool* string_pool_ = nullptr;
+
   MdfBlock() = default;
 
   // size_t ReadHeader3(std::FILE *file);  ///< Reads a MDF3 block header.
@@ -204,6 +211,17 @@ class MdfBlock {
 
   std::string ReadTx3(std::streambuf& buffer, size_t index_tx) const;
   std::string ReadTx4(std::streambuf& buffer, size_t index_tx) const;
+  /** \brief Reads a TX block into a shared text.
+   *
+   * Equal texts of a file share the same storage.
+   * @param buffer Stream buffer.
+   * @param index_tx Link index of the TX block.
+   * @return The shared text or null if empty.
+   */
+  [[nodiscard]] PoolString ReadPoolTx4(std::streambuf& buffer,
+                                       size_t index_tx) const;
+  /** \brief Returns a shared text from the string pool if any. */
+  [[nodiscard]] PoolString MakePoolString(std::string_view text) const;
   void WriteTx4(std::streambuf& buffer, size_t index_tx, const std::string &text);
 
   //std::size_t ReadBool(std::FILE *file, bool &dest) const;
@@ -221,6 +239,13 @@ class MdfBlock {
   void CreateMd4Block();  ///< Helper function that creates an MD4 block to this
                           ///< block
 
+  /** \brief Finds a block below this block by using the block index.
+   *
+   * @param index File position of the block.
+   * @return The block or null if it isn't in the index or below this block.
+   */
+  [[nodiscard]] MdfBlock* FindIndexed(int64_t index) const;
+
 
 
   /** \brief Reads in a list of blocks from the file.
@@ -270,6 +295,9 @@ class MdfBlock {
 
  private:
   const MdfBlock* parent_ = nullptr; ///< Set by the Init() function
+
+  [[nodiscard]] bool IsIndexed() const;
+  void UpdateBlockIndex(int64_t old_position);
 };
 
 /*
@@ -4,9 +4,12 @@
  */
 #include "mdf/mdfreader.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <string>
 #include <thread>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <fstream>
@@ -22,6 +25,8 @@
 #include "sr4block.h"
 #include "sr3block.h"
 #include "dgrange.h"
+#include "hd4block.h"
+#include "mappedfilebuf.h"
 
 #if INCLUDE_STD_FILESYSTEM_EXPERIMENTAL
 #include <experimental/filesystem>
@@ -35,6 +40,13 @@ using namespace std::chrono_literals;
 using namespace mdf::detail;
 using namespace fs;
 
+namespace {
+
+constexpr std::string_view kIndexFileId = "MDFINDEX";
+constexpr uint64_t kIndexFileVersion = 1;
+
+}  // namespace
+
 namespace mdf {
 
 bool IsMdfFile(const std::string &filename) {
@@ -224,6 +236,31 @@ void CreateChannelObserverForChannelGroup(const IDataGroup &data_group,
   }
 }
 
+DataGroupObserverList CreateChannelObservers(
+    const ChannelIndex &index, const std::vector<std::string> &channel_names) {
+  DataGroupObserverList dest;
+  std::unordered_set<const IChannel *> channel_list;
+  for (const auto &name : channel_names) {
+    ChannelIndexItem item;
+    if (!index.Find(name, item) || !channel_list.insert(item.Channel).second) {
+      continue;
+    }
+    auto itr = std::find_if(dest.begin(), dest.end(),
+                            [&](const DataGroupObservers &group) {
+                              return group.DataGroup == item.DataGroup;
+                            });
+    if (itr == dest.end()) {
+      itr = dest.insert(dest.end(), {item.DataGroup, {}});
+    }
+    auto observer = CreateChannelObserver(*item.DataGroup, *item.ChannelGroup,
+                                          *item.Channel);
+    if (observer) {
+      itr->ObserverList.emplace_back(std::move(observer));
+    }
+  }
+  return dest;
+}
+
 void CreateChannelObserverForDataGroup(const IDataGroup &data_group,
                                           ChannelObserverList &dest) {
   const auto cg_list = data_group.ChannelGroups();
@@ -266,10 +303,17 @@ MdfReader::MdfReader(std::wstring filename)
     return;
   }
 
-  // Create an internal std::filebuf
-  auto file_buffer = std::make_shared<std::filebuf>();
-  file_ = std::move(file_buffer);
-
+  // Map the file into memory if possible. The block readers then read
+  // directly from the mapping. Fall back on an ordinary file buffer if the
+  // mapping fails (empty file or a file larger than the address space).
+  if (auto mapped_buffer = std::make_shared<MappedFileBuf>();
+      mapped_buffer->Open(filename_)) {
+    file_ = std::move(mapped_buffer);
+  } else {
+    // Create an internal std::filebuf
+    auto file_buffer = std::make_shared<std::filebuf>();
+    file_ = std::move(file_buffer);
+  }
 
   VerifyMdfFile();
 }
@@ -352,6 +396,11 @@ bool MdfReader::Open() {
     return false;
   }
 
+  if (auto* mapped_buffer = dynamic_cast<MappedFileBuf*>(file_.get());
+      mapped_buffer != nullptr) {
+    return mapped_buffer->IsOpen() || mapped_buffer->Open(filename_);
+  }
+
   // Note that the above function will return true if it isn't a file
   // buffer.
   return OpenMdfFile(*file_, filename_,
@@ -365,6 +414,10 @@ bool MdfReader::IsOpen() const {
   }
 
   try {
+    if (const auto* mapped_buffer = dynamic_cast<MappedFileBuf*>(buffer);
+        mapped_buffer != nullptr) {
+      return mapped_buffer->IsOpen();
+    }
     auto* file_buf = dynamic_cast<std::filebuf*>(buffer);
     return file_buf == nullptr ? true : file_buf->is_open();
   } catch (const std::exception& err) {
@@ -386,6 +439,11 @@ void MdfReader::Close() {
   }
 
   try {
+    if (auto* mapped_buffer = dynamic_cast<MappedFileBuf*>(buffer);
+        mapped_buffer != nullptr) {
+      mapped_buffer->Close();
+      return;
+    }
     auto* file_buf = dynamic_cast<std::filebuf*>(buffer);
     if (file_buf != nullptr && file_buf->is_open()) {
       file_buf->close();
@@ -434,6 +492,9 @@ bool MdfReader::ReadMeasurementInfo() {
     return false;
   }
   bool no_error = true;
+  if (channel_index_) {
+    channel_index_->Clear();
+  }
   try {
     instance_->ReadMeasurementInfo(*file_);
 
@@ -459,7 +520,15 @@ bool MdfReader::ReadEverythingButData() {
     return false;
   }
   bool no_error = true;
+  if (channel_index_) {
+    channel_index_->Clear();
+  }
   try {
+    if (lazy_metadata_) {
+      // The header block must exist before the channels are read.
+      instance_->ReadHeader(*file_);
+      SetLazyMetadata();
+    }
     instance_->ReadEverythingButData(*file_);
 
   } catch (const std::exception &error) {
@@ -473,6 +542,33 @@ bool MdfReader::ReadEverythingButData() {
   return no_error;
 }
 
+void MdfReader::SetLazyMetadata() {
+  auto* hd4 = dynamic_cast<detail::Hd4Block*>(instance_->Header());
+  if (hd4 == nullptr || hd4->IsLazyMetadata()) {
+    return;
+  }
+  hd4->LazyMetadata([this](
+      const std::function<void(std::streambuf&)>& read) {
+    bool shall_close = !IsOpen() && Open();
+    if (!IsOpen()) {
+      MDF_ERROR() << "File is not open. File: " << Filename();
+      return false;
+    }
+    bool no_error = true;
+    try {
+      read(*file_);
+    } catch (const std::exception& error) {
+      MDF_ERROR() << "Failed to read the channel metadata. Error: "
+                  << error.what();
+      no_error = false;
+    }
+    if (shall_close) {
+      Close();
+    }
+    return no_error;
+  });
+}
+
 bool MdfReader::ExportAttachmentData(const IAttachment &attachment,
                                      const std::string &dest_file) {
   if (!instance_ || !file_) {
@@ -547,6 +643,8 @@ bool MdfReader::ReadData(IDataGroup &data_group) {
   try {
     if (instance_->IsMdf4()) {
       auto &dg4 = dynamic_cast<detail::Dg4Block &>(data_group);
+      dg4.ReadBufferSize(read_buffer_size_);
+      dg4.ReadThreads(read_threads_);
       dg4.ReadData(*file_);
     } else {
       auto &dg3 = dynamic_cast<detail::Dg3Block &>(data_group);
@@ -564,6 +662,122 @@ bool MdfReader::ReadData(IDataGroup &data_group) {
   return !error;
 }
 
+bool MdfReader::ReadDataParallel(const DataGroupList &data_group_list) {
+  if (!instance_ || !file_) {
+    MDF_ERROR() << "No instance created. File: " << Filename();
+    return false;
+  }
+  if (data_group_list.empty()) {
+    return true;
+  }
+
+  // Each worker needs its own stream buffer. That isn't possible if the
+  // reader was created from an external stream buffer, so read the data
+  // groups one by one in that case.
+  const size_t nof_threads = read_threads_ > 0 ? read_threads_
+      : std::max(std::thread::hardware_concurrency(), 1U);
+  const size_t nof_workers = std::min(data_group_list.size(), nof_threads);
+  if (filename_.empty() || nof_workers <= 1) {
+    bool read = true;
+    for (auto* data_group : data_group_list) {
+      if (data_group != nullptr && !ReadData(*data_group)) {
+        read = false;
+      }
+    }
+    return read;
+  }
+
+  // The deferred metadata blocks are added to the block index of the
+  // header. Read them before the workers start, as the workers search the
+  // same index.
+  if (instance_->IsMdf4() && lazy_metadata_) {
+    const bool shall_close = !IsOpen() && Open();
+    if (!IsOpen()) {
+      MDF_ERROR() << "Didn't open the file. File: " << Filename();
+      return false;
+    }
+    try {
+      for (auto* data_group : data_group_list) {
+        if (auto* dg4 = dynamic_cast<detail::Dg4Block*>(data_group);
+            dg4 != nullptr) {
+          dg4->ReadMetadata(*file_);
+        }
+      }
+    } catch (const std::exception &err) {
+      MDF_ERROR() << "Didn't read the channel metadata. Error: "
+                  << err.what() << ", File: " << Filename();
+    }
+    if (shall_close) {
+      Close();
+    }
+  }
+
+  // Share the threads between the data groups, so the DZ decompression and
+  // the parallel parse of each data group don't oversubscribe the cores.
+  const auto group_threads = static_cast<unsigned>(
+      std::max<size_t>(nof_threads / nof_workers, 1));
+  const bool mapped = dynamic_cast<MappedFileBuf*>(file_.get()) != nullptr;
+  std::atomic<size_t> next_index = 0;
+  std::atomic<bool> error = false;
+
+  auto worker = [&]() -> void {
+    // Open a private stream buffer. The memory mapping is shared between the
+    // workers by the OS, so mapping the file once per worker is cheap.
+    std::unique_ptr<std::streambuf> buffer;
+    if (mapped) {
+      if (auto mapped_buffer = std::make_unique<MappedFileBuf>();
+          mapped_buffer->Open(filename_)) {
+        buffer = std::move(mapped_buffer);
+      }
+    }
+    if (!buffer) {
+      auto file_buffer = std::make_unique<std::filebuf>();
+      if (!OpenMdfFile(*file_buffer, filename_,
+                       std::ios_base::in | std::ios_base::binary)) {
+        MDF_ERROR() << "Failed to open the file. File: " << Filename();
+        error = true;
+        return;
+      }
+      buffer = std::move(file_buffer);
+    }
+
+    for (size_t index = next_index++; index < data_group_list.size();
+         index = next_index++) {
+      auto* data_group = data_group_list[index];
+      if (data_group == nullptr) {
+        continue;
+      }
+      try {
+        if (instance_->IsMdf4()) {
+          auto &dg4 = dynamic_cast<detail::Dg4Block &>(*data_group);
+          dg4.ReadBufferSize(read_buffer_size_);
+          dg4.ReadThreads(group_threads);
+          dg4.ReadData(*buffer);
+        } else {
+          auto &dg3 = dynamic_cast<detail::Dg3Block &>(*data_group);
+          dg3.ReadData(*buffer);
+        }
+      } catch (const std::exception &err) {
+        MDF_ERROR() << "Didn't read the data group. Error: "
+                    << err.what() << ", File: " << Filename();
+        error = true;
+      }
+    }
+  };
+
+  std::vector<std::thread> worker_list;
+  worker_list.reserve(nof_workers - 1);
+  for (size_t worker_index = 1; worker_index < nof_workers; ++worker_index) {
+    worker_list.emplace_back(worker);
+  }
+  // The calling thread also does some work.
+  worker();
+  for (auto& thread : worker_list) {
+    thread.join();
+  }
+  return !error;
+}
+
 bool MdfReader::ReadInDataBuffer(int64_t data_position, uint64_t nof_bytes,
                                  std::vector<uint8_t> &destination) {
   try {
@@ -611,6 +825,8 @@ bool MdfReader::ReadPartialData(IDataGroup &data_group, size_t min_sample,
     if (instance_->IsMdf4()) {
 
       auto &dg4 = dynamic_cast<detail::Dg4Block &>(data_group);
+      dg4.ReadBufferSize(read_buffer_size_);
+      dg4.ReadThreads(read_threads_);
       DgRange range(dg4, min_sample, max_sample);
       dg4.ReadRangeData(*file_, range);
     } else {
@@ -630,6 +846,189 @@ bool MdfReader::ReadPartialData(IDataGroup &data_group, size_t min_sample,
   return !error;
 }
 
+bool MdfReader::ReadTimeRange(IDataGroup &data_group, double t_start,
+                              double t_stop) {
+  if (!instance_ || !file_) {
+    MDF_ERROR() << "No instance created. File: " << Filename();
+    return false;
+  }
+  if (!instance_->IsMdf4()) {
+    MDF_ERROR() << "Time range read is only supported by MDF4. File: "
+                << Filename();
+    return false;
+  }
+  if (t_stop < t_start) {
+    t_stop = t_start;
+  }
+  bool shall_close = !IsOpen() && Open();
+  if (!IsOpen()) {
+    MDF_ERROR() << "Failed to open file. File: " << Filename();
+    return false;
+  }
+
+  bool error = false;
+  try {
+    auto &dg4 = dynamic_cast<detail::Dg4Block &>(data_group);
+    dg4.ReadBufferSize(read_buffer_size_);
+    dg4.ReadThreads(read_threads_);
+    DgRange range(dg4, 0, 0);
+    if (dg4.FindTimeRange(*file_, t_start, t_stop, range)) {
+      dg4.ReadRangeData(*file_, range);
+    } else {
+      MDF_ERROR() << "Failed to find the time range. File: " << Filename();
+      error = true;
+    }
+  } catch (const std::exception &err) {
+    MDF_ERROR() << "Failed to read the time range. Error: "
+                << err.what() << ", File: " << Filename();
+    error = true;
+  }
+
+  if (shall_close) {
+    Close();
+  }
+  return !error;
+}
+
+bool MdfReader::CreateSampleIndex(IDataGroup &data_group,
+                                  uint64_t sample_interval) {
+  if (!instance_ || !file_) {
+    MDF_ERROR() << "No instance created. File: " << Filename();
+    return false;
+  }
+  if (!instance_->IsMdf4()) {
+    MDF_ERROR() << "Sample index is only supported by MDF4. File: "
+                << Filename();
+    return false;
+  }
+  bool shall_close = !IsOpen() && Open();
+  if (!IsOpen()) {
+    MDF_ERROR() << "Failed to open file. File: " << Filename();
+    return false;
+  }
+
+  bool created = false;
+  try {
+    auto &dg4 = dynamic_cast<detail::Dg4Block &>(data_group);
+    dg4.ReadBufferSize(read_buffer_size_);
+    created = dg4.CreateSampleIndex(*file_, sample_interval);
+  } catch (const std::exception &err) {
+    MDF_ERROR() << "Failed to create the sample index. Error: "
+                << err.what() << ", File: " << Filename();
+  }
+
+  if (shall_close) {
+    Close();
+  }
+  return created;
+}
+
+bool MdfReader::SaveSampleIndex(const std::string &index_file) const {
+  if (!instance_ || !instance_->IsMdf4()) {
+    MDF_ERROR() << "No MDF4 instance created. File: " << Filename();
+    return false;
+  }
+  try {
+    const path index_path = index_file.empty() ?
+        path(filename_ + L".idx") : path(index_file);
+    std::ofstream output(index_path,
+                         std::ios_base::out | std::ios_base::binary |
+                         std::ios_base::trunc);
+    if (!output.is_open()) {
+      MDF_ERROR() << "Failed to create the index file. File: "
+                  << index_path.string();
+      return false;
+    }
+
+    DataGroupList dg_list;
+    instance_->DataGroups(dg_list);
+    std::vector<const DgIndex*> index_list;
+    for (const auto* data_group : dg_list) {
+      const auto* dg4 = dynamic_cast<const detail::Dg4Block *>(data_group);
+      if (dg4 != nullptr && dg4->SampleIndex() != nullptr) {
+        index_list.push_back(dg4->SampleIndex());
+      }
+    }
+
+    const uint64_t file_size = filename_.empty() ? 0 :
+                               fs::file_size(path(filename_));
+    const uint64_t nof_index = index_list.size();
+    output.write(kIndexFileId.data(),
+                 static_cast<std::streamsize>(kIndexFileId.size()));
+    output.write(reinterpret_cast<const char *>(&kIndexFileVersion),
+                 sizeof(kIndexFileVersion));
+    output.write(reinterpret_cast<const char *>(&file_size),
+                 sizeof(file_size));
+    output.write(reinterpret_cast<const char *>(&nof_index),
+                 sizeof(nof_index));
+    for (const auto* index : index_list) {
+      index->Write(output);
+    }
+    return output.good();
+  } catch (const std::exception &err) {
+    MDF_ERROR() << "Failed to save the index file. Error: " << err.what()
+                << ", File: " << Filename();
+  }
+  return false;
+}
+
+bool MdfReader::LoadSampleIndex(const std::string &index_file) {
+  if (!instance_ || !instance_->IsMdf4()) {
+    MDF_ERROR() << "No MDF4 instance created. File: " << Filename();
+    return false;
+  }
+  try {
+    const path index_path = index_file.empty() ?
+        path(filename_ + L".idx") : path(index_file);
+    std::ifstream input(index_path, std::ios_base::in | std::ios_base::binary);
+    if (!input.is_open()) {
+      return false;
+    }
+
+    std::string file_id(kIndexFileId.size(), '\0');
+    uint64_t version = 0;
+    uint64_t file_size = 0;
+    uint64_t nof_index = 0;
+    input.read(file_id.data(), static_cast<std::streamsize>(file_id.size()));
+    input.read(reinterpret_cast<char *>(&version), sizeof(version));
+    input.read(reinterpret_cast<char *>(&file_size), sizeof(file_size));
+    input.read(reinterpret_cast<char *>(&nof_index), sizeof(nof_index));
+    if (!input.good() || file_id != kIndexFileId ||
+        version != kIndexFileVersion) {
+      MDF_ERROR() << "Invalid index file. File: " << index_path.string();
+      return false;
+    }
+    // The MDF file may have been changed after the index was created.
+    if (!filename_.empty() && file_size != fs::file_size(path(filename_))) {
+      MDF_ERROR() << "The index file doesn't match the MDF file. File: "
+                  << index_path.string();
+      return false;
+    }
+
+    DataGroupList dg_list;
+    instance_->DataGroups(dg_list);
+    for (uint64_t count = 0; count < nof_index; ++count) {
+      auto index = std::make_unique<DgIndex>();
+      if (!index->Read(input)) {
+        MDF_ERROR() << "Invalid index file. File: " << index_path.string();
+        return false;
+      }
+      for (auto* data_group : dg_list) {
+        auto* dg4 = dynamic_cast<detail::Dg4Block *>(data_group);
+        if (dg4 != nullptr && dg4->FilePosition() == index->DgPosition()) {
+          dg4->SampleIndex(std::move(index));
+          break;
+        }
+      }
+    }
+    return true;
+  } catch (const std::exception &err) {
+    MDF_ERROR() << "Failed to load the index file. Error: " << err.what()
+                << ", File: " << Filename();
+  }
+  return false;
+}
+
 bool MdfReader::ReadSrData(ISampleReduction &sr_group) {
   if (!instance_ || !file_) {
     MDF_ERROR() << "No instance created. File: " << Filename();
@@ -687,6 +1086,16 @@ IDataGroup *MdfReader::GetDataGroup(size_t order) const {
   return nullptr;
 }
 
+ChannelIndex *MdfReader::GetChannelIndex() {
+  if (!instance_) {
+    return nullptr;
+  }
+  if (!channel_index_) {
+    channel_index_ = std::make_unique<ChannelIndex>(*instance_);
+  }
+  return channel_index_.get();
+}
+
 bool MdfReader::ReadVlsdData(IDataGroup &data_group,
                              IChannel &vlsd_channel,
                              const std::vector<uint64_t>& offset_list,
@@ -714,6 +1123,7 @@ bool MdfReader::ReadVlsdData(IDataGroup &data_group,
     if (instance_->IsMdf4()) {
       auto &dg4 = dynamic_cast<detail::Dg4Block &>(data_group);
       auto &cn4 = dynamic_cast<detail::Cn4Block &>(vlsd_channel);
+      dg4.ReadBufferSize(read_buffer_size_);
       dg4.ReadVlsdData(*file_, cn4,offset_list, callback);
     } else {
       MDF_ERROR() << "Function not support for version MDF version 3.";
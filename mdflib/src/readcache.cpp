@@ -4,15 +4,20 @@
  */
 
 #include "readcache.h"
-#include <iostream>
+
+#include <algorithm>
+#include <thread>
 
 #include "mdf/mdflogstream.h"
+#include "mappedfilebuf.h"
+#include "dz4block.h"
 
 namespace mdf::detail {
 
 ReadCache::ReadCache( MdfBlock* block, std::streambuf& buffer)
 : buffer_(buffer)
 {
+  mapped_buffer_ = dynamic_cast<const MappedFileBuf*>(&buffer);
   data_list_ = dynamic_cast<DataListBlock*>(block);
   data_block_ = dynamic_cast<DataBlock*>(block);
   dg4_block_ = dynamic_cast<Dg4Block*>(block);
@@ -42,6 +47,7 @@ ReadCache::ReadCache( MdfBlock* block, std::streambuf& buffer)
   } else if (data_block_ != nullptr) {
     block_list_.push_back(data_block_);
   }
+  InitInflatePipeline();
 }
 
 bool ReadCache::ParseRecord() {
@@ -66,9 +72,7 @@ bool ReadCache::ParseRecord() {
     if (channel_group->Flags() & CgFlag::VlsdChannel) {
       // This is normally used for the string,
       // and the CG block only includes one signal
-      std::vector<uint8_t> temp(4, 0);
-      GetArray(temp);
-      const LittleBuffer<uint32_t> length(temp, 0);
+      const LittleBuffer<uint32_t> length(GetRecord(4).data());
 
       if (record_id_list_.find(record_id) == record_id_list_.cend()) {
         SkipBytes(length.value());
@@ -77,8 +81,7 @@ bool ReadCache::ParseRecord() {
           channel_group->IncrementSample();
         }
       } else {
-        std::vector<uint8_t> record(length.value(), 0);
-        GetArray(record);
+        const auto record = GetRecord(length.value());
         const size_t sample = channel_group->Sample();
         if (sample < channel_group->NofSamples()) {
           continue_reading = dg4_block_->NotifySampleObservers(sample,
@@ -98,8 +101,7 @@ bool ReadCache::ParseRecord() {
           channel_group->IncrementSample();
         }
       } else {
-        std::vector<uint8_t> record(record_size, 0);
-        GetArray(record);
+        const auto record = GetRecord(record_size);
         const size_t sample = channel_group->Sample();
         if (sample < channel_group->NofSamples()) {
           continue_reading = dg4_block_->NotifySampleObservers(sample,
@@ -142,18 +144,16 @@ bool ReadCache::ParseRangeRecord(DgRange& range) {
     if (channel_group->Flags() & CgFlag::VlsdChannel) {
       // This is normally used for string,
       // and the CG block only includes one signal
-      std::vector<uint8_t> temp(4, 0);
-      GetArray(temp);
-      const LittleBuffer<uint32_t> length(temp, 0);
+      const LittleBuffer<uint32_t> length(GetRecord(4).data());
       if (!cg_range->IsUsed() ||
-          next_sample < range.MinSample() ||
-          next_sample > range.MaxSample() ) {
+          next_sample < cg_range->MinSample() ||
+          next_sample > cg_range->MaxSample() ) {
         // Skip this sample
         SkipBytes(length.value());
         if (sample < channel_group->NofSamples()) {
           channel_group->IncrementSample();
         }
-        if (next_sample > range.MaxSample()) {
+        if (next_sample > cg_range->MaxSample()) {
           // Mark this group as read
           cg_range->IsUsed(false);
         }
@@ -164,8 +164,7 @@ bool ReadCache::ParseRangeRecord(DgRange& range) {
           channel_group->IncrementSample();
         }
       } else {
-        std::vector<uint8_t> record(length.value(), 0);
-        GetArray(record);
+        const auto record = GetRecord(length.value());
         if (sample < channel_group->NofSamples()) {
           continue_reading = dg4_block_->NotifySampleObservers(sample,
                             record_id, record);
@@ -177,14 +176,14 @@ bool ReadCache::ParseRangeRecord(DgRange& range) {
                                  + channel_group->NofInvalidBytes();
       // Normal fixed length records
       if (!cg_range->IsUsed() ||
-          next_sample < range.MinSample() ||
-          next_sample > range.MaxSample() ) {
+          next_sample < cg_range->MinSample() ||
+          next_sample > cg_range->MaxSample() ) {
         // Skip this sample
         SkipBytes(record_size);
         if (sample < channel_group->NofSamples()) {
           channel_group->IncrementSample();
         }
-        if (next_sample > range.MaxSample()) {
+        if (next_sample > cg_range->MaxSample()) {
           // Mark this group as read
           cg_range->IsUsed(false);
         }
@@ -195,8 +194,7 @@ bool ReadCache::ParseRangeRecord(DgRange& range) {
           channel_group->IncrementSample();
         }
       } else {
-        std::vector<uint8_t> record(record_size, 0);
-        GetArray(record);
+        const auto record = GetRecord(record_size);
         if (sample < channel_group->NofSamples()) {
           continue_reading = dg4_block_->NotifySampleObservers(sample,
                                             channel_group->RecordId(), record);
@@ -223,9 +221,7 @@ bool ReadCache::ParseSignalData() {
     bool skip = false;
     try {
 
-      std::vector<uint8_t> temp(4, 0);
-      GetArray(temp);
-      const LittleBuffer<uint32_t> length(temp, 0);
+      const LittleBuffer<uint32_t> length(GetRecord(4).data());
 
       if (!offset_filter_.empty() &&
            offset_filter_.find(offset_) == offset_filter_.cend()) {
@@ -233,8 +229,8 @@ bool ReadCache::ParseSignalData() {
         skip = true;
         offset_ += 4 + length.value();
       } else {
-        std::vector<uint8_t> raw_data(length.value());
-        GetArray(raw_data);
+        const auto data = GetRecord(length.value());
+        const std::vector<uint8_t> raw_data(data.begin(), data.end());
         if (callback_) {
           callback_(offset_, raw_data);
         }
@@ -271,16 +267,14 @@ bool ReadCache::ParseSignalDataOffset(uint64_t offset) {
     if (data_count_ + 4 > max_data_count_ ) {
       return false;
     }
-    std::vector<uint8_t> temp(4, 0);
-    GetArray(temp);
-    const LittleBuffer<uint32_t> length(temp, 0);
+    const LittleBuffer<uint32_t> length(GetRecord(4).data());
     const uint32_t nof_bytes = length.value();
 
     if (data_count_ + nof_bytes > max_data_count_ ) {
       return false;
     }
-    std::vector<uint8_t> raw_data(length.value());
-    GetArray(raw_data);
+    const auto data = GetRecord(length.value());
+    const std::vector<uint8_t> raw_data(data.begin(), data.end());
 
     if (callback_) {
       callback_(offset_, raw_data);
@@ -314,9 +308,7 @@ bool ReadCache::ParseVlsdCgData() {
       if (channel_group->Flags() & CgFlag::VlsdChannel) {
         // This is normally used for string,
         // and the CG block only includes one signal
-        std::vector<uint8_t> temp(4, 0);
-        GetArray(temp);
-        const LittleBuffer<uint32_t> length(temp, 0);
+        const LittleBuffer<uint32_t> length(GetRecord(4).data());
 
         if (record_id_list_.find(record_id) == record_id_list_.cend()) {
           SkipBytes(length.value());
@@ -327,8 +319,8 @@ bool ReadCache::ParseVlsdCgData() {
           offset_ += 4 + length.value();
           skip = true;
         } else {
-          std::vector<uint8_t> raw_data(length.value());
-          GetArray(raw_data);
+          const auto data = GetRecord(length.value());
+          const std::vector<uint8_t> raw_data(data.begin(), data.end());
           if (callback_) {
             callback_(offset_, raw_data);
           }
@@ -351,57 +343,491 @@ bool ReadCache::ParseVlsdCgData() {
   return data_count_ <= max_data_count_;
 }
 
-bool ReadCache::GetNextByte(uint8_t &input) {
-  if ( file_index_ < data_size_) {
-    if (file_buffer_.empty()) {
-      // Read direct from the file
-     input = buffer_.sbumpc();
-    } else {
-      // Read from buffer in case of DZ block
-      input = file_buffer_[file_index_];
+bool ReadCache::BuildSampleIndex(DgIndex& index) {
+  if (dg4_block_ == nullptr) {
+    return false;
+  }
+  const auto& record_id_list = index.RecordIdList();
+  std::vector<const Cg4Block*> cg_list(record_id_list.size(), nullptr);
+  for (size_t cg_index = 0; cg_index < record_id_list.size(); ++cg_index) {
+    const auto itr = available_cg_list_.find(record_id_list[cg_index]);
+    cg_list[cg_index] = itr == available_cg_list_.cend() ? nullptr :
+                        itr->second;
+  }
+  std::vector<uint64_t> sample_list(record_id_list.size(), 0);
+  const uint64_t interval = index.SampleInterval();
+  try {
+    while (data_count_ < max_data_count_) {
+      const uint64_t data_offset = data_count_;
+      const auto record_id = ParseRecordId();
+      const int64_t cg_index = record_id_list.size() == 1 ?
+                        0 : index.RecordIdIndex(record_id);
+      if (cg_index < 0 || cg_list[static_cast<size_t>(cg_index)] == nullptr) {
+        throw std::runtime_error("No channel group found.");
+      }
+      const auto* channel_group = cg_list[static_cast<size_t>(cg_index)];
+      uint64_t& sample = sample_list[static_cast<size_t>(cg_index)];
+      if (sample > 0 && sample % interval == 0 &&
+          sample < channel_group->NofSamples()) {
+        index.AddCheckpoint(data_offset, sample_list);
+      }
+
+      if (channel_group->Flags() & CgFlag::VlsdChannel) {
+        const LittleBuffer<uint32_t> length(GetRecord(4).data());
+        SkipBytes(length.value());
+      } else {
+        SkipBytes(channel_group->NofDataBytes()
+                  + channel_group->NofInvalidBytes());
+      }
+      // Same sample counting as when reading the records.
+      if (sample < channel_group->NofSamples()) {
+        ++sample;
+      }
     }
-    ++file_index_;
-    ++data_count_;
-    return true;
+  } catch (const std::exception &err) {
+    MDF_ERROR() << "Failed to create the sample index. Error: " << err.what();
+    return false;
+  }
+  return true;
+}
+
+bool ReadCache::BuildVlsdIndex(VlsdIndex& index) {
+  if (dg4_block_ == nullptr || available_cg_list_.empty()) {
+    return false;
+  }
+  uint64_t vlsd_offset = 0;
+  try {
+    while (data_count_ < max_data_count_) {
+      const uint64_t data_offset = data_count_;
+      const auto record_id = ParseRecordId();
+      const auto itr_group = available_cg_list_.find(record_id);
+      if (itr_group == available_cg_list_.cend() ||
+          itr_group->second == nullptr) {
+        throw std::runtime_error("No channel group found.");
+      }
+      const auto* channel_group = itr_group->second;
+      if (channel_group->Flags() & CgFlag::VlsdChannel) {
+        const LittleBuffer<uint32_t> length(GetRecord(4).data());
+        if (record_id == index.RecordId()) {
+          index.AddRecord(vlsd_offset, data_offset);
+          vlsd_offset += 4 + length.value();
+        }
+        SkipBytes(length.value());
+      } else {
+        SkipBytes(channel_group->NofDataBytes()
+                  + channel_group->NofInvalidBytes());
+      }
+    }
+  } catch (const std::exception &err) {
+    MDF_ERROR() << "Failed to create the VLSD index. Error: " << err.what();
+    return false;
+  }
+  return true;
+}
+
+bool ReadCache::ParseVlsdCgOffsets(const VlsdIndex& index) {
+  if (dg4_block_ == nullptr || available_cg_list_.empty()) {
+    return false;
+  }
+  bool positioned = false;
+  try {
+    for (const uint64_t target : offset_filter_) {
+      const auto* checkpoint = index.FindCheckpoint(target);
+      if (checkpoint == nullptr) {
+        continue;
+      }
+      // Offsets close to the current position are reached by continue the
+      // parsing, so they are coalesced into the same read. Otherwise move to
+      // the nearest checkpoint.
+      if (!positioned || offset_ > target ||
+          checkpoint->VlsdOffset > offset_) {
+        SeekData(checkpoint->DataOffset);
+        offset_ = checkpoint->VlsdOffset;
+        positioned = true;
+      }
+      while (offset_ <= target && data_count_ < max_data_count_) {
+        const auto record_id = ParseRecordId();
+        const auto itr_group = available_cg_list_.find(record_id);
+        if (itr_group == available_cg_list_.cend() ||
+            itr_group->second == nullptr) {
+          throw std::runtime_error("No channel group found.");
+        }
+        const auto* channel_group = itr_group->second;
+        if ((channel_group->Flags() & CgFlag::VlsdChannel) == 0) {
+          SkipBytes(channel_group->NofDataBytes()
+                    + channel_group->NofInvalidBytes());
+          continue;
+        }
+        const LittleBuffer<uint32_t> length(GetRecord(4).data());
+        if (record_id != index.RecordId()) {
+          SkipBytes(length.value());
+        } else if (offset_ != target) {
+          SkipBytes(length.value());
+          offset_ += 4 + length.value();
+        } else {
+          const auto data = GetRecord(length.value());
+          const std::vector<uint8_t> raw_data(data.begin(), data.end());
+          if (callback_) {
+            callback_(offset_, raw_data);
+          }
+          offset_ += 4 + length.value();
+        }
+      }
+    }
+  } catch (const std::exception &) {
+    return false;
+  }
+  return true;
+}
+
+bool ReadCache::ReadRecord(uint64_t data_offset, uint64_t record_id,
+                           uint64_t nof_skip, std::vector<uint8_t>& record) {
+  if (dg4_block_ == nullptr || available_cg_list_.empty()) {
+    return false;
+  }
+  try {
+    SeekData(data_offset);
+    while (data_count_ < max_data_count_) {
+      const auto current_id = ParseRecordId();
+      const auto itr_group = available_cg_list_.size() == 1 ?
+          available_cg_list_.cbegin() : available_cg_list_.find(current_id);
+      if (itr_group == available_cg_list_.cend() ||
+          itr_group->second == nullptr) {
+        throw std::runtime_error("No channel group found.");
+      }
+      const auto* channel_group = itr_group->second;
+      size_t record_size = channel_group->NofDataBytes()
+                           + channel_group->NofInvalidBytes();
+      if (channel_group->Flags() & CgFlag::VlsdChannel) {
+        const LittleBuffer<uint32_t> length(GetRecord(4).data());
+        record_size = length.value();
+      }
+      if (channel_group->RecordId() != record_id || nof_skip > 0) {
+        if (channel_group->RecordId() == record_id) {
+          --nof_skip;
+        }
+        SkipBytes(record_size);
+        continue;
+      }
+      const auto data = GetRecord(record_size);
+      record.assign(data.begin(), data.end());
+      return true;
+    }
+  } catch (const std::exception &err) {
+    MDF_ERROR() << "Failed to read record. Error: " << err.what();
+  }
+  return false;
+}
+
+bool ReadCache::IsSorted() const {
+  if (dg4_block_ == nullptr || dg4_block_->Cg4().size() != 1 ||
+      dg4_block_->RecordIdSize() != 0) {
+    return false;
   }
+  const auto* channel_group = dg4_block_->Cg4()[0].get();
+  return channel_group != nullptr &&
+         (channel_group->Flags() & CgFlag::VlsdChannel) == 0;
+}
 
-  if (block_index_ >= block_list_.size()) {
+bool ReadCache::ParseSortedRange(DgRange& range) {
+  if (!IsSorted()) {
     return false;
   }
+  const auto* channel_group = dg4_block_->Cg4()[0].get();
+  const uint64_t record_id = channel_group->RecordId();
+  auto* cg_range = range.GetCgRange(record_id);
+  if (cg_range == nullptr || !cg_range->IsUsed() ||
+      record_id_list_.find(record_id) == record_id_list_.cend()) {
+    return false;
+  }
+  cg_range->IsUsed(false);
+
+  // Note that the range is compared with the sample index + 1, same as in
+  // the ParseRangeRecord() function.
+  if (cg_range->MaxSample() == 0) {
+    return true;
+  }
+  const uint64_t first_sample = cg_range->MinSample() > 0 ?
+                                cg_range->MinSample() - 1 : 0;
+  const uint64_t last_sample = std::min(
+      static_cast<uint64_t>(cg_range->MaxSample()),
+      channel_group->NofSamples());
+  if (first_sample >= last_sample) {
+    return true;
+  }
+  return ParseSortedRecords(first_sample, last_sample - first_sample);
+}
 
-  auto* current_block = block_list_[block_index_];
-  ++block_index_;
-  if (current_block == nullptr) {
+bool ReadCache::ParseSortedRecords(uint64_t first_sample,
+                                   uint64_t nof_samples) {
+  if (!IsSorted()) {
     return false;
   }
-  file_index_ = 0;
-  data_size_ = current_block->DataSize();
-  if (current_block->BlockType() == "DZ") {
+  const auto* channel_group = dg4_block_->Cg4()[0].get();
+  const uint64_t record_id = channel_group->RecordId();
+  const size_t record_size = channel_group->NofDataBytes()
+                             + channel_group->NofInvalidBytes();
+  if (record_size == 0) {
+    return true;
+  }
+  // Deliver all records in a window with one call if the observers
+  // supports it.
+  const bool block_read = dg4_block_->IsSampleBlockSupported(record_id);
+  try {
+    SeekData(first_sample * record_size);
+    const uint64_t last_sample = first_sample + nof_samples;
+    uint64_t sample = first_sample;
+    while (sample < last_sample) {
+      if (data_count_ + record_size > max_data_count_) {
+        break;
+      }
+      if (block_read) {
+        const auto records = GetRecords(record_size, last_sample - sample);
+        if (!records.empty()) {
+          if (!dg4_block_->NotifySampleBlock(sample, record_id, records,
+                                             record_size)) {
+            return false;
+          }
+          sample += records.size() / record_size;
+          continue;
+        }
+      }
+      // The record crosses a window or block edge.
+      const auto record = GetRecord(record_size);
+      if (!dg4_block_->NotifySampleObservers(sample, record_id, record)) {
+        return false;
+      }
+      ++sample;
+    }
+  } catch (const std::exception &err) {
+    MDF_ERROR() << "Parse of sorted records failed. Error: " << err.what();
+    return false;
+  }
+  return true;
+}
+
+void ReadCache::SeekData(uint64_t data_offset) {
+  if (block_offset_list_.size() != block_list_.size()) {
+    block_offset_list_.clear();
+    block_offset_list_.reserve(block_list_.size());
+    uint64_t offset = 0;
+    for (const auto* block : block_list_) {
+      block_offset_list_.push_back(offset);
+      offset += block != nullptr ? block->DataSize() : 0;
+    }
+  }
+
+  window_ = nullptr;
+  window_index_ = 0;
+  window_size_ = 0;
+  block_remaining_ = 0;
+  data_count_ = data_offset;
+
+  // Find the last block that starts at or before the offset.
+  const auto itr = std::upper_bound(block_offset_list_.cbegin(),
+                                    block_offset_list_.cend(), data_offset);
+  if (itr == block_offset_list_.cbegin()) {
+    block_index_ = 0;
+    return;
+  }
+  const auto index = static_cast<size_t>(
+      std::distance(block_offset_list_.cbegin(), itr) - 1);
+  block_index_ = index + 1;
+  if (block_list_[index] == nullptr ||
+      !SetupBlockData(index, data_offset - block_offset_list_[index])) {
+    throw std::runtime_error("Failed to read data block.");
+  }
+}
+
+void ReadCache::BufferSize(size_t buffer_size) {
+  buffer_size_ = std::clamp(buffer_size, kMinBufferSize, kMaxBufferSize);
+}
+
+bool ReadCache::SetupBlockData(size_t index, uint64_t offset) {
+  const DataBlock& block = *block_list_[index];
+  window_ = nullptr;
+  window_index_ = 0;
+  window_size_ = 0;
+  block_remaining_ = 0;
+
+  const uint64_t data_size = block.DataSize();
+  offset = std::min(offset, data_size);
+  if (block.BlockType() == "DZ") {
     // Need a temp buffer in between
     try {
-      file_buffer_.resize(static_cast<size_t>(data_size_) );
+      const auto* dz_block = dynamic_cast<const Dz4Block*>(&block);
+      const uint8_t* compressed_data = mapped_buffer_ != nullptr &&
+          dz_block != nullptr ?
+          mapped_buffer_->Data(block.DataPosition(),
+                               dz_block->CompressedDataSize()) : nullptr;
+      if (max_inflate_jobs_ > 0) {
+        file_buffer_ = GetInflatedBlock(index);
+      } else if (compressed_data != nullptr) {
+        // Doesn't use the stream buffer, so it's safe to use in parallel reads.
+        const std::vector<uint8_t> compressed(compressed_data,
+                          compressed_data + dz_block->CompressedDataSize());
+        dz_block->InflateData(compressed, file_buffer_);
+      } else {
+        file_buffer_.resize(static_cast<size_t>(data_size) );
+        uint64_t temp_index = 0;
+        block.CopyDataToBuffer(buffer_,file_buffer_, temp_index);
+      }
     } catch (const std::exception&) {
-       return false;
+      return false;
     }
+    if (file_buffer_.size() < data_size) {
+      return false;
+    }
+    window_ = file_buffer_.data();
+  } else if (mapped_buffer_ != nullptr) {
+    // Read directly from the memory mapped file.
+    window_ = mapped_buffer_->Data(block.DataPosition(), data_size);
+  }
 
-    uint64_t temp_index = 0;
-    current_block->CopyDataToBuffer(buffer_,file_buffer_, temp_index);
+  if (window_ != nullptr) {
+    window_size_ = static_cast<size_t>(data_size);
+    window_index_ = static_cast<size_t>(offset);
   } else {
-    // Read from the file directly
-    SetFilePosition(buffer_, current_block->DataPosition());
-    file_buffer_.clear(); // Indicate that we read from the file directly
+    // Read from the file in chunks. The window is filled when needed.
+    SetFilePosition(buffer_, block.DataPosition() +
+                    static_cast<int64_t>(offset));
+    block_remaining_ = data_size - offset;
   }
-    // Read in the data form file to
-  if (file_index_ >= data_size_) {
-    return false;
+  return true;
+}
+
+void ReadCache::MaxInflateJobs(unsigned nof_jobs) {
+  max_inflate_jobs_ = std::min(nof_jobs, kMaxInflateJobs);
+  inflate_queue_.clear();
+  inflate_bytes_ = 0;
+  next_inflate_index_ = block_index_;
+}
+
+void ReadCache::InitInflatePipeline() {
+  const auto nof_dz_blocks = std::count_if(block_list_.cbegin(),
+                                           block_list_.cend(),
+      [] (const DataBlock* block) -> bool {
+        return block != nullptr && block->BlockType() == "DZ";
+  });
+  if (nof_dz_blocks < 2) {
+    return; // No meaning to decompress in parallel
+  }
+  const auto nof_cores = std::thread::hardware_concurrency();
+  max_inflate_jobs_ = std::clamp(nof_cores > 1 ? nof_cores - 1 : 1U,
+                                 1U, kMaxInflateJobs);
+}
+
+void ReadCache::ScheduleInflate() {
+  while (next_inflate_index_ < block_list_.size() &&
+         inflate_queue_.size() < max_inflate_jobs_) {
+    const size_t index = next_inflate_index_;
+    const auto* block = dynamic_cast<const Dz4Block*>(block_list_[index]);
+    if (block == nullptr) {
+      ++next_inflate_index_;
+      continue; // Not a DZ block
+    }
+    const uint64_t data_size = block->DataSize();
+    // Keep the decompressed data in flight within the memory budget but
+    // always allow one job.
+    if (!inflate_queue_.empty() &&
+        inflate_bytes_ + data_size > kInflateMemoryBudget) {
+      break;
+    }
+
+    InflateJob job;
+    job.block_index = index;
+    job.data_size = data_size;
+    const uint8_t* compressed_data = mapped_buffer_ != nullptr ?
+        mapped_buffer_->Data(block->DataPosition(),
+                             block->CompressedDataSize()) : nullptr;
+    if (compressed_data != nullptr) {
+      // The worker copy the compressed bytes from the memory mapped file.
+      job.data = std::async(std::launch::async,
+          [block, compressed_data] () -> std::vector<uint8_t> {
+        const std::vector<uint8_t> compressed(compressed_data,
+                      compressed_data + block->CompressedDataSize());
+        std::vector<uint8_t> dest;
+        block->InflateData(compressed, dest);
+        return dest;
+      });
+    } else {
+      // The stream buffer can only be used by this thread. Read the
+      // compressed bytes here and restore the file position, so any
+      // ongoing DT block read isn't affected.
+      const int64_t file_position = GetFilePosition(buffer_);
+      std::vector<uint8_t> compressed;
+      block->ReadCompressedData(buffer_, compressed);
+      SetFilePosition(buffer_, file_position);
+      job.data = std::async(std::launch::async,
+          [block, input = std::move(compressed)] () -> std::vector<uint8_t> {
+        std::vector<uint8_t> dest;
+        block->InflateData(input, dest);
+        return dest;
+      });
+    }
+    inflate_bytes_ += data_size;
+    inflate_queue_.push_back(std::move(job));
+    ++next_inflate_index_;
   }
-  if (file_buffer_.empty()) {
-    input = buffer_.sbumpc();
-  } else {
-    input = file_buffer_[file_index_];
+}
+
+std::vector<uint8_t> ReadCache::GetInflatedBlock(size_t index) {
+  // Drop blocks that have been skipped
+  while (!inflate_queue_.empty() &&
+         inflate_queue_.front().block_index < index) {
+    inflate_bytes_ -= inflate_queue_.front().data_size;
+    inflate_queue_.pop_front();
+  }
+  if (inflate_queue_.empty() ||
+      inflate_queue_.front().block_index != index) {
+    // Random access. Restart the read-ahead at this block.
+    inflate_queue_.clear();
+    inflate_bytes_ = 0;
+    next_inflate_index_ = index;
+    ScheduleInflate();
+  }
+  if (inflate_queue_.empty()) {
+    throw std::runtime_error("Failed to schedule the DZ block.");
+  }
+  auto job = std::move(inflate_queue_.front());
+  inflate_queue_.pop_front();
+  inflate_bytes_ -= job.data_size;
+
+  // Start next decompression while this block is parsed.
+  ScheduleInflate();
+  return job.data.get();
+}
+
+bool ReadCache::FillWindow() {
+  while (window_index_ >= window_size_) {
+    if (block_remaining_ > 0) {
+      // Read in the next chunk of the current block with one read.
+      const auto nof_bytes = static_cast<size_t>(
+          std::min(block_remaining_, static_cast<uint64_t>(buffer_size_)));
+      if (window_buffer_.size() < nof_bytes) {
+        window_buffer_.resize(nof_bytes);
+      }
+      const auto bytes = buffer_.sgetn(
+          reinterpret_cast<char*>(window_buffer_.data()),
+          static_cast<std::streamsize>(nof_bytes));
+      if (bytes != static_cast<std::streamsize>(nof_bytes)) {
+        throw std::runtime_error("End of file detected.");
+      }
+      window_ = window_buffer_.data();
+      window_index_ = 0;
+      window_size_ = nof_bytes;
+      block_remaining_ -= nof_bytes;
+      continue;
+    }
+
+    if (block_index_ >= block_list_.size()) {
+      return false;
+    }
+    const size_t index = block_index_++;
+    if (block_list_[index] == nullptr || !SetupBlockData(index, 0)) {
+      return false;
+    }
   }
-  ++file_index_;
-  ++data_count_;
   return true;
 }
 
@@ -417,30 +843,21 @@ uint64_t ReadCache::ParseRecordId() {
       return cg_list.empty() ? 0 : cg_list[0]->RecordId();
     }
 
-    case 1: {
-      std::vector<uint8_t> temp(1);
-      GetArray(temp);
-      return temp[0];
-    }
+    case 1:
+      return GetRecord(1)[0];
 
     case 2: {
-      std::vector<uint8_t> temp(2,0);
-      GetArray(temp);
-      const LittleBuffer<uint16_t> record_id(temp,0);
+      const LittleBuffer<uint16_t> record_id(GetRecord(2).data());
       return record_id.value();
     }
 
     case 4: {
-      std::vector<uint8_t> temp(4,0);
-      GetArray(temp);
-      const LittleBuffer<uint32_t> record_id(temp,0);
+      const LittleBuffer<uint32_t> record_id(GetRecord(4).data());
       return record_id.value();
     }
 
     case 8: {
-      std::vector<uint8_t> temp(8,0);
-      GetArray(temp);
-      const LittleBuffer<uint64_t> record_id(temp,0);
+      const LittleBuffer<uint64_t> record_id(GetRecord(8).data());
       return record_id.value();
     }
 
@@ -451,140 +868,98 @@ uint64_t ReadCache::ParseRecordId() {
   throw std::runtime_error("Invalid record ID size.");
 }
 
-
-void ReadCache::GetArray(std::vector<uint8_t> &buffer) {
-  const auto nof_bytes = buffer.size();
-  if (file_index_ + nof_bytes <= data_size_) {
-    if (file_buffer_.empty()) {
-      const auto bytes = buffer_.sgetn(
-          reinterpret_cast<char*>(buffer.data()),
-          static_cast<std::streamsize>(nof_bytes));
-      if (bytes != nof_bytes) {
-        throw std::runtime_error("End of file detected.");
-      }
-    } else {
-      std::copy_n(file_buffer_.cbegin() + static_cast<int>(file_index_),
-                  nof_bytes,buffer.begin());
-    }
-    file_index_ += nof_bytes;
+Span<const uint8_t> ReadCache::GetRecord(size_t nof_bytes) {
+  if (window_index_ + nof_bytes <= window_size_) {
+    // The record is inside the current window. No need to copy.
+    const uint8_t* record = window_ + window_index_;
+    window_index_ += nof_bytes;
     data_count_ += nof_bytes;
-    return;
+    return {record, nof_bytes};
+  }
+
+  // The record crosses a window or block edge. Stitch it together.
+  if (scratch_buffer_.size() < nof_bytes) {
+    scratch_buffer_.resize(nof_bytes);
   }
-  for (auto& input : buffer) {
-    if (!GetNextByte(input)){
+  size_t count = 0;
+  while (count < nof_bytes) {
+    if (!FillWindow()) {
       throw std::runtime_error("End of file detected.");
     }
-  }
+    const size_t bytes = std::min(nof_bytes - count,
+                                  window_size_ - window_index_);
+    std::copy_n(window_ + window_index_, bytes,
+                scratch_buffer_.begin() + static_cast<int64_t>(count));
+    window_index_ += bytes;
+    count += bytes;
+  }
+  data_count_ += nof_bytes;
+  return {scratch_buffer_.data(), nof_bytes};
+}
+
+Span<const uint8_t> ReadCache::GetRecords(size_t record_size,
+                                          uint64_t max_records) {
+  if (window_index_ >= window_size_ && !FillWindow()) {
+    return {};
+  }
+  const uint64_t max_data = (max_data_count_ - data_count_) / record_size;
+  const auto nof_records = static_cast<size_t>(std::min(
+      {static_cast<uint64_t>((window_size_ - window_index_) / record_size),
+       max_records, max_data}));
+  if (nof_records == 0) {
+    return {};
+  }
+  const size_t nof_bytes = nof_records * record_size;
+  const uint8_t* records = window_ + window_index_;
+  window_index_ += nof_bytes;
+  data_count_ += nof_bytes;
+  return {records, nof_bytes};
 }
 
 void ReadCache::SkipBytes(size_t nof_skip) {
-  if (file_index_ + nof_skip <= data_size_) {
-    if (file_buffer_.empty()) {
-      const auto bytes = StepFilePosition(buffer_, nof_skip);
-      if (bytes != nof_skip) {
-        throw std::runtime_error("End of file detected.");
-      }
-    }
-    file_index_ += nof_skip;
-    data_count_ += nof_skip;
+  data_count_ += nof_skip;
+
+  // First skip inside the current window
+  const size_t available = window_size_ - window_index_;
+  if (nof_skip <= available) {
+    window_index_ += nof_skip;
     return;
   }
+  nof_skip -= available;
+  window_index_ = window_size_;
 
-  // First skip the remaining bytes.
-  nof_skip -= data_size_ - file_index_;
-
-  // If a list try to skip block by block first
-  while (block_index_ < block_list_.size()) {
-    file_index_ = 0;
-    data_size_ = 0;
-    auto* current_block = block_list_[block_index_];
-    ++block_index_;
-    if (current_block == nullptr) {
-      break;
+  // Skip the unread part of the current block by moving the file position
+  if (block_remaining_ > 0) {
+    if (nof_skip <= block_remaining_) {
+      StepFilePosition(buffer_, nof_skip);
+      block_remaining_ -= nof_skip;
+      return;
     }
-    data_size_ = current_block->DataSize();
-    if (nof_skip > data_size_) {
-      nof_skip -= data_size_;
-      continue;
-    }
-    // In right block. Set up the file buffer.
-    if (current_block->BlockType() == "DZ") {
-      try {
-        file_buffer_.resize(static_cast<size_t>(data_size_) );
-        uint64_t temp_index = 0;
-        current_block->CopyDataToBuffer(buffer_,file_buffer_, temp_index);
-      } catch (const std::exception&) {
-        break;;
-      }
-    } else {
-      file_buffer_.clear();
-      SetFilePosition(buffer_, current_block->DataPosition());
-    }
-    break;
+    nof_skip -= block_remaining_;
+    block_remaining_ = 0;
   }
-  // Step to the byte inside
-  if (nof_skip > 0) {
-    if (file_buffer_.empty()) {
-      const auto bytes = StepFilePosition(buffer_, nof_skip);
-      if (bytes != nof_skip) {
-        throw std::runtime_error("End of file detected.");
-      }
-    }
-    file_index_ += nof_skip;
-    data_count_ += nof_skip;
-  }
-}
 
-bool ReadCache::SkipByte() {
-  if ( file_index_ < data_size_) {
-    if (file_buffer_.empty()) {
-      const auto nof_bytes = StepFilePosition(buffer_, 1);
-      if (nof_bytes != 1) {
-        return false;
-      }
+  // Skip block by block. Blocks that are skipped entirely are never read
+  // or inflated.
+  while (nof_skip > 0) {
+    if (block_index_ >= block_list_.size()) {
+      throw std::runtime_error("End of file detected.");
     }
-    ++file_index_;
-    ++data_count_;
-    return true;
-  }
-
-  file_index_ = 0;
-  data_size_ = 0;
-  if (block_index_ >= block_list_.size()) {
-    return false;
-  }
-
-  auto* current_block = block_list_[block_index_];
-  ++block_index_;
-  if (current_block == nullptr) {
-    return false;
-  }
-  data_size_ = current_block->DataSize();
-  if (current_block->BlockType() == "DZ") {
-    try {
-      file_buffer_.resize(static_cast<size_t>(data_size_) );
-      uint64_t temp_index = 0;
-      current_block->CopyDataToBuffer(buffer_,file_buffer_, temp_index);
-    } catch (const std::exception&) {
-      return false;
+    const size_t index = block_index_++;
+    const auto* current_block = block_list_[index];
+    if (current_block == nullptr) {
+      throw std::runtime_error("Invalid data block.");
     }
-  } else {
-    file_buffer_.clear();
-    SetFilePosition(buffer_, current_block->DataPosition());
-  }
-
-  if (file_index_ >= data_size_) {
-    return false;
-  }
-  if (file_buffer_.empty()) {
-    const auto reads = StepFilePosition(buffer_, 1);
-    if (reads != 1) {
-      return false;
+    const uint64_t data_size = current_block->DataSize();
+    if (nof_skip >= data_size) {
+      nof_skip -= data_size;
+      continue;
+    }
+    if (!SetupBlockData(index, nof_skip)) {
+      throw std::runtime_error("Failed to read data block.");
     }
+    nof_skip = 0;
   }
-  ++file_index_;
-  ++data_count_;
-  return true;
 }
 
 void ReadCache::SetOffsetFilter(const std::vector<uint64_t> &offset_list) {
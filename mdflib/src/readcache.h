@@ -10,12 +10,17 @@
 #include <set>
 #include <map>
 #include <functional>
+#include <deque>
+#include <future>
 
 #include "dg4block.h"
 #include "dg3block.h"
+#include "dgindex.h"
 
 namespace mdf::detail {
 
+class MappedFileBuf;
+
 class ReadCache {
  public:
   ReadCache() = delete;
@@ -24,6 +29,15 @@ class ReadCache {
   bool ParseRecord();
   bool ParseRangeRecord(DgRange& range);
   bool ParseVlsdCgData();
+  /** \brief Reads the VLSD records in the offset filter.
+   *
+   * The function uses an index to move directly to the nearest VLSD record
+   * before each offset. Offsets close to each other are read without
+   * moving the read position.
+   * @param index VLSD index of the channel group.
+   * @return False if the parsing failed.
+   */
+  bool ParseVlsdCgOffsets(const VlsdIndex& index);
 
   /** \brief Read in all SD data.
    *
@@ -45,6 +59,75 @@ class ReadCache {
    */
   bool ParseSignalDataOffset(uint64_t offset);
 
+  /** \brief Parses a range of records in a sorted data group.
+   *
+   * A sorted data group has one channel group and no record ID, so the
+   * records have a fixed position. The function moves the read position
+   * directly to the first sample and stops after the last sample.
+   * Several read caches may parse different ranges of the same data group in
+   * parallel, if the file is memory mapped.
+   * @param first_sample First sample to parse.
+   * @param nof_samples Number of samples to parse.
+   * @return False if the parsing failed or was aborted by an observer.
+   */
+  bool ParseSortedRecords(uint64_t first_sample, uint64_t nof_samples);
+
+  /** \brief Parses a sample range in a sorted data group.
+   *
+   * The records in a sorted data group have fixed positions. Instead of
+   * parsing and skipping all records before the range, the read position is
+   * moved directly to the first record. The parsing stops after the last
+   * record in the range.
+   * @param range Sample range to read.
+   * @return False if the parsing failed or was aborted by an observer.
+   */
+  bool ParseSortedRange(DgRange& range);
+
+  /** \brief Scans all records and creates a sample index.
+   *
+   * The function parses the record ID and length of each record but no
+   * observers are notified.
+   * @param index Index that the checkpoints are added to.
+   * @return True if all records were scanned.
+   */
+  bool BuildSampleIndex(DgIndex& index);
+  /** \brief Scans all records and creates a VLSD index.
+   *
+   * @param index Index that the checkpoints are added to.
+   * @return True if all records were scanned.
+   */
+  bool BuildVlsdIndex(VlsdIndex& index);
+
+  /** \brief Copies a record of a channel group.
+   *
+   * The function moves the read position to a data offset and parses the
+   * records until the wanted record of the channel group is found. Records
+   * of other channel groups are skipped. Used to probe single records,
+   * for example the master channel value.
+   * @param data_offset Data offset to start at. Must be at a record start.
+   * @param record_id Record ID of the channel group.
+   * @param nof_skip Number of records of the channel group to skip.
+   * @param record Destination of the record bytes (excluding record ID).
+   * @return True if the record was found.
+   */
+  bool ReadRecord(uint64_t data_offset, uint64_t record_id, uint64_t nof_skip,
+                  std::vector<uint8_t>& record);
+
+  /** \brief Returns true if the data group is sorted.
+   *
+   * A sorted data group has one channel group with fixed length records and
+   * no record ID.
+   */
+  [[nodiscard]] bool IsSorted() const;
+
+  /** \brief Moves the read position to an offset in the data.
+   *
+   * The data block is found by the data block offsets, so no data is read
+   * before the new position.
+   * @param data_offset Byte offset from the start of the data.
+   */
+  void SeekData(uint64_t data_offset);
+
   void SetRecordId(uint64_t record_id) {
     record_id_list_.clear();
     record_id_list_.insert(record_id);
@@ -57,36 +140,104 @@ class ReadCache {
 
  void SetCallback(const std::function<void(uint64_t,
    const std::vector<uint8_t>&)>& callback );
+
+  /** \brief Sets the size of the read window.
+   *
+   * Data that isn't memory mapped or decompressed, is read from the stream
+   * buffer in chunks of this size. The size is limited to 1-16 MB.
+   * @param buffer_size Size of the read window in bytes.
+   */
+  void BufferSize(size_t buffer_size);
+  [[nodiscard]] size_t BufferSize() const { return buffer_size_; }
+
+  /** \brief Sets max number of DZ blocks decompressed in parallel.
+   *
+   * Setting it to 0 decompress the DZ blocks in the reading thread. This is
+   * used when the read itself is done by several threads.
+   * @param nof_jobs Max number of decompression jobs.
+   */
+  void MaxInflateJobs(unsigned nof_jobs);
+
+  static constexpr size_t kMinBufferSize = 1'000'000; ///< 1 MB
+  static constexpr size_t kDefaultBufferSize = 4'000'000; ///< 4 MB
+  static constexpr size_t kMaxBufferSize = 16'000'000; ///< 16 MB
+
+  /** \brief Max decompressed bytes that the DZ read-ahead may hold. */
+  static constexpr uint64_t kInflateMemoryBudget = 64'000'000;
+  /** \brief Max number of DZ blocks decompressed in parallel. */
+  static constexpr unsigned kMaxInflateJobs = 16;
  private:
 
   std::streambuf& buffer_;
+  const MappedFileBuf* mapped_buffer_ = nullptr; ///< Set if memory mapped file
   DataListBlock* data_list_ = nullptr; ///< List of data_block example a DL block
   DataBlock* data_block_ = nullptr; ///< A single data block
   Dg4Block* dg4_block_ = nullptr;
 
-  size_t file_index_ = 0;
   std::vector<uint8_t> file_buffer_; // Needs a file buffer to handle the DZ block.
-  uint64_t data_size_ = 0;
+  std::vector<uint8_t> window_buffer_; ///< Chunk read from the stream buffer.
+  std::vector<uint8_t> scratch_buffer_; ///< Records crossing a block edge.
+  size_t buffer_size_ = kDefaultBufferSize;
+
+  /** \brief Current window of data in memory.
+   *
+   * Points into the memory mapped file, the DZ file buffer or the window
+   * buffer.
+   */
+  const uint8_t* window_ = nullptr;
+  size_t window_index_ = 0; ///< Read index in the window.
+  size_t window_size_ = 0; ///< Number of bytes in the window.
+  uint64_t block_remaining_ = 0; ///< Bytes in the block not read into memory.
 
   uint64_t data_count_ = 0;
   uint64_t max_data_count_ = 0;
 
   size_t block_index_ = 0;
   std::vector<DataBlock*> block_list_;
+  std::vector<uint64_t> block_offset_list_; ///< Data offset of each block.
   std::set<uint64_t> record_id_list_;
   std::map<uint64_t, const Cg4Block*> available_cg_list_;
 
+  /** \brief DZ block that is decompressed by a worker thread. */
+  struct InflateJob {
+    size_t block_index = 0;
+    uint64_t data_size = 0; ///< Decompressed size.
+    std::future<std::vector<uint8_t>> data;
+  };
+  /** \brief DZ read-ahead queue in block order.
+   *
+   * The next DZ blocks are decompressed by worker threads while the current
+   * block is parsed. The number of jobs and the decompressed bytes in
+   * flight are limited.
+   */
+  std::deque<InflateJob> inflate_queue_;
+  unsigned max_inflate_jobs_ = 0; ///< 0 = Decompress in this thread.
+  size_t next_inflate_index_ = 0; ///< Next block to schedule.
+  uint64_t inflate_bytes_ = 0; ///< Decompressed bytes in flight.
+
   uint64_t offset_ = 0;
   std::set<uint64_t> offset_filter_;
   std::function<void(uint64_t, const std::vector<uint8_t>&)> callback_;
 
   uint64_t ParseRecordId();
-  bool GetNextByte(uint8_t& input);
-  void GetArray(std::vector<uint8_t>& buffer);
+  /** \brief Returns a view of the next record bytes.
+   *
+   * The view points into the current window if possible, otherwise the
+   * bytes are stitched together in the scratch buffer. The view is valid
+   * until the next read.
+   * @param nof_bytes Number of bytes to read.
+   * @return View of the record bytes.
+   */
+  Span<const uint8_t> GetRecord(size_t nof_bytes);
+  Span<const uint8_t> GetRecords(size_t record_size, uint64_t max_records);
   void SkipBytes(size_t nof_skip);
-   bool SkipByte();
+  bool SetupBlockData(size_t index, uint64_t offset);
+  bool FillWindow();
+
+  void InitInflatePipeline();
+  void ScheduleInflate();
+  std::vector<uint8_t> GetInflatedBlock(size_t index);
 };
 
 
 } // End namespace mdf::detail
-
@@ -73,17 +73,17 @@ void Si4Block::GetBlockProperty(BlockPropertyList &dest) const {
   MdfBlock::GetBlockProperty(dest);
 
   dest.emplace_back("Links", "", "", BlockItemType::HeaderItem);
-  dest.emplace_back("Name TX", ToHexString(Link(kIndexName)), name_,
+  dest.emplace_back("Name TX", ToHexString(Link(kIndexName)), Name(),
                     BlockItemType::LinkItem);
-  dest.emplace_back("Path TX", ToHexString(Link(kIndexPath)), path_,
+  dest.emplace_back("Path TX", ToHexString(Link(kIndexPath)), Path(),
                     BlockItemType::LinkItem);
   dest.emplace_back("Comment MD", ToHexString(Link(kIndexMd)), Comment(),
                     BlockItemType::LinkItem);
   dest.emplace_back("", "", "", BlockItemType::BlankItem);
 
   dest.emplace_back("Information", "", "", BlockItemType::HeaderItem);
-  dest.emplace_back("Name", name_);
-  dest.emplace_back("Path", path_);
+  dest.emplace_back("Name", Name());
+  dest.emplace_back("Path", Path());
   dest.emplace_back("Source Type", MakeSourceTypeString(type_));
   dest.emplace_back("Bus Type", MakeBusTypeString(bus_type_));
   dest.emplace_back("Flags", MakeFlagString(flags_));
@@ -100,8 +100,8 @@ uint64_t Si4Block::Read(std::streambuf& buffer) {
   bytes += ReadNumber(buffer, flags_);
   std::vector<uint8_t> reserved;
   bytes += ReadByte(buffer, reserved, 5);
-  name_ = ReadTx4(buffer, kIndexName);
-  path_ = ReadTx4(buffer, kIndexPath);
+  name_ = ReadPoolTx4(buffer, kIndexName);
+  path_ = ReadPoolTx4(buffer, kIndexPath);
   ReadMdComment(buffer, kIndexMd);
   return bytes;
 }
@@ -115,8 +115,8 @@ uint64_t Si4Block::Write(std::streambuf& buffer) {
   block_type_ = "##SI";
   block_length_ = 24 + (3 * 8) + 1 + 1 + 1 + 5;
   link_list_.resize(3, 0);
-  WriteTx4(buffer, kIndexName, name_);
-  WriteTx4(buffer, kIndexPath, path_);
+  WriteTx4(buffer, kIndexName, Name());
+  WriteTx4(buffer, kIndexPath, Path());
   WriteMdComment(buffer, kIndexMd);
 
   uint64_t bytes = MdfBlock::Write(buffer);
@@ -130,13 +130,13 @@ uint64_t Si4Block::Write(std::streambuf& buffer) {
 
 int64_t Si4Block::Index() const { return FilePosition(); }
 
-void Si4Block::Name(const std::string &name) { name_ = name; }
+void Si4Block::Name(const std::string &name) { name_ = MakePoolString(name); }
 
-const std::string &Si4Block::Name() const { return name_; }
+const std::string &Si4Block::Name() const { return ToStringRef(name_); }
 
-void Si4Block::Path(const std::string &path) { path_ = path; }
+void Si4Block::Path(const std::string &path) { path_ = MakePoolString(path); }
 
-const std::string &Si4Block::Path() const { return path_; }
+const std::string &Si4Block::Path() const { return ToStringRef(path_); }
 
 void Si4Block::Description(const std::string &desc) {
   auto *metadata = CreateMetaData();
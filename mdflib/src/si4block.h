@@ -45,7 +45,7 @@ class Si4Block : public MdfBlock, public ISourceInformation {
   uint8_t bus_type_ = 0;
   uint8_t flags_ = 0;
   /* 5 byte reserved */
-  std::string name_;
-  std::string path_;
+  PoolString name_;
+  PoolString path_;
 };
 }  // namespace mdf::detail
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "signaldataindex.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "datablock.h"
+#include "datalistblock.h"
+#include "dz4block.h"
+#include "mappedfilebuf.h"
+
+namespace mdf::detail {
+
+void SignalDataIndex::Create(const DataListBlock& data_list,
+                             std::streambuf& buffer) {
+  Clear();
+  std::vector<DataBlock*> block_list;
+  data_list.GetDataBlockList(block_list);
+  for (const auto* block : block_list) {
+    const uint64_t size = block != nullptr ? block->DataSize() : 0;
+    if (size == 0) {
+      continue;
+    }
+    segment_list_.push_back({data_size_, block});
+    data_size_ += size;
+  }
+  buffer_ = &buffer;
+  mapped_buffer_ = dynamic_cast<const MappedFileBuf*>(&buffer);
+}
+
+void SignalDataIndex::Clear() {
+  std::lock_guard lock(cache_mutex_);
+  segment_list_.clear();
+  data_size_ = 0;
+  buffer_ = nullptr;
+  mapped_buffer_ = nullptr;
+  inflated_block_ = nullptr;
+  inflated_data_.clear();
+  inflated_data_.shrink_to_fit();
+  window_block_ = nullptr;
+  window_offset_ = 0;
+  window_.clear();
+  window_.shrink_to_fit();
+}
+
+bool SignalDataIndex::Read(uint64_t offset, uint8_t* dest,
+                           uint64_t nof_bytes) const {
+  if (buffer_ == nullptr || offset > data_size_ ||
+      nof_bytes > data_size_ - offset) {
+    return false;
+  }
+  // The last block that starts at or before the offset.
+  const auto itr = std::upper_bound(segment_list_.cbegin(),
+      segment_list_.cend(), offset, [] (uint64_t value, const Segment& seg) {
+    return value < seg.Offset;
+  });
+  if (itr == segment_list_.cbegin()) {
+    return false;
+  }
+  for (auto index = static_cast<size_t>(itr - segment_list_.cbegin()) - 1;
+       nof_bytes > 0 && index < segment_list_.size(); ++index) {
+    // A value may continue in the next block.
+    const auto& segment = segment_list_[index];
+    const uint64_t block_offset = offset - segment.Offset;
+    const uint64_t count = std::min(nof_bytes,
+        segment.Block->DataSize() - block_offset);
+    if (!ReadBlock(*segment.Block, block_offset, dest, count)) {
+      return false;
+    }
+    offset += count;
+    dest += count;
+    nof_bytes -= count;
+  }
+  return nof_bytes == 0;
+}
+
+bool SignalDataIndex::ReadBlock(const DataBlock& block, uint64_t block_offset,
+                                uint8_t* dest, uint64_t nof_bytes) const {
+  const auto* dz_block = dynamic_cast<const Dz4Block*>(&block);
+  if (dz_block == nullptr && mapped_buffer_ != nullptr) {
+    const uint8_t* data = mapped_buffer_->Data(
+        block.DataPosition() + static_cast<int64_t>(block_offset), nof_bytes);
+    if (data == nullptr) {
+      return false;
+    }
+    memcpy(dest, data, static_cast<size_t>(nof_bytes));
+    return true;
+  }
+
+  std::lock_guard lock(cache_mutex_);
+  if (dz_block != nullptr) {
+    if (inflated_block_ != dz_block) {
+      inflated_block_ = nullptr;
+      std::vector<uint8_t> compressed;
+      const int64_t position = GetFilePosition(*buffer_);
+      dz_block->ReadCompressedData(*buffer_, compressed);
+      SetFilePosition(*buffer_, position);
+      if (!dz_block->InflateData(compressed, inflated_data_)) {
+        return false;
+      }
+      inflated_block_ = dz_block;
+    }
+    if (block_offset + nof_bytes > inflated_data_.size()) {
+      return false;
+    }
+    memcpy(dest, inflated_data_.data() + block_offset,
+           static_cast<size_t>(nof_bytes));
+    return true;
+  }
+
+  // Read a window starting at the offset, unless the bytes are in the
+  // current window.
+  if (window_block_ != &block || block_offset < window_offset_ ||
+      block_offset + nof_bytes > window_offset_ + window_.size()) {
+    window_block_ = nullptr;
+    const uint64_t window_size = std::min(block.DataSize() - block_offset,
+                                          std::max(nof_bytes, kWindowSize));
+    window_.resize(static_cast<size_t>(window_size));
+    const int64_t position = GetFilePosition(*buffer_);
+    SetFilePosition(*buffer_,
+                    block.DataPosition() + static_cast<int64_t>(block_offset));
+    const auto reads = buffer_->sgetn(reinterpret_cast<char*>(window_.data()),
+                                      static_cast<std::streamsize>(window_size));
+    SetFilePosition(*buffer_, position);
+    if (reads != static_cast<std::streamsize>(window_size)) {
+      return false;
+    }
+    window_block_ = &block;
+    window_offset_ = block_offset;
+  }
+  memcpy(dest, window_.data() + (block_offset - window_offset_),
+         static_cast<size_t>(nof_bytes));
+  return true;
+}
+
+}  // namespace mdf::detail
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+/** \file
+ * This file defines the on-demand access to the signal data of a channel.
+ */
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <streambuf>
+#include <vector>
+
+namespace mdf::detail {
+
+class DataBlock;
+class DataListBlock;
+class Dz4Block;
+class MappedFileBuf;
+
+/** \brief Offset index of the signal data (SD) of a VLSD channel.
+ *
+ * A VLSD channel stores an offset into its signal data in each record. The
+ * signal data may be one SD or DZ block or a list (DL/HL) of such blocks.
+ * Instead of reading all signal data into memory, the index holds the
+ * offset of each data block, so a value can be read on demand when a
+ * record is parsed.
+ *
+ * Memory mapped SD blocks are copied directly from the mapping. Other SD
+ * blocks are read through a small read window as the offsets normally
+ * increases. The last decompressed DZ block is kept in memory. The stream
+ * buffer position is restored after each read, so the index may be used
+ * while the records are read from the same stream buffer.
+ */
+class SignalDataIndex final {
+ public:
+  /** \brief Size of the read window of uncompressed blocks. */
+  static constexpr uint64_t kWindowSize = 65'536;
+
+  /** \brief Creates the index.
+   *
+   * @param data_list Block list with the signal data blocks.
+   * @param buffer Stream buffer. Must be valid until Clear() is called.
+   */
+  void Create(const DataListBlock& data_list, std::streambuf& buffer);
+
+  /** \brief Removes the index and any cached data. */
+  void Clear();
+
+  [[nodiscard]] bool IsCreated() const { return buffer_ != nullptr; }
+
+  /** \brief Returns the total number of signal data bytes. */
+  [[nodiscard]] uint64_t DataSize() const { return data_size_; }
+
+  /** \brief Copies signal data bytes.
+   *
+   * @param offset Offset into the signal data.
+   * @param dest Destination buffer.
+   * @param nof_bytes Number of bytes to copy.
+   * @return False if the bytes couldn't be read.
+   */
+  bool Read(uint64_t offset, uint8_t* dest, uint64_t nof_bytes) const;
+
+ private:
+  struct Segment {
+    uint64_t Offset = 0; ///< Signal data offset of the block.
+    const DataBlock* Block = nullptr;
+  };
+  std::vector<Segment> segment_list_;
+  uint64_t data_size_ = 0;
+  std::streambuf* buffer_ = nullptr;
+  const MappedFileBuf* mapped_buffer_ = nullptr;
+
+  mutable std::mutex cache_mutex_; ///< Protects the stream buffer and cache.
+  mutable const Dz4Block* inflated_block_ = nullptr;
+  mutable std::vector<uint8_t> inflated_data_; ///< Decompressed DZ block.
+  mutable const DataBlock* window_block_ = nullptr;
+  mutable uint64_t window_offset_ = 0; ///< Block offset of the window.
+  mutable std::vector<uint8_t> window_; ///< Read window of an SD block.
+
+  bool ReadBlock(const DataBlock& block, uint64_t block_offset,
+                 uint8_t* dest, uint64_t nof_bytes) const;
+};
+
+}  // namespace mdf::detail
@@ -0,0 +1,30 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+/** \file
+ * This file defines the macros used by the SIMD kernels. The kernels are
+ * selected at run-time, so the library doesn't need to be built for a
+ * specific CPU.
+ */
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+#define MDF_X86_SIMD 1
+#if (_MSC_VER)
+#include <intrin.h>
+#endif
+#include <immintrin.h>
+#else
+#define MDF_X86_SIMD 0
+#endif
+
+// GCC and Clang need the instruction set enabled per function, while MSVC
+// always allows the intrinsics.
+#if defined(__GNUC__) || defined(__clang__)
+#define MDF_TARGET(isa) __attribute__((target(isa)))
+#else
+#define MDF_TARGET(isa)
+#endif
@@ -0,0 +1,27 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "stringpool.h"
+
+namespace mdf::detail {
+
+const std::string& ToStringRef(const PoolString& text) {
+  static const std::string kEmpty;
+  return text ? *text : kEmpty;
+}
+
+PoolString StringPool::Intern(std::string_view text) {
+  if (text.empty()) {
+    return {};
+  }
+  if (const auto itr = string_list_.find(text); itr != string_list_.cend()) {
+    return itr->second;
+  }
+  auto shared = std::make_shared<const std::string>(text);
+  string_list_.emplace(std::string_view(*shared), shared);
+  return shared;
+}
+
+}  // namespace mdf::detail
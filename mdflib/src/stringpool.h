@@ -0,0 +1,54 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+/** \file
+ * This file defines the shared storage of the texts in a file.
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace mdf::detail {
+
+/** \brief Shared text. A null pointer is an empty text. */
+using PoolString = std::shared_ptr<const std::string>;
+
+/** \brief Returns a view of a shared text. */
+[[nodiscard]] inline std::string_view ToStringView(const PoolString& text) {
+  return text ? std::string_view(*text) : std::string_view();
+}
+
+/** \brief Returns a reference to a shared text or an empty string. */
+[[nodiscard]] const std::string& ToStringRef(const PoolString& text);
+
+/** \brief Interned texts of a file.
+ *
+ * Channel and source names repeat heavily in bus logger files, where
+ * thousands of channel groups have the same channel names. The pool holds
+ * one copy of each text, so the blocks share the storage of equal texts.
+ * TX blocks that are referenced by many blocks also resolve to one text.
+ *
+ * The texts are shared pointers, so a text is valid even if it is copied to
+ * a block in another file. The pool is owned by the header block. Note that
+ * the pool isn't thread-safe, same as the rest of the block tree.
+ */
+class StringPool final {
+ public:
+  /** \brief Returns the shared copy of a text. */
+  [[nodiscard]] PoolString Intern(std::string_view text);
+
+  /** \brief Returns number of unique texts. */
+  [[nodiscard]] size_t Size() const { return string_list_.size(); }
+
+ private:
+  /** \brief The key is a view of the shared text. */
+  std::unordered_map<std::string_view, PoolString> string_list_;
+};
+
+}  // namespace mdf::detail
@@ -21,7 +21,7 @@ class Tx4Block : public MdfBlock {
   uint64_t Read(std::streambuf& buffer) override;
   uint64_t Write(std::streambuf& buffer) override;
 
-  void Text(const std::string& text) {text_ = text;}
+  virtual void Text(const std::string& text) {text_ = text;}
   [[nodiscard]] std::string Text() const;
   [[nodiscard]] virtual std::string TxComment() const;
 
@@ -7,6 +7,8 @@
 
 #include <filesystem>
 #include <algorithm>
+#include <fstream>
+#include <map>
 #include <ranges>
 
 #include "util/logconfig.h"
@@ -60,6 +62,156 @@ void NoLog(const MdfLocation& location, mdf::MdfLogSeverity severity ,
            const std::string& text) {
 }
 
+void AppendNumber(std::vector<uint8_t>& dest, uint64_t value,
+                  size_t nof_bytes) {
+  for (size_t byte = 0; byte < nof_bytes; ++byte) {
+    dest.push_back(static_cast<uint8_t>(value >> (8 * byte)));
+  }
+}
+
+uint64_t GetNumber(const std::vector<uint8_t>& source, uint64_t position) {
+  uint64_t value = 0;
+  for (size_t byte = 0; byte < 8; ++byte) {
+    value |= static_cast<uint64_t>(source[position + byte]) << (8 * byte);
+  }
+  return value;
+}
+
+void SetNumber(std::vector<uint8_t>& dest, uint64_t position, uint64_t value) {
+  for (size_t byte = 0; byte < 8; ++byte) {
+    dest[position + byte] = static_cast<uint8_t>(value >> (8 * byte));
+  }
+}
+
+/**
+ * Appends an MDF4 block header at the next 8-byte boundary.
+ * @param file File bytes
+ * @param type Block type (DT or DL)
+ * @param length Block length including the header
+ * @param nof_links Number of links
+ * @return File position of the block
+ */
+uint64_t AppendBlockHeader(std::vector<uint8_t>& file, const std::string& type,
+                           uint64_t length, uint64_t nof_links) {
+  file.resize((file.size() + 7) / 8 * 8, 0);
+  const uint64_t position = file.size();
+  file.push_back('#');
+  file.push_back('#');
+  file.insert(file.end(), type.cbegin(), type.cend());
+  AppendNumber(file, 0, 4);
+  AppendNumber(file, length, 8);
+  AppendNumber(file, nof_links, 8);
+  return position;
+}
+
+/**
+ * Appends a DL block that references a list of DT blocks.
+ * @param file File bytes
+ * @param next_dl Position of the next DL block or 0
+ * @param dt_list Position and data offset of each DT block
+ * @return File position of the DL block
+ */
+uint64_t AppendDataList(std::vector<uint8_t>& file, uint64_t next_dl,
+    const std::vector<std::pair<uint64_t, uint64_t>>& dt_list) {
+  const uint64_t nof_blocks = dt_list.size();
+  const uint64_t length = 24 + (8 * (nof_blocks + 1)) + 8 + (8 * nof_blocks);
+  const uint64_t position = AppendBlockHeader(file, "DL", length,
+                                              nof_blocks + 1);
+  AppendNumber(file, next_dl, 8);
+  for (const auto& [dt_position, data_offset] : dt_list) {
+    AppendNumber(file, dt_position, 8);
+  }
+  AppendNumber(file, 0, 4); // Flags and reserved
+  AppendNumber(file, nof_blocks, 4);
+  for (const auto& [dt_position, data_offset] : dt_list) {
+    AppendNumber(file, data_offset, 8);
+  }
+  return position;
+}
+
+/**
+ * Moves the data of the first data group into DT blocks of the sizes in
+ * the size list. The DT blocks are referenced by two chained DL blocks.
+ * @param filename MDF4 file with one DT block in the first data group
+ * @param size_list The DT block sizes are taken from this list in turn
+ * @param nof_blocks Number of created DT blocks
+ */
+void SplitDataBlock(const std::string& filename,
+                    const std::vector<uint64_t>& size_list,
+                    size_t& nof_blocks) {
+  std::vector<uint8_t> file;
+  {
+    std::ifstream input(filename, std::ios_base::binary);
+    ASSERT_TRUE(input.is_open()) << filename;
+    file.assign(std::istreambuf_iterator<char>(input),
+                std::istreambuf_iterator<char>());
+  }
+  // The HD block is at position 64 and its first link is the first DG block.
+  // The third link in the DG block is the data link.
+  const uint64_t dg_position = GetNumber(file, 64 + 24);
+  const uint64_t data_link = dg_position + 24 + 16;
+  const uint64_t dt_position = GetNumber(file, data_link);
+  ASSERT_EQ(std::string(file.cbegin() + dt_position,
+                        file.cbegin() + dt_position + 4), "##DT");
+  const uint64_t data_size = GetNumber(file, dt_position + 8) - 24;
+  const std::vector<uint8_t> data(file.cbegin() + dt_position + 24,
+      file.cbegin() + dt_position + 24 + data_size);
+
+  std::vector<std::pair<uint64_t, uint64_t>> dt_list;
+  for (uint64_t offset = 0; offset < data.size(); /* No increment */) {
+    const auto size = std::min(size_list[dt_list.size() % size_list.size()],
+                               data.size() - offset);
+    const uint64_t position = AppendBlockHeader(file, "DT", 24 + size, 0);
+    file.insert(file.end(), data.cbegin() + offset,
+                data.cbegin() + offset + size);
+    dt_list.emplace_back(position, offset);
+    offset += size;
+  }
+  nof_blocks = dt_list.size();
+
+  const auto middle = dt_list.cbegin() + (dt_list.size() / 2);
+  const uint64_t last_dl = AppendDataList(file, 0,
+      std::vector<std::pair<uint64_t, uint64_t>>(middle, dt_list.cend()));
+  const uint64_t first_dl = AppendDataList(file, last_dl,
+      std::vector<std::pair<uint64_t, uint64_t>>(dt_list.cbegin(), middle));
+  SetNumber(file, data_link, first_dl);
+
+  std::ofstream output(filename, std::ios_base::binary |
+                                 std::ios_base::trunc);
+  output.write(reinterpret_cast<const char*>(file.data()),
+               static_cast<std::streamsize>(file.size()));
+}
+
+/**
+ * Reads all channel values of the last data group as text.
+ * @param reader Reader to use
+ * @return List with one text for each channel value.
+ */
+std::vector<std::string> ReadValueList(mdf::MdfReader& reader) {
+  using namespace mdf;
+  std::vector<std::string> value_list;
+  if (!reader.ReadEverythingButData()) {
+    return value_list;
+  }
+  auto* dg4 = reader.GetFile()->Header()->LastDataGroup();
+  if (dg4 == nullptr) {
+    return value_list;
+  }
+  ChannelObserverList observer_list;
+  CreateChannelObserverForDataGroup(*dg4, observer_list);
+  if (!reader.ReadData(*dg4)) {
+    return value_list;
+  }
+  reader.Close();
+  for (const auto& observer : observer_list) {
+    for (uint64_t sample = 0; sample < observer->NofSamples(); ++sample) {
+      value_list.emplace_back(observer->Name() + ": " +
+                              observer->EngValueToString(sample));
+    }
+  }
+  return value_list;
+}
+
 }
 
 namespace mdf::test {
@@ -469,6 +621,164 @@ TEST_F(TestBusLogger, Mdf4VlsdCanConfig) {
   EXPECT_TRUE(sample_valid);
 }
 
+TEST_F(TestBusLogger, Mdf4VlsdCgOffsets) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+  constexpr size_t max_samples = 100'000;
+  path mdf_file(kTestDir);
+  mdf_file.append("can_vlsd_offsets.mf4");
+
+  auto writer = MdfFactory::CreateMdfWriter(MdfWriterType::MdfBusLogger);
+  writer->Init(mdf_file.string());
+  writer->BusType(MdfBusType::CAN);
+  writer->StorageType(MdfStorageType::VlsdStorage);
+  writer->MaxLength(20);
+  EXPECT_TRUE(writer->CreateBusLogConfiguration());
+  writer->PreTrigTime(0.0);
+  writer->CompressData(false);
+  auto* last_dg = writer->Header()->LastDataGroup();
+  ASSERT_TRUE(last_dg != nullptr);
+  auto* can_data_frame = last_dg->GetChannelGroup("CAN_DataFrame");
+  auto* can_remote_frame = last_dg->GetChannelGroup("CAN_RemoteFrame");
+  ASSERT_TRUE(can_data_frame != nullptr);
+  ASSERT_TRUE(can_remote_frame != nullptr);
+
+  writer->InitMeasurement();
+  auto tick_time = TimeStampToNs();
+  writer->StartMeasurement(tick_time);
+  for (size_t sample = 0; sample < max_samples; ++sample) {
+    std::vector<uint8_t> data;
+    data.assign(sample % 8 + 1, static_cast<uint8_t>(sample));
+    CanMessage msg;
+    msg.BusChannel(11);
+    msg.MessageId(123);
+    msg.DataBytes(data);
+    writer->SaveCanMessage(*can_data_frame, tick_time, msg);
+    writer->SaveCanMessage(*can_remote_frame, tick_time, msg);
+    tick_time += 1'000'000;
+  }
+  writer->StopMeasurement(tick_time);
+  writer->FinalizeMeasurement();
+
+  MdfReader reader(mdf_file.string());
+  ASSERT_TRUE(reader.ReadEverythingButData());
+  auto* dg4 = reader.GetFile()->Header()->LastDataGroup();
+  ASSERT_TRUE(dg4 != nullptr);
+  const auto* cg4 = dg4->GetChannelGroup("CAN_DataFrame");
+  ASSERT_TRUE(cg4 != nullptr);
+  const auto* data_bytes = cg4->GetChannel("CAN_DataFrame.DataBytes");
+  ASSERT_TRUE(data_bytes != nullptr);
+
+  auto observer = CreateChannelObserver(*dg4, *cg4, *data_bytes);
+  observer->ReadVlsdData(false);
+  EXPECT_TRUE(reader.ReadData(*dg4));
+  const auto offset_list = observer->GetOffsetList();
+  ASSERT_EQ(offset_list.size(), max_samples);
+
+  // Read a few spread out offsets and some offsets close to each other.
+  std::vector<uint64_t> sample_list = {99'999, 10, 11, 12, 50'000, 0};
+  std::vector<uint64_t> read_list;
+  std::map<uint64_t, std::vector<uint8_t>> value_list;
+  for (const auto sample : sample_list) {
+    read_list.push_back(offset_list[sample]);
+  }
+  std::function callback = [&](uint64_t offset,
+                               const std::vector<uint8_t>& buffer) {
+    value_list.emplace(offset, buffer);
+  };
+  EXPECT_TRUE(reader.ReadVlsdData(*dg4, *const_cast<IChannel*>(data_bytes),
+                                  read_list, callback));
+  ASSERT_EQ(value_list.size(), sample_list.size());
+  for (const auto sample : sample_list) {
+    const auto itr = value_list.find(offset_list[sample]);
+    ASSERT_TRUE(itr != value_list.cend());
+    std::vector<uint8_t> reference_data;
+    reference_data.assign(sample % 8 + 1, static_cast<uint8_t>(sample));
+    EXPECT_EQ(itr->second, reference_data) << "Sample: " << sample;
+  }
+  reader.Close();
+}
+
+TEST_F(TestBusLogger, Mdf4VlsdBlockEdges) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+  constexpr size_t max_samples = 50'000;
+  path mdf_file(kTestDir);
+  mdf_file.append("can_vlsd_edges.mf4");
+
+  auto writer = MdfFactory::CreateMdfWriter(MdfWriterType::MdfBusLogger);
+  writer->Init(mdf_file.string());
+  writer->BusType(MdfBusType::CAN);
+  writer->StorageType(MdfStorageType::VlsdStorage);
+  writer->MaxLength(20);
+  EXPECT_TRUE(writer->CreateBusLogConfiguration());
+  writer->PreTrigTime(0.0);
+  writer->CompressData(false);
+  auto* last_dg = writer->Header()->LastDataGroup();
+  ASSERT_TRUE(last_dg != nullptr);
+  auto* can_data_frame = last_dg->GetChannelGroup("CAN_DataFrame");
+  auto* can_remote_frame = last_dg->GetChannelGroup("CAN_RemoteFrame");
+  ASSERT_TRUE(can_data_frame != nullptr);
+  ASSERT_TRUE(can_remote_frame != nullptr);
+
+  writer->InitMeasurement();
+  auto tick_time = TimeStampToNs();
+  writer->StartMeasurement(tick_time);
+  for (size_t sample = 0; sample < max_samples; ++sample) {
+    std::vector<uint8_t> data;
+    data.assign(sample % 8 + 1, static_cast<uint8_t>(sample));
+    CanMessage msg;
+    msg.BusChannel(11);
+    msg.MessageId(123);
+    msg.DataBytes(data);
+    writer->SaveCanMessage(*can_data_frame, tick_time, msg);
+    writer->SaveCanMessage(*can_remote_frame, tick_time, msg);
+    tick_time += 1'000'000;
+  }
+  writer->StopMeasurement(tick_time);
+  writer->FinalizeMeasurement();
+
+  std::vector<std::string> reference_list;
+  {
+    MdfReader reader(mdf_file.string());
+    reference_list = ReadValueList(reader);
+  }
+  ASSERT_FALSE(reference_list.empty());
+
+  // Tiny DT blocks split the record IDs, the VLSD length prefixes and the
+  // records. The large blocks are bigger than the read window.
+  size_t nof_blocks = 0;
+  SplitDataBlock(mdf_file.string(),
+      {1, 2, 3, 4, 5, 7, 11, 13, 29, 64, 101, 250'007, 3, 1'100'003},
+      nof_blocks);
+  EXPECT_GT(nof_blocks, 20);
+
+  {
+    // Memory mapped file
+    MdfReader reader(mdf_file.string());
+    const auto value_list = ReadValueList(reader);
+    ASSERT_EQ(value_list.size(), reference_list.size());
+    for (size_t index = 0; index < value_list.size(); ++index) {
+      ASSERT_EQ(value_list[index], reference_list[index]) << index;
+    }
+  }
+  {
+    // Stream buffer with the smallest read window
+    auto buffer = std::make_shared<std::filebuf>();
+    ASSERT_TRUE(buffer->open(mdf_file.string(),
+                             std::ios_base::in | std::ios_base::binary));
+    MdfReader reader(buffer);
+    reader.ReadBufferSize(1'000'000);
+    const auto value_list = ReadValueList(reader);
+    ASSERT_EQ(value_list.size(), reference_list.size());
+    for (size_t index = 0; index < value_list.size(); ++index) {
+      ASSERT_EQ(value_list[index], reference_list[index]) << index;
+    }
+  }
+}
+
 TEST_F(TestBusLogger, Mdf4MlsdCanConfig) {
   if (kSkipTest) {
     GTEST_SKIP();
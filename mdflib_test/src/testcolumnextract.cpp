@@ -0,0 +1,92 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "columnextract.h"
+
+using namespace mdf::detail;
+
+namespace {
+
+constexpr uint8_t kGuardByte = 0xA5;
+
+/** \brief Reference extraction. Copies the value bytes one by one. */
+std::vector<uint8_t> ExtractColumn(const uint8_t* value, size_t value_size,
+                                   size_t record_size, size_t nof_records,
+                                   bool swap_bytes) {
+  std::vector<uint8_t> column(nof_records * value_size, 0);
+  for (size_t record = 0; record < nof_records; ++record) {
+    const uint8_t* source = value + (record * record_size);
+    uint8_t* dest = column.data() + (record * value_size);
+    for (size_t byte = 0; byte < value_size; ++byte) {
+      dest[byte] = swap_bytes ? source[value_size - 1 - byte] : source[byte];
+    }
+  }
+  return column;
+}
+
+}  // namespace
+
+namespace mdf::test {
+
+TEST(TestColumnExtract, KernelsMatchReference) {
+  const SimdLevel cpu_level = DetectSimdLevel();
+
+  // Random record bytes. The data starts on an odd address, so none of the
+  // values are aligned.
+  std::mt19937 generator(4711);
+  std::uniform_int_distribution<int> distribution(0, 255);
+  std::vector<uint8_t> data(64 * 1025 + 16);
+  std::generate(data.begin(), data.end(), [&] () {
+    return static_cast<uint8_t>(distribution(generator));
+  });
+  const uint8_t* records = data.data() + 1;
+
+  for (const SimdLevel level :
+       {SimdLevel::None, SimdLevel::Sse41, SimdLevel::Avx2}) {
+    if (static_cast<int>(level) > static_cast<int>(cpu_level)) {
+      continue; // The CPU doesn't support the instruction set.
+    }
+    for (const size_t value_size : {1, 2, 4, 8}) {
+      for (const bool swap_bytes : {false, true}) {
+        const auto kernel = SelectColumnKernel(value_size, swap_bytes, level);
+        ASSERT_TRUE(kernel != nullptr) << value_size;
+        for (const size_t record_size : {value_size, value_size + 1,
+                                         size_t{13}, size_t{31}, size_t{64}}) {
+          for (size_t offset = 0; offset + value_size <= record_size &&
+               offset < 4; ++offset) {
+            for (const size_t nof_records : {0, 1, 3, 7, 8, 9, 31, 33, 1025}) {
+              const auto expected = ExtractColumn(records + offset, value_size,
+                  record_size, nof_records, swap_bytes);
+              // The guard bytes detect writes beyond the last value.
+              std::vector<uint8_t> column(expected.size() + 16, kGuardByte);
+              kernel(records + offset, record_size, nof_records,
+                     column.data());
+              EXPECT_EQ(std::memcmp(column.data(), expected.data(),
+                                    expected.size()), 0)
+                  << "Level: " << static_cast<int>(level)
+                  << ", Size: " << value_size << ", Swap: " << swap_bytes
+                  << ", Record Size: " << record_size
+                  << ", Offset: " << offset << ", Records: " << nof_records;
+              EXPECT_TRUE(std::all_of(column.cbegin() + expected.size(),
+                                      column.cend(), [] (uint8_t byte) {
+                return byte == kGuardByte;
+              }));
+            }
+          }
+        }
+      }
+    }
+  }
+
+  EXPECT_TRUE(SelectColumnKernel(3, false) == nullptr);
+}
+
+}  // namespace mdf::test
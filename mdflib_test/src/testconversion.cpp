@@ -0,0 +1,307 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+#include <cmath>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cc4block.h"
+#include "convertkernel.h"
+#include "mdf/idatagroup.h"
+#include "mdf/ichannelgroup.h"
+#include "mdf/mdffactory.h"
+#include "mdf/mdfreader.h"
+#include "mdf/mdfwriter.h"
+#include "mdf/mdfhelper.h"
+
+using namespace mdf::detail;
+
+namespace {
+
+std::vector<double> TestValues() {
+  std::vector<double> values;
+  for (int value = -500; value <= 500; ++value) {
+    values.push_back(value * 0.25);
+  }
+  return values;
+}
+
+}  // namespace
+
+namespace mdf::test {
+
+TEST(TestConversion, ConvertBatch) {
+  const auto in = TestValues();
+  const std::vector<std::pair<ConversionType, std::vector<double>>> list = {
+      {ConversionType::Linear, {1.5, 0.25}},
+      {ConversionType::Linear, {3.0}},
+      {ConversionType::Rational, {1, 2, 3, 0, 1, -5}},
+      {ConversionType::Polynomial, {2, 3, 0.5, 1, 4, 1}},
+      {ConversionType::Logarithmic, {0, 3, 2, 1, 0.5, 1, 7}},
+      {ConversionType::Exponential, {1, 3, 2, 0, 0.5, 0.01, 7}},
+      {ConversionType::ValueToValue, {1, 10, 2, 20, 3, 30, 0}},
+  };
+  for (const auto& [type, parameters] : list) {
+    Cc4Block cc;
+    cc.Type(type);
+    for (size_t index = 0; index < parameters.size(); ++index) {
+      cc.Parameter(static_cast<uint16_t>(index), parameters[index]);
+    }
+    std::vector<double> out(in.size(), 0.0);
+    std::vector<uint8_t> valid(in.size(), 0);
+    const bool all_valid = cc.ConvertBatch(Span<const double>(in),
+                                           Span<double>(out),
+                                           Span<uint8_t>(valid));
+    bool expected_all_valid = true;
+    for (size_t index = 0; index < in.size(); ++index) {
+      double eng_value = 0.0;
+      const bool expected_valid = cc.Convert(in[index], eng_value);
+      expected_all_valid = expected_all_valid && expected_valid;
+      EXPECT_EQ(valid[index] != 0, expected_valid) << in[index];
+      if (std::isnan(eng_value)) {
+        EXPECT_TRUE(std::isnan(out[index]));
+      } else {
+        EXPECT_EQ(out[index], eng_value) << in[index];
+      }
+    }
+    EXPECT_EQ(all_valid, expected_all_valid);
+  }
+}
+
+TEST(TestConversion, ConvertKernels) {
+  const auto in = TestValues();
+  const double par[7] = {1, 2, 3, 0, 1, -5, 0};
+  const auto& scalar = SelectConvertKernels(SimdLevel::None);
+  for (auto level : {SimdLevel::Sse41, SimdLevel::Avx2}) {
+    if (static_cast<int>(level) > static_cast<int>(DetectSimdLevel())) {
+      continue;
+    }
+    const auto& kernels = SelectConvertKernels(level);
+    std::vector<double> out1(in.size()), out2(in.size());
+    std::vector<uint8_t> valid1(in.size()), valid2(in.size());
+
+    kernels.Linear(in.data(), out1.data(), in.size(), par);
+    scalar.Linear(in.data(), out2.data(), in.size(), par);
+    EXPECT_EQ(out1, out2);
+
+    EXPECT_EQ(kernels.Rational(in.data(), out1.data(), valid1.data(),
+                               in.size(), par),
+              scalar.Rational(in.data(), out2.data(), valid2.data(),
+                              in.size(), par));
+    EXPECT_EQ(out1, out2);
+    EXPECT_EQ(valid1, valid2);
+
+    EXPECT_EQ(kernels.Polynomial(in.data(), out1.data(), valid1.data(),
+                                 in.size(), par),
+              scalar.Polynomial(in.data(), out2.data(), valid2.data(),
+                                in.size(), par));
+    EXPECT_EQ(out1, out2);
+    EXPECT_EQ(valid1, valid2);
+  }
+}
+
+TEST(TestConversion, EngValueTable) {
+  const std::vector<std::pair<ConversionType, std::vector<double>>> list = {
+      {ConversionType::Rational, {1, 2, 3, 0, 1, -5}},
+      {ConversionType::Polynomial, {2, 3, 0.5, 1, 4, 1}},
+      {ConversionType::ValueToValue, {1, 10, 2, 20, 3, 30, 0}},
+      {ConversionType::Algebraic, {}},
+  };
+  for (const auto& [type, parameters] : list) {
+    Cc4Block cc;
+    cc.Type(type);
+    cc.Formula("sqrt(X) * 2");
+    for (size_t index = 0; index < parameters.size(); ++index) {
+      cc.Parameter(static_cast<uint16_t>(index), parameters[index]);
+    }
+    EXPECT_EQ(cc.GetEngValueTable(12, false, 100), nullptr);
+    EXPECT_EQ(cc.GetEngValueTable(17, false, 1'000'000), nullptr);
+
+    for (const bool signed_value : {false, true}) {
+      cc.Type(type);  // Deletes the previous table.
+      const auto* table = cc.GetEngValueTable(12, signed_value, 10'000);
+      ASSERT_NE(table, nullptr);
+      // The table only exists for the channel that owns the conversion.
+      EXPECT_EQ(cc.GetEngValueTable(8, signed_value, 10'000), nullptr);
+
+      for (int64_t raw = -3000; raw <= 5000; ++raw) {
+        double value1 = 0.0;
+        double value2 = 0.0;
+        const bool valid1 = table->Convert(raw, value1);
+        const bool valid2 = cc.Convert(raw, value2);
+        EXPECT_EQ(valid1, valid2) << raw;
+        if (!std::isnan(value2)) {
+          EXPECT_EQ(value1, value2) << raw;
+        }
+        std::string text1;
+        std::string text2;
+        EXPECT_EQ(table->Convert(raw, text1), cc.Convert(raw, text2));
+        EXPECT_EQ(text1, text2) << raw;
+      }
+    }
+  }
+
+  Cc4Block linear;
+  linear.Type(ConversionType::Linear);
+  linear.Parameter(0, 1.0);
+  linear.Parameter(1, 2.0);
+  EXPECT_EQ(linear.GetEngValueTable(8, false, 10'000), nullptr);
+}
+
+TEST(TestConversion, Algebraic) {
+  const std::vector<std::pair<std::string, double>> list = {
+      {"X", 3.0},
+      {"2*X + 1", 7.0},
+      {"-X^2", -9.0},
+      {"2^-1", 0.5},
+      {"2**3**2", 512.0},
+      {"(x1 - 1) / 4", 0.5},
+      {"1.5e1 + .5", 15.5},
+      {"0x10 | 1", 17.0},
+      {"(X & 2) << 2", 8.0},
+      {"X > 2 && X <= 3", 1.0},
+      {"!(X == 3) || X <> 3", 0.0},
+      {"sqrt(abs(-X * 3))", 3.0},
+      {"max(X, 5) + min(X, 5)", 8.0},
+      {"fmod(X, 2) + floor(2.5)", 3.0},
+      {"sin(PI / 2)", 1.0},
+  };
+  for (const auto& [formula, expected] : list) {
+    Cc4Block cc;
+    cc.Type(ConversionType::Algebraic);
+    cc.Formula(formula);
+    double eng_value = 0.0;
+    EXPECT_TRUE(cc.Convert(3.0, eng_value)) << formula;
+    EXPECT_DOUBLE_EQ(eng_value, expected) << formula;
+  }
+
+  for (const auto* formula : {"", "X +", "Y", "foo(X)", "(X", "pow(X)"}) {
+    Cc4Block cc;
+    cc.Type(ConversionType::Algebraic);
+    cc.Formula(formula);
+    double eng_value = 0.0;
+    EXPECT_FALSE(cc.Convert(3.0, eng_value)) << formula;
+  }
+
+  // The batch conversion shall give exactly the same values.
+  const auto in = TestValues();
+  for (const auto* formula : {"1 / X", "log(X) * 2 - X", "X * X % 7",
+                              "(X < 0) * exp(X / 10) + atan2(X, 2)"}) {
+    Cc4Block cc;
+    cc.Type(ConversionType::Algebraic);
+    cc.Formula(formula);
+    std::vector<double> out(in.size(), 0.0);
+    std::vector<uint8_t> valid(in.size(), 0);
+    cc.ConvertBatch(Span<const double>(in), Span<double>(out),
+                    Span<uint8_t>(valid));
+    for (size_t index = 0; index < in.size(); ++index) {
+      double eng_value = 0.0;
+      const bool expected_valid = cc.Convert(in[index], eng_value);
+      EXPECT_EQ(valid[index] != 0, expected_valid) << formula;
+      if (expected_valid) {
+        EXPECT_EQ(out[index], eng_value) << formula;
+      }
+    }
+  }
+}
+
+TEST(TestConversion, TextTables) {
+  // The text references are resolved when the file is read.
+  constexpr uint16_t kNofKeys = 2000;
+  const auto mdf_file = std::filesystem::temp_directory_path() /
+                        "mdf_text_tables.mf4";
+  std::filesystem::remove(mdf_file);
+  {
+    auto writer = MdfFactory::CreateMdfWriter(MdfWriterType::Mdf4Basic);
+    ASSERT_TRUE(writer->Init(mdf_file.string()));
+    auto* header = writer->Header();
+    auto* data_group = header->CreateDataGroup();
+    auto* channel_group = data_group->CreateChannelGroup();
+    auto* master = channel_group->CreateChannel();
+    master->Name("Time");
+    master->Type(ChannelType::Master);
+    master->Sync(ChannelSyncType::Time);
+    master->DataType(ChannelDataType::FloatLe);
+    master->DataBytes(8);
+
+    // Keys in descending order to check that the table doesn't require
+    // sorted keys. The last reference is the default text.
+    auto* dtc = channel_group->CreateChannel();
+    dtc->Name("DTC");
+    dtc->Type(ChannelType::FixedLength);
+    dtc->DataType(ChannelDataType::UnsignedIntegerLe);
+    dtc->DataBytes(2);
+    auto* dtc_cc = dtc->CreateChannelConversion();
+    dtc_cc->Type(ConversionType::ValueToText);
+    for (uint16_t index = 0; index < kNofKeys; ++index) {
+      dtc_cc->Parameter(index, static_cast<double>(kNofKeys - index));
+      dtc_cc->Reference(index, "DTC" + std::to_string(kNofKeys - index));
+    }
+    dtc_cc->Reference(kNofKeys, "Default");
+
+    // Integer channel ranges include the max key.
+    auto* state = channel_group->CreateChannel();
+    state->Name("State");
+    state->Type(ChannelType::FixedLength);
+    state->DataType(ChannelDataType::UnsignedIntegerLe);
+    state->DataBytes(2);
+    auto* state_cc = state->CreateChannelConversion();
+    state_cc->Type(ConversionType::ValueRangeToText);
+    for (uint16_t index = 0; index < 100; ++index) {
+      state_cc->Parameter(index * 2, index * 10.0);
+      state_cc->Parameter((index * 2) + 1, (index * 10.0) + 4);
+      state_cc->Reference(index, "Range" + std::to_string(index));
+    }
+    state_cc->Reference(100, "Default");
+
+    writer->InitMeasurement();
+    auto tick_time = MdfHelper::NowNs();
+    writer->StartMeasurement(tick_time);
+    for (uint64_t sample = 0; sample <= 2100; ++sample) {
+      dtc->SetChannelValue(sample);
+      state->SetChannelValue(sample / 2);
+      writer->SaveSample(*channel_group, tick_time);
+      tick_time += 1'000'000;
+    }
+    writer->StopMeasurement(tick_time);
+    writer->FinalizeMeasurement();
+  }
+
+  MdfReader reader(mdf_file.string());
+  ASSERT_TRUE(reader.ReadEverythingButData());
+  auto* data_group = reader.GetFile()->Header()->LastDataGroup();
+  ASSERT_TRUE(data_group != nullptr);
+  ChannelObserverList observer_list;
+  CreateChannelObserverForDataGroup(*data_group, observer_list);
+  ASSERT_TRUE(reader.ReadData(*data_group));
+  reader.Close();
+
+  std::vector<std::string> dtc_list;
+  std::vector<std::string> state_list;
+  for (const auto& observer : observer_list) {
+    if (observer->Name() == "DTC") {
+      observer->GetEngSamples(dtc_list);
+    } else if (observer->Name() == "State") {
+      observer->GetEngSamples(state_list);
+    }
+  }
+  ASSERT_EQ(dtc_list.size(), 2101);
+  ASSERT_EQ(state_list.size(), 2101);
+  for (uint64_t sample = 0; sample <= 2100; ++sample) {
+    const bool has_key = sample >= 1 && sample <= kNofKeys;
+    EXPECT_EQ(dtc_list[sample],
+              has_key ? "DTC" + std::to_string(sample) : "Default");
+
+    const uint64_t value = sample / 2;
+    const bool in_range = value % 10 <= 4 && value < 1000;
+    EXPECT_EQ(state_list[sample],
+              in_range ? "Range" + std::to_string(value / 10) : "Default");
+  }
+  std::filesystem::remove(mdf_file);
+}
+
+}  // namespace mdf::test
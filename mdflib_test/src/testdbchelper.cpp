@@ -0,0 +1,133 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+#include <array>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "dbchelper.h"
+
+using namespace mdf::detail;
+
+namespace {
+
+/** \brief The original bit extraction that reads one bit at the time. */
+uint64_t BitLoopUnsigned(bool little_endian, size_t start, size_t length,
+                         const uint8_t* raw) {
+  uint64_t value = 0;
+  auto byte = (little_endian ?
+      static_cast<int>(start + length - 1) : static_cast<int>(start)) / 8;
+  auto bit = static_cast<int>((start + length - 1) % 8);
+  for (size_t index = 0; index < length; ++index) {
+    if (index > 0) {
+      value <<= 1;
+    }
+    if ((raw[byte] & (1 << bit)) != 0) {
+      value |= 1;
+    }
+    --bit;
+    if (bit < 0) {
+      bit = 7;
+      little_endian ? --byte : ++byte;
+    }
+  }
+  return value;
+}
+
+int64_t BitLoopSigned(bool little_endian, size_t start, size_t length,
+                      const uint8_t* raw) {
+  uint64_t value = BitLoopUnsigned(little_endian, start, length, raw);
+  if (length < 64 && (value & (1ULL << (length - 1))) != 0) {
+    value |= ~((1ULL << length) - 1); // Sign extend
+  }
+  return static_cast<int64_t>(value);
+}
+
+struct BitTest {
+  bool LittleEndian;
+  size_t Start;
+  size_t Length;
+  std::vector<uint8_t> Raw;
+  uint64_t Unsigned;
+  int64_t Signed;
+};
+
+}  // namespace
+
+namespace mdf::test {
+
+TEST(TestDbcHelper, RawToValueTable) {
+  const std::vector<BitTest> test_list = {
+      {true, 0, 1, {0x01}, 1, -1},
+      {true, 7, 1, {0x80}, 1, -1},
+      {true, 3, 1, {0xF7}, 0, 0},
+      {false, 0, 1, {0x01}, 1, -1},
+      {true, 0, 8, {0x7F}, 0x7F, 127},
+      {true, 0, 8, {0x80}, 0x80, -128},
+      {true, 0, 16, {0x34, 0x12}, 0x1234, 0x1234},
+      {false, 0, 16, {0x12, 0x34}, 0x1234, 0x1234},
+      {true, 0, 16, {0xFE, 0xFF}, 0xFFFE, -2},
+      {false, 0, 16, {0xFF, 0xFE}, 0xFFFE, -2},
+      {true, 4, 8, {0x50, 0x03}, 0x35, 0x35},
+      {true, 4, 8, {0x50, 0x0F}, 0xF5, -11},
+      {true, 8, 32, {0x00, 0x78, 0x56, 0x34, 0x12}, 0x12345678, 0x12345678},
+      {false, 8, 32, {0x00, 0x12, 0x34, 0x56, 0x78}, 0x12345678, 0x12345678},
+      {true, 0, 64, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+       0xFFFFFFFFFFFFFFFFULL, -1},
+      {false, 0, 64, {0x80, 0, 0, 0, 0, 0, 0, 0x01},
+       0x8000000000000001ULL, static_cast<int64_t>(0x8000000000000001ULL)},
+      {true, 1, 63, {0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+       0x7FFFFFFFFFFFFFFFULL, -1},
+      {true, 5, 60, {0xE0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01},
+       0x0FFFFFFFFFFFFFFFULL, -1},
+      {true, 7, 57, {0x80, 0, 0, 0, 0, 0, 0, 0x80}, 0x0100000000000001ULL,
+       static_cast<int64_t>(0xFF00000000000001ULL)},
+  };
+  for (const auto& test : test_list) {
+    EXPECT_EQ(DbcHelper::RawToUnsigned(test.LittleEndian, test.Start,
+                                       test.Length, test.Raw.data()),
+              test.Unsigned)
+        << "Start: " << test.Start << ", Length: " << test.Length;
+    EXPECT_EQ(DbcHelper::RawToSigned(test.LittleEndian, test.Start,
+                                     test.Length, test.Raw.data()),
+              test.Signed)
+        << "Start: " << test.Start << ", Length: " << test.Length;
+    // The table itself is checked against the original implementation.
+    EXPECT_EQ(BitLoopUnsigned(test.LittleEndian, test.Start, test.Length,
+                              test.Raw.data()), test.Unsigned);
+  }
+}
+
+TEST(TestDbcHelper, RawToValueBitLoop) {
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> distribution(0, 255);
+  std::array<uint8_t, 24> raw = {};
+  for (size_t buffer = 0; buffer < 20; ++buffer) {
+    for (auto& byte : raw) {
+      byte = static_cast<uint8_t>(distribution(generator));
+    }
+    for (const bool little_endian : {true, false}) {
+      for (size_t start = 0; start < 16; ++start) {
+        for (size_t length = 1; length <= 64; ++length) {
+          const auto expected_unsigned =
+              BitLoopUnsigned(little_endian, start, length, raw.data());
+          const auto expected_signed =
+              BitLoopSigned(little_endian, start, length, raw.data());
+          EXPECT_EQ(DbcHelper::RawToUnsigned(little_endian, start, length,
+                                             raw.data()), expected_unsigned)
+              << "LE: " << little_endian << ", Start: " << start
+              << ", Length: " << length;
+          EXPECT_EQ(DbcHelper::RawToSigned(little_endian, start, length,
+                                           raw.data()), expected_signed)
+              << "LE: " << little_endian << ", Start: " << start
+              << ", Length: " << length;
+        }
+      }
+    }
+  }
+}
+
+}  // namespace mdf::test
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cg4block.h"
+#include "cn4block.h"
+#include "decodeplan.h"
+
+using namespace mdf::detail;
+
+namespace {
+
+struct TestChannel {
+  std::string Name;
+  mdf::ChannelDataType DataType;
+  uint64_t DataBytes;
+  uint16_t BitOffset; ///< Bit offset set after the layout is calculated.
+  uint32_t BitCount; ///< 0 means all bits of the data bytes.
+  bool InvalidBit;
+};
+
+bool IsSameValue(double value1, double value2) {
+  if (std::isnan(value1) || std::isnan(value2)) {
+    return std::isnan(value1) && std::isnan(value2);
+  }
+  return value1 == value2;
+}
+
+}  // namespace
+
+namespace mdf::test {
+
+TEST(TestDecodePlan, DecoderMatchesChannelValue) {
+  const std::vector<TestChannel> test_list = {
+      {"Time", ChannelDataType::FloatLe, 8, 0, 0, false},
+      {"UnsignedLe", ChannelDataType::UnsignedIntegerLe, 4, 0, 0, false},
+      {"UnsignedBe", ChannelDataType::UnsignedIntegerBe, 4, 0, 0, false},
+      {"SignedLe", ChannelDataType::SignedIntegerLe, 2, 0, 0, false},
+      {"SignedBe", ChannelDataType::SignedIntegerBe, 8, 0, 0, false},
+      {"FloatLe", ChannelDataType::FloatLe, 4, 0, 0, false},
+      {"FloatBe", ChannelDataType::FloatBe, 8, 0, 0, false},
+      {"BitsLe", ChannelDataType::UnsignedIntegerLe, 2, 3, 9, false},
+      {"BitsBe", ChannelDataType::UnsignedIntegerBe, 3, 5, 17, false},
+      {"SignedBitsLe", ChannelDataType::SignedIntegerLe, 4, 2, 20, false},
+      {"SignedBitsBe", ChannelDataType::SignedIntegerBe, 2, 1, 11, false},
+      {"InvalidUnsigned", ChannelDataType::UnsignedIntegerLe, 1, 0, 0, true},
+      {"InvalidDouble", ChannelDataType::FloatLe, 8, 0, 0, true},
+      {"InvalidBits", ChannelDataType::SignedIntegerBe, 4, 4, 13, true},
+  };
+
+  Cg4Block group;
+  std::vector<IChannel*> channel_list;
+  for (const auto& test : test_list) {
+    auto* channel = group.CreateChannel();
+    ASSERT_TRUE(channel != nullptr);
+    channel->Name(test.Name);
+    channel->Type(channel_list.empty() ? ChannelType::Master
+                                       : ChannelType::FixedLength);
+    channel->DataType(test.DataType);
+    channel->DataBytes(test.DataBytes);
+    if (test.InvalidBit) {
+      channel->Flags(CnFlag::InvalidValid);
+    }
+    channel_list.push_back(channel);
+  }
+  auto* text = group.CreateChannel();
+  text->Name("Text");
+  text->Type(ChannelType::FixedLength);
+  text->DataType(ChannelDataType::StringAscii);
+  text->DataBytes(6);
+
+  // Calculates the byte offsets and the invalid bit positions. The bit
+  // offsets are set afterwards.
+  group.PrepareForWriting();
+  for (size_t index = 0; index < test_list.size(); ++index) {
+    const auto& test = test_list[index];
+    if (test.BitCount > 0) {
+      channel_list[index]->BitOffset(test.BitOffset);
+      channel_list[index]->BitCount(test.BitCount);
+    }
+  }
+
+  const auto plan = group.GetDecodePlan();
+  ASSERT_TRUE(plan);
+  EXPECT_EQ(plan->Decoders().size(), test_list.size());
+  EXPECT_TRUE(plan->GetDecoder(*text) == nullptr);
+
+  const size_t record_size = group.NofDataBytes() + group.NofInvalidBytes();
+  ASSERT_GT(group.NofInvalidBytes(), 0);
+  std::mt19937 generator(1234);
+  std::uniform_int_distribution<int> distribution(0, 255);
+  std::vector<uint8_t> record(record_size, 0);
+  for (size_t sample = 0; sample < 1000; ++sample) {
+    for (auto& byte : record) {
+      byte = static_cast<uint8_t>(distribution(generator));
+    }
+    for (const auto* channel : channel_list) {
+      const auto* decoder = plan->GetDecoder(*channel);
+      ASSERT_TRUE(decoder != nullptr) << channel->Name();
+      EXPECT_EQ(decoder->Channel(), channel);
+
+      double expected = 0;
+      const bool expected_valid = channel->GetChannelValue(record, expected);
+      double value = 0;
+      const bool valid = decoder->Decode(record.data(), record.size(), 0,
+                                         value);
+      EXPECT_EQ(valid, expected_valid) << channel->Name();
+      EXPECT_TRUE(IsSameValue(value, expected))
+          << channel->Name() << ": " << value << " != " << expected;
+
+      if (channel->DataType() == ChannelDataType::UnsignedIntegerLe ||
+          channel->DataType() == ChannelDataType::UnsignedIntegerBe) {
+        uint64_t expected_unsigned = 0;
+        uint64_t unsigned_value = 0;
+        channel->GetChannelValue(record, expected_unsigned);
+        decoder->Decode(record.data(), record.size(), 0, unsigned_value);
+        EXPECT_EQ(unsigned_value, expected_unsigned) << channel->Name();
+      } else if (channel->DataType() == ChannelDataType::SignedIntegerLe ||
+                 channel->DataType() == ChannelDataType::SignedIntegerBe) {
+        int64_t expected_signed = 0;
+        int64_t signed_value = 0;
+        channel->GetChannelValue(record, expected_signed);
+        decoder->Decode(record.data(), record.size(), 0, signed_value);
+        EXPECT_EQ(signed_value, expected_signed) << channel->Name();
+      }
+    }
+  }
+
+  // A new layout creates a new plan, but the old decoders are still valid.
+  const auto* decoder = plan->GetDecoder(*channel_list[1]);
+  group.PrepareForWriting();
+  const auto new_plan = group.GetDecodePlan();
+  EXPECT_NE(new_plan.get(), plan.get());
+  EXPECT_EQ(plan->GetDecoder(*channel_list[1]), decoder);
+  EXPECT_EQ(decoder->Channel(), channel_list[1]);
+}
+
+}  // namespace mdf::test
@@ -8,6 +8,9 @@
 #include <boost/iostreams/device/file.hpp>
 #include <boost/iostreams/stream.hpp>
 #include <boost/iostreams/device/back_inserter.hpp>
+#include <fstream>
+
+#include "mappedfilebuf.h"
 using namespace std::filesystem;
 using namespace boost::iostreams;
 
@@ -116,4 +119,45 @@ TEST(BoostIostreams, SimpleWrite) {
   EXPECT_FALSE(input_array.eof());
 }
 
+TEST(MappedFileBuf, ReadAndSeek) {
+  const std::string test_file = MakeFilePath("mapped_file.bin");
+  {
+    std::ofstream out_file(test_file, std::ios_base::binary);
+    for (int index = 0; index < 256; ++index ) {
+      out_file.put(static_cast<char>(index));
+    }
+  }
+
+  detail::MappedFileBuf mapped_file;
+  ASSERT_TRUE(mapped_file.Open(path(test_file).wstring()));
+  EXPECT_TRUE(mapped_file.IsOpen());
+  EXPECT_EQ(mapped_file.Size(), 256);
+
+  std::istream input_file(&mapped_file);
+  int byte_index = 0;
+  while (!input_file.eof()) {
+    int input = input_file.get();
+    if (input < 0) {
+      break;
+    }
+    EXPECT_EQ(input, byte_index) << byte_index << "/" << input;
+    ++byte_index;
+  }
+  EXPECT_EQ(byte_index, 256);
+
+  EXPECT_EQ(mapped_file.pubseekpos(100), 100);
+  EXPECT_EQ(mapped_file.sbumpc(), 100);
+  EXPECT_EQ(mapped_file.pubseekoff(10, std::ios_base::cur), 111);
+  EXPECT_EQ(mapped_file.pubseekoff(-1, std::ios_base::end), 255);
+  EXPECT_EQ(mapped_file.pubseekoff(1, std::ios_base::end), -1);
+
+  const auto* data = mapped_file.Data(200, 56);
+  ASSERT_TRUE(data != nullptr);
+  EXPECT_EQ(data[0], 200);
+  EXPECT_TRUE(mapped_file.Data(200, 57) == nullptr);
+
+  mapped_file.Close();
+  EXPECT_FALSE(mapped_file.IsOpen());
+}
+
 } // end namespace
\ No newline at end of file
@@ -5,8 +5,12 @@
 
 #include <gtest/gtest.h>
 #include "mdfblock.h"
+#include "hd4block.h"
+#include "mdf/mdffactory.h"
 #include "mdf/mdfreader.h"
+#include "mdf/mdfwriter.h"
 #include "mdf/idatagroup.h"
+#include "mdf/ichannelgroup.h"
 
 #include <filesystem>
 #include <fstream>
@@ -169,5 +173,110 @@ TEST(TestMdfBlock, TestEllipseComment) {
   }
 }
 
+TEST(TestMdfBlock, TestBlockIndex) {
+  const std::string test_file = MakeTestFilePath("block_index.mf4");
+  {
+    auto writer = MdfFactory::CreateMdfWriter(MdfWriterType::Mdf4Basic);
+    ASSERT_TRUE(writer->Init(test_file));
+    auto* data_group = writer->CreateDataGroup();
+    auto* channel_group = data_group->CreateChannelGroup();
+    auto* master = channel_group->CreateChannel();
+    master->Name("Time");
+    master->Type(ChannelType::Master);
+    master->DataType(ChannelDataType::FloatLe);
+    master->DataBytes(8);
+    for (size_t index = 0; index < 100; ++index) {
+      auto* channel = channel_group->CreateChannel();
+      channel->Name("Channel" + std::to_string(index));
+      channel->Unit("V");
+      channel->DataType(ChannelDataType::UnsignedIntegerLe);
+      channel->DataBytes(4);
+    }
+    writer->InitMeasurement();
+    writer->StartMeasurement(1'000);
+    writer->SaveSample(*channel_group, 1'000);
+    writer->StopMeasurement(2'000);
+    ASSERT_TRUE(writer->FinalizeMeasurement());
+  }
+
+  MdfReader reader(test_file);
+  ASSERT_TRUE(reader.ReadEverythingButData());
+  const auto* header = dynamic_cast<const Hd4Block*>(reader.GetHeader());
+  ASSERT_TRUE(header != nullptr);
+
+  const auto dg_list = header->DataGroups();
+  ASSERT_EQ(dg_list.size(), 1);
+  const auto* data_group = dynamic_cast<const MdfBlock*>(dg_list[0]);
+  ASSERT_TRUE(data_group != nullptr);
+  const auto cg_list = dg_list[0]->ChannelGroups();
+  ASSERT_EQ(cg_list.size(), 1);
+  const auto cn_list = cg_list[0]->Channels();
+  ASSERT_EQ(cn_list.size(), 101);
+
+  // The file index and the data group search should find all channels.
+  for (const auto* channel : cn_list) {
+    EXPECT_EQ(header->Find(channel->Index()),
+              dynamic_cast<const MdfBlock*>(channel));
+    EXPECT_EQ(data_group->Find(channel->Index()),
+              dynamic_cast<const MdfBlock*>(channel));
+  }
+  EXPECT_EQ(header->Find(data_group->FilePosition()), data_group);
+  EXPECT_EQ(header->Find(header->FilePosition()), header);
+  EXPECT_TRUE(header->Find(1) == nullptr);
+  EXPECT_TRUE(data_group->Find(header->FilePosition()) == nullptr);
+}
+
+
+TEST(TestMdfBlock, TestStringPool) {
+  StringPool pool;
+  const auto first = pool.Intern("CAN_DataFrame.ID");
+  const auto second = pool.Intern(std::string("CAN_DataFrame.") + "ID");
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(ToStringView(first), "CAN_DataFrame.ID");
+  EXPECT_TRUE(pool.Intern("") == nullptr);
+  EXPECT_EQ(pool.Size(), 1);
+
+  const std::string test_file = MakeTestFilePath("string_pool.mf4");
+  {
+    auto writer = MdfFactory::CreateMdfWriter(MdfWriterType::Mdf4Basic);
+    ASSERT_TRUE(writer->Init(test_file));
+    auto* data_group = writer->CreateDataGroup();
+    for (size_t group = 0; group < 3; ++group) {
+      auto* channel_group = data_group->CreateChannelGroup();
+      channel_group->Name("CAN_DataFrame");
+      auto* master = channel_group->CreateChannel();
+      master->Name("Time");
+      master->Type(ChannelType::Master);
+      master->DataType(ChannelDataType::FloatLe);
+      master->DataBytes(8);
+      auto* channel = channel_group->CreateChannel();
+      channel->Name("CAN_DataFrame.ID");
+      channel->DataType(ChannelDataType::UnsignedIntegerLe);
+      channel->DataBytes(4);
+    }
+    writer->InitMeasurement();
+    writer->StartMeasurement(1'000);
+    writer->StopMeasurement(2'000);
+    ASSERT_TRUE(writer->FinalizeMeasurement());
+  }
+
+  MdfReader reader(test_file);
+  ASSERT_TRUE(reader.ReadEverythingButData());
+  const auto cg_list = reader.GetHeader()->LastDataGroup()->ChannelGroups();
+  ASSERT_EQ(cg_list.size(), 3);
+
+  // The channels in different groups share the same name storage.
+  std::string_view name;
+  for (const auto* channel_group : cg_list) {
+    const auto* channel = channel_group->GetChannel("CAN_DataFrame.ID");
+    ASSERT_TRUE(channel != nullptr);
+    EXPECT_EQ(channel->NameView(), "CAN_DataFrame.ID");
+    if (name.empty()) {
+      name = channel->NameView();
+    } else {
+      EXPECT_EQ(channel->NameView().data(), name.data());
+    }
+  }
+}
 
 }
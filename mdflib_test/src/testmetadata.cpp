@@ -186,6 +186,27 @@ TEST_F(TestMetaData, Fh4Block) {
   std::cout << md4->XmlSnippet() << std::endl;
 }
 
+TEST_F(TestMetaData, Md4BlockXmlCache) {
+  Md4Block md4("<CNcomment><TX>First</TX></CNcomment>");
+  const auto* xml_file = md4.XmlFile();
+  ASSERT_TRUE(xml_file != nullptr);
+  // The parsed XML is kept between the calls.
+  EXPECT_EQ(md4.XmlFile(), xml_file);
+  EXPECT_EQ(md4.TxComment(), "First");
+
+  // Changing the text invalidates the parsed XML.
+  md4.TxComment("Second");
+  EXPECT_EQ(md4.TxComment(), "Second");
+  EXPECT_EQ(md4.StringProperty("TX"), "Second");
+
+  md4.XmlSnippet("<CNcomment><TX>Third</TX><gain>2.5</gain></CNcomment>");
+  EXPECT_EQ(md4.TxComment(), "Third");
+  EXPECT_DOUBLE_EQ(md4.FloatProperty("gain"), 2.5);
+
+  md4.Text("Not XML");
+  EXPECT_TRUE(md4.XmlFile() == nullptr);
+}
+
 TEST_F(TestMetaData, OdsMetaData) {
   if (kSkipTest) {
     GTEST_SKIP();
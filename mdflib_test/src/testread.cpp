@@ -277,6 +277,36 @@ TEST_F(TestRead, Benchmark) {
     std::cout << "Everything + Conversion (TrueNas): " << diff.count()
               << " ms" << std::endl;
   }
+  {
+    const auto start = steady_clock::now();
+    MdfReader oRead(kBenchMarkFile);
+    oRead.ReadEverythingButData();
+    const auto *file = oRead.GetFile();
+    DataGroupList dg_list;
+    file->DataGroups(dg_list);
+    ChannelObserverList observer_list;
+    for (auto *dg : dg_list) {
+      auto cg_list = dg->ChannelGroups();
+      for (const auto *cg : cg_list) {
+        CreateChannelObserverForChannelGroup(*dg, *cg, observer_list);
+      }
+    }
+    EXPECT_TRUE(oRead.ReadDataParallel(dg_list));
+
+    double eng_value = 0;
+    bool valid = true;
+    for (const auto &channel : observer_list) {
+      size_t samples = channel->NofSamples();
+      for (size_t sample = 0; sample < samples; ++sample) {
+        valid = channel->GetEngValue(sample, eng_value);
+      }
+    }
+
+    const auto stop = steady_clock::now();
+    std::chrono::duration<double> diff = duration_cast<milliseconds>(stop - start);
+    std::cout << "Parallel Everything + Conversion (TrueNas): " << diff.count()
+              << " ms" << std::endl;
+  }
 }
 
 TEST_F(TestRead, TestLargeFile) {
@@ -5,9 +5,12 @@
 #include "testwrite.h"
 
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include <filesystem>
 #include <string>
 #include <thread>
+#include <tuple>
 #include <random>
 #include <fstream>
 
@@ -15,6 +18,9 @@
 #include "util/logstream.h"
 #include "util/timestamp.h"
 
+#include "channelobserver.h"
+#include "mdf/channelchunkobserver.h"
+#include "mdf/cncomment.h"
 #include "mdf/isourceinformation.h"
 #include "mdf/ichannelgroup.h"
 #include "mdf/idatagroup.h"
@@ -65,6 +71,38 @@ void NoLog(const MdfLocation& location, mdf::MdfLogSeverity severity,
            const std::string& text) {
 }
 
+/** \brief Received sample. Sample number, record ID and record bytes. */
+using ReceivedSample = std::tuple<uint64_t, uint64_t, std::vector<uint8_t>>;
+
+/** \brief Observer that only overrides the record view (span) function. */
+class SpanObserver : public ISampleObserver {
+ public:
+  explicit SpanObserver(const IDataGroup& data_group)
+      : ISampleObserver(data_group) {}
+  using ISampleObserver::OnSample;
+  bool OnSample(uint64_t sample, uint64_t record_id,
+                Span<const uint8_t> record) override {
+    sample_list.emplace_back(sample, record_id,
+        std::vector<uint8_t>(record.begin(), record.end()));
+    return true;
+  }
+  std::vector<ReceivedSample> sample_list;
+};
+
+/** \brief Observer that only overrides the record buffer function. */
+class VectorObserver : public ISampleObserver {
+ public:
+  explicit VectorObserver(const IDataGroup& data_group)
+      : ISampleObserver(data_group) {}
+  using ISampleObserver::OnSample;
+  bool OnSample(uint64_t sample, uint64_t record_id,
+                const std::vector<uint8_t>& record) override {
+    sample_list.emplace_back(sample, record_id, record);
+    return true;
+  }
+  std::vector<ReceivedSample> sample_list;
+};
+
 
 
 }  // namespace
@@ -2061,6 +2099,1406 @@ TEST_F(TestWrite, Mdf4Multi) {
   }
 }
 
+TEST_F(TestWrite, Mdf4SampleIndex) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+  path mdf_file(kTestDir);
+  mdf_file.append("sample_index.mf4");
+
+  auto writer = MdfFactory::CreateMdfWriter(MdfWriterType::Mdf4Basic);
+  writer->Init(mdf_file.string());
+  auto* header = writer->Header();
+  auto* data_group = header->CreateDataGroup();
+  auto* group1 = data_group->CreateChannelGroup();
+  group1->Name("Fast");
+  auto* ch1 = group1->CreateChannel();
+  ch1->Name("Fast32");
+  ch1->Type(ChannelType::FixedLength);
+  ch1->DataType(ChannelDataType::UnsignedIntegerLe);
+  ch1->DataBytes(4);
+
+  auto* group2 = data_group->CreateChannelGroup();
+  group2->Name("Slow");
+  auto* ch2 = group2->CreateChannel();
+  ch2->Name("Slow64");
+  ch2->Type(ChannelType::FixedLength);
+  ch2->DataType(ChannelDataType::FloatLe);
+  ch2->DataBytes(8);
+
+  writer->PreTrigTime(0);
+  writer->InitMeasurement();
+  auto tick_time = TimeStampToNs();
+  writer->StartMeasurement(tick_time);
+  for (size_t sample = 0; sample < 1000; ++sample) {
+    ch1->SetChannelValue(static_cast<uint64_t>(sample));
+    writer->SaveSample(*group1, tick_time);
+    if ((sample % 3) == 0) {
+      ch2->SetChannelValue(static_cast<double>(sample) + 0.5);
+      writer->SaveSample(*group2, tick_time);
+    }
+    tick_time += 1'000'000;
+  }
+  writer->StopMeasurement(tick_time);
+  writer->FinalizeMeasurement();
+
+  { // Create the index file
+    MdfReader reader(mdf_file.string());
+    ASSERT_TRUE(reader.ReadEverythingButData());
+    auto* dg = reader.GetFile()->Header()->LastDataGroup();
+    ASSERT_TRUE(dg != nullptr);
+    EXPECT_TRUE(reader.CreateSampleIndex(*dg, 50));
+    EXPECT_TRUE(reader.SaveSampleIndex());
+  }
+
+  // Read the same range with and without the index.
+  MdfReader scan_reader(mdf_file.string());
+  ASSERT_TRUE(scan_reader.ReadEverythingButData());
+  auto* scan_dg = scan_reader.GetFile()->Header()->LastDataGroup();
+  ASSERT_TRUE(scan_dg != nullptr);
+  ChannelObserverList scan_list;
+  CreateChannelObserverForDataGroup(*scan_dg, scan_list);
+  ASSERT_TRUE(scan_reader.ReadPartialData(*scan_dg, 600, 700));
+  scan_reader.Close();
+
+  MdfReader index_reader(mdf_file.string());
+  ASSERT_TRUE(index_reader.ReadEverythingButData());
+  EXPECT_TRUE(index_reader.LoadSampleIndex());
+  auto* index_dg = index_reader.GetFile()->Header()->LastDataGroup();
+  ASSERT_TRUE(index_dg != nullptr);
+  ChannelObserverList index_list;
+  CreateChannelObserverForDataGroup(*index_dg, index_list);
+  ASSERT_TRUE(index_reader.ReadPartialData(*index_dg, 600, 700));
+  index_reader.Close();
+
+  ASSERT_EQ(scan_list.size(), index_list.size());
+  size_t nof_valid = 0;
+  for (size_t observer = 0; observer < scan_list.size(); ++observer) {
+    const auto& scan = scan_list[observer];
+    const auto& index = index_list[observer];
+    ASSERT_EQ(scan->NofSamples(), index->NofSamples());
+    for (uint64_t sample = 0; sample < scan->NofSamples(); ++sample) {
+      double scan_value = 0;
+      double index_value = 0;
+      const bool scan_valid = scan->GetChannelValue(sample, scan_value);
+      const bool index_valid = index->GetChannelValue(sample, index_value);
+      EXPECT_EQ(scan_valid, index_valid) << scan->Name() << ":" << sample;
+      EXPECT_DOUBLE_EQ(scan_value, index_value) << scan->Name();
+      nof_valid += index_valid ? 1 : 0;
+    }
+  }
+  EXPECT_GT(nof_valid, 0);
+}
+
+TEST_F(TestWrite, Mdf4TimeRange) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+  path mdf_file(kTestDir);
+  mdf_file.append("time_range.mf4");
+
+  auto writer = MdfFactory::CreateMdfWriter(MdfWriterType::Mdf4Basic);
+  writer->Init(mdf_file.string());
+  auto* header = writer->Header();
+  auto* data_group = header->CreateDataGroup();
+  auto* group = data_group->CreateChannelGroup();
+  group->Name("Group");
+  auto* master = group->CreateChannel();
+  master->Name("Time");
+  master->Type(ChannelType::Master);
+  master->Sync(ChannelSyncType::Time);
+  master->DataType(ChannelDataType::FloatLe);
+  master->DataBytes(8);
+  auto* channel = group->CreateChannel();
+  channel->Name("Counter");
+  channel->Type(ChannelType::FixedLength);
+  channel->DataType(ChannelDataType::UnsignedIntegerLe);
+  channel->DataBytes(4);
+
+  writer->PreTrigTime(0);
+  writer->InitMeasurement();
+  auto tick_time = TimeStampToNs();
+  writer->StartMeasurement(tick_time);
+  for (size_t sample = 0; sample < 1000; ++sample) {
+    channel->SetChannelValue(static_cast<uint64_t>(sample));
+    writer->SaveSample(*group, tick_time);
+    tick_time += 1'000'000; // 1 ms
+  }
+  writer->StopMeasurement(tick_time);
+  writer->FinalizeMeasurement();
+
+  MdfReader reader(mdf_file.string());
+  ASSERT_TRUE(reader.ReadEverythingButData());
+  auto* dg = reader.GetFile()->Header()->LastDataGroup();
+  ASSERT_TRUE(dg != nullptr);
+  ChannelObserverList observer_list;
+  CreateChannelObserverForDataGroup(*dg, observer_list);
+  ASSERT_TRUE(reader.ReadTimeRange(*dg, 0.1005, 0.2005));
+  reader.Close();
+
+  for (const auto& observer : observer_list) {
+    size_t nof_valid = 0;
+    for (uint64_t sample = 0; sample < observer->NofSamples(); ++sample) {
+      double value = 0;
+      if (!observer->GetEngValue(sample, value)) {
+        continue;
+      }
+      ++nof_valid;
+      EXPECT_GE(sample, 101) << observer->Name();
+      EXPECT_LE(sample, 200) << observer->Name();
+      if (observer->IsMaster()) {
+        EXPECT_GE(value, 0.1005);
+        EXPECT_LE(value, 0.2005);
+      } else {
+        EXPECT_DOUBLE_EQ(value, static_cast<double>(sample));
+      }
+    }
+    EXPECT_EQ(nof_valid, 100) << observer->Name();
+  }
+}
+
+TEST_F(TestWrite, Mdf4CompactValid) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+  path mdf_file(kTestDir);
+  mdf_file.append("compact_valid.mf4");
+
+  auto writer = MdfFactory::CreateMdfWriter(MdfWriterType::Mdf4Basic);
+  writer->Init(mdf_file.string());
+  auto* header = writer->Header();
+  auto* data_group = header->CreateDataGroup();
+  auto* group = data_group->CreateChannelGroup();
+  group->Name("Group");
+  auto* master = group->CreateChannel();
+  master->Name("Time");
+  master->Type(ChannelType::Master);
+  master->Sync(ChannelSyncType::Time);
+  master->DataType(ChannelDataType::FloatLe);
+  master->DataBytes(8);
+  auto* counter = group->CreateChannel();
+  counter->Name("Counter");
+  counter->Type(ChannelType::FixedLength);
+  counter->DataType(ChannelDataType::UnsignedIntegerLe);
+  counter->DataBytes(4);
+  auto* invalid = group->CreateChannel();
+  invalid->Name("Invalid");
+  invalid->Type(ChannelType::FixedLength);
+  invalid->DataType(ChannelDataType::SignedIntegerLe);
+  invalid->DataBytes(2);
+  invalid->Flags(CnFlag::InvalidValid);
+
+  writer->PreTrigTime(0);
+  writer->InitMeasurement();
+  auto tick_time = TimeStampToNs();
+  writer->StartMeasurement(tick_time);
+  for (size_t sample = 0; sample < 1000; ++sample) {
+    counter->SetChannelValue(static_cast<uint64_t>(sample));
+    invalid->SetChannelValue(static_cast<int64_t>(sample), sample % 2 == 0);
+    writer->SaveSample(*group, tick_time);
+    tick_time += 1'000'000; // 1 ms
+  }
+  writer->StopMeasurement(tick_time);
+  writer->FinalizeMeasurement();
+
+  MdfReader reader(mdf_file.string());
+  ASSERT_TRUE(reader.ReadEverythingButData());
+  auto* dg = reader.GetFile()->Header()->LastDataGroup();
+  ASSERT_TRUE(dg != nullptr);
+  ChannelObserverList observer_list;
+  CreateChannelObserverForDataGroup(*dg, observer_list);
+  ASSERT_TRUE(reader.ReadPartialData(*dg, 100, 199));
+  reader.Close();
+
+  for (const auto& observer : observer_list) {
+    const bool has_invalid = observer->Name() == "Invalid";
+    std::vector<double> values;
+    const auto valid_array = observer->GetChannelSamples(values);
+    ASSERT_EQ(values.size(), 1000) << observer->Name();
+    ASSERT_EQ(valid_array.size(), 1000) << observer->Name();
+    size_t nof_valid = 0;
+    for (size_t sample = 0; sample < values.size(); ++sample) {
+      double value = 0;
+      const bool valid = observer->GetChannelValue(sample, value);
+      EXPECT_EQ(valid, valid_array[sample]) << observer->Name();
+      EXPECT_DOUBLE_EQ(value, values[sample]) << observer->Name();
+      if (valid) {
+        ++nof_valid;
+      }
+    }
+    EXPECT_EQ(nof_valid, has_invalid ? 50 : 100) << observer->Name();
+
+    const auto& valid_list = observer->GetValidList();
+    EXPECT_EQ(std::count(valid_list.cbegin(), valid_list.cend(), true),
+              nof_valid) << observer->Name();
+  }
+
+  // The counter values are stored as 32-bit unsigned values.
+  const auto* counter_observer = observer_list[1].get();
+  const auto buffer = counter_observer->GetSampleBuffer<uint32_t>();
+  ASSERT_EQ(buffer.size(), 1000);
+  EXPECT_EQ(buffer[150], 150);
+  EXPECT_EQ(buffer.size(), counter_observer->NofSamples());
+  EXPECT_TRUE(counter_observer->GetSampleBuffer<double>().empty());
+}
+
+TEST_F(TestWrite, Mdf4CompactValidNoKernel) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+  path mdf_file(kTestDir);
+  mdf_file.append("compact_valid_no_kernel.mf4");
+
+  // A 3-byte value has no column kernel, so the sample blocks are decoded
+  // record by record.
+  auto writer = MdfFactory::CreateMdfWriter(MdfWriterType::Mdf4Basic);
+  writer->Init(mdf_file.string());
+  auto* header = writer->Header();
+  auto* data_group = header->CreateDataGroup();
+  auto* group = data_group->CreateChannelGroup();
+  group->Name("Group");
+  auto* master = group->CreateChannel();
+  master->Name("Time");
+  master->Type(ChannelType::Master);
+  master->Sync(ChannelSyncType::Time);
+  master->DataType(ChannelDataType::FloatLe);
+  master->DataBytes(8);
+  auto* counter = group->CreateChannel();
+  counter->Name("Counter");
+  counter->Type(ChannelType::FixedLength);
+  counter->DataType(ChannelDataType::UnsignedIntegerLe);
+  counter->DataBytes(3);
+
+  writer->PreTrigTime(0);
+  writer->InitMeasurement();
+  auto tick_time = TimeStampToNs();
+  writer->StartMeasurement(tick_time);
+  for (size_t sample = 0; sample < 1000; ++sample) {
+    counter->SetChannelValue(static_cast<uint64_t>(sample * 1000));
+    writer->SaveSample(*group, tick_time);
+    tick_time += 1'000'000; // 1 ms
+  }
+  writer->StopMeasurement(tick_time);
+  writer->FinalizeMeasurement();
+
+  MdfReader reader(mdf_file.string());
+  ASSERT_TRUE(reader.ReadEverythingButData());
+  auto* dg = reader.GetFile()->Header()->LastDataGroup();
+  ASSERT_TRUE(dg != nullptr);
+  ChannelObserverList observer_list;
+  CreateChannelObserverForDataGroup(*dg, observer_list);
+  ASSERT_EQ(observer_list.size(), 2);
+  // Note that the sample ranges are one-based.
+  ASSERT_TRUE(reader.ReadPartialData(*dg, 1, 100));
+  ASSERT_TRUE(reader.ReadPartialData(*dg, 501, 600));
+  reader.Close();
+
+  // Values of 3 bytes are stored as 64-bit unsigned values.
+  const auto* counter_observer = dynamic_cast<const detail::ChannelObserver<
+      uint64_t>*>(observer_list[1].get());
+  ASSERT_TRUE(counter_observer != nullptr);
+  EXPECT_TRUE(counter_observer->IsCompactValid());
+  for (size_t sample = 0; sample < counter_observer->NofSamples(); ++sample) {
+    uint64_t value = 0;
+    const bool valid = counter_observer->GetChannelValue(sample, value);
+    const bool expected_valid = sample < 100 || (sample >= 500 && sample < 600);
+    EXPECT_EQ(valid, expected_valid) << sample;
+    if (valid) {
+      EXPECT_EQ(value, sample * 1000) << sample;
+    }
+  }
+  const auto& valid_list = counter_observer->GetValidList();
+  EXPECT_EQ(std::count(valid_list.cbegin(), valid_list.cend(), true), 200);
+}
+
+TEST_F(TestWrite, Mdf4CompactValidUnsorted) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+  path mdf_file(kTestDir);
+  mdf_file.append("compact_valid_unsorted.mf4");
+
+  auto writer = MdfFactory::CreateMdfWriter(MdfWriterType::Mdf4Basic);
+  writer->Init(mdf_file.string());
+  auto* header = writer->Header();
+  auto* data_group = header->CreateDataGroup();
+  // Two channel groups in one data group, so the records are read one by
+  // one.
+  std::array<IChannelGroup*, 2> group_list = {};
+  std::array<IChannel*, 2> counter_list = {};
+  for (size_t index = 0; index < group_list.size(); ++index) {
+    auto* group = data_group->CreateChannelGroup();
+    group->Name("Group" + std::to_string(index + 1));
+    auto* master = group->CreateChannel();
+    master->Name("Time");
+    master->Type(ChannelType::Master);
+    master->Sync(ChannelSyncType::Time);
+    master->DataType(ChannelDataType::FloatLe);
+    master->DataBytes(8);
+    auto* counter = group->CreateChannel();
+    counter->Name("Counter");
+    counter->Type(ChannelType::FixedLength);
+    counter->DataType(ChannelDataType::UnsignedIntegerLe);
+    counter->DataBytes(4);
+    group_list[index] = group;
+    counter_list[index] = counter;
+  }
+
+  writer->PreTrigTime(0);
+  writer->InitMeasurement();
+  auto tick_time = TimeStampToNs();
+  writer->StartMeasurement(tick_time);
+  for (size_t sample = 0; sample < 1000; ++sample) {
+    for (size_t index = 0; index < group_list.size(); ++index) {
+      counter_list[index]->SetChannelValue(
+          static_cast<uint64_t>(sample * (index + 1)));
+      writer->SaveSample(*group_list[index], tick_time);
+    }
+    tick_time += 1'000'000; // 1 ms
+  }
+  writer->StopMeasurement(tick_time);
+  writer->FinalizeMeasurement();
+
+  MdfReader reader(mdf_file.string());
+  ASSERT_TRUE(reader.ReadEverythingButData());
+  auto* dg = reader.GetFile()->Header()->LastDataGroup();
+  ASSERT_TRUE(dg != nullptr);
+  ASSERT_EQ(dg->ChannelGroups().size(), 2);
+  ChannelObserverList observer_list;
+  CreateChannelObserverForDataGroup(*dg, observer_list);
+  ASSERT_EQ(observer_list.size(), 4);
+  ASSERT_TRUE(reader.ReadData(*dg));
+  reader.Close();
+
+  for (size_t index = 0; index < observer_list.size(); ++index) {
+    const auto& observer = observer_list[index];
+    // The master channel is a double and the counter a 32-bit unsigned.
+    const auto* master =
+        dynamic_cast<const detail::ChannelObserver<double>*>(observer.get());
+    const auto* counter =
+        dynamic_cast<const detail::ChannelObserver<uint32_t>*>(observer.get());
+    ASSERT_TRUE(master != nullptr || counter != nullptr) << observer->Name();
+    EXPECT_TRUE(master != nullptr ? master->IsCompactValid()
+                                  : counter->IsCompactValid())
+        << observer->Name();
+
+    ASSERT_EQ(observer->NofSamples(), 1000);
+    const uint64_t factor = index < 2 ? 1 : 2; // Group1 or Group2
+    for (size_t sample = 0; sample < observer->NofSamples(); ++sample) {
+      uint64_t value = 0;
+      EXPECT_TRUE(observer->GetChannelValue(sample, value));
+      if (counter != nullptr) {
+        EXPECT_EQ(value, sample * factor);
+      }
+    }
+    // The valid list is created on request.
+    const auto& valid_list = observer->GetValidList();
+    EXPECT_EQ(std::count(valid_list.cbegin(), valid_list.cend(), true), 1000);
+  }
+}
+
+TEST_F(TestWrite, Mdf4SpanObserver) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+  // One sorted and one unsorted data group. The unsorted data group has
+  // two channel groups.
+  path mdf_file(kTestDir);
+  mdf_file.append("span_observer.mf4");
+
+  auto writer = MdfFactory::CreateMdfWriter(MdfWriterType::Mdf4Basic);
+  writer->Init(mdf_file.string());
+  auto* header = writer->Header();
+  std::vector<IChannelGroup*> group_list;
+  std::vector<IChannel*> counter_list;
+  for (size_t dg_index = 0; dg_index < 2; ++dg_index) {
+    auto* data_group = header->CreateDataGroup();
+    for (size_t cg_index = 0; cg_index <= dg_index; ++cg_index) {
+      auto* group = data_group->CreateChannelGroup();
+      group->Name("Group" + std::to_string(group_list.size() + 1));
+      auto* master = group->CreateChannel();
+      master->Name("Time");
+      master->Type(ChannelType::Master);
+      master->Sync(ChannelSyncType::Time);
+      master->DataType(ChannelDataType::FloatLe);
+      master->DataBytes(8);
+      auto* counter = group->CreateChannel();
+      counter->Name("Counter");
+      counter->Type(ChannelType::FixedLength);
+      counter->DataType(ChannelDataType::UnsignedIntegerLe);
+      counter->DataBytes(4);
+      group_list.push_back(group);
+      counter_list.push_back(counter);
+    }
+  }
+
+  writer->PreTrigTime(0);
+  writer->InitMeasurement();
+  auto tick_time = TimeStampToNs();
+  writer->StartMeasurement(tick_time);
+  for (size_t sample = 0; sample < 1000; ++sample) {
+    for (size_t index = 0; index < group_list.size(); ++index) {
+      counter_list[index]->SetChannelValue(
+          static_cast<uint64_t>(sample * (index + 1)));
+      writer->SaveSample(*group_list[index], tick_time);
+    }
+    tick_time += 1'000'000; // 1 ms
+  }
+  writer->StopMeasurement(tick_time);
+  writer->FinalizeMeasurement();
+
+  MdfReader reader(mdf_file.string());
+  ASSERT_TRUE(reader.ReadEverythingButData());
+  DataGroupList dg_list;
+  reader.GetFile()->DataGroups(dg_list);
+  ASSERT_EQ(dg_list.size(), 2);
+
+  size_t group_index = 0;
+  for (auto* dg : dg_list) {
+    ASSERT_TRUE(dg != nullptr);
+    SpanObserver span_observer(*dg);
+    VectorObserver vector_observer(*dg);
+    ASSERT_TRUE(reader.ReadData(*dg));
+    span_observer.DetachObserver();
+    vector_observer.DetachObserver();
+
+    const auto cg_list = dg->ChannelGroups();
+    ASSERT_EQ(span_observer.sample_list.size(), 1000 * cg_list.size());
+    EXPECT_EQ(span_observer.sample_list, vector_observer.sample_list);
+
+    for (const auto* group : cg_list) {
+      const uint64_t factor = group_index + 1;
+      ++group_index;
+      uint64_t next_sample = 0;
+      for (const auto& [sample, record_id, record] :
+           span_observer.sample_list) {
+        if (record_id != group->RecordId()) {
+          continue;
+        }
+        EXPECT_EQ(sample, next_sample);
+        ++next_sample;
+        // Time (8 bytes) followed by the counter (4 bytes).
+        ASSERT_EQ(record.size(), 12);
+        uint32_t counter = 0;
+        std::memcpy(&counter, record.data() + 8, sizeof(counter));
+        EXPECT_EQ(counter, sample * factor);
+      }
+      EXPECT_EQ(next_sample, 1000);
+    }
+  }
+  reader.Close();
+}
+
+TEST_F(TestWrite, Mdf4ChunkObserver) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+  path mdf_file(kTestDir);
+  mdf_file.append("chunk_observer.mf4");
+
+  auto writer = MdfFactory::CreateMdfWriter(MdfWriterType::Mdf4Basic);
+  writer->Init(mdf_file.string());
+  auto* header = writer->Header();
+  auto* data_group = header->CreateDataGroup();
+  auto* group = data_group->CreateChannelGroup();
+  group->Name("Group");
+  auto* master = group->CreateChannel();
+  master->Name("Time");
+  master->Type(ChannelType::Master);
+  master->Sync(ChannelSyncType::Time);
+  master->DataType(ChannelDataType::FloatLe);
+  master->DataBytes(8);
+  auto* counter = group->CreateChannel();
+  counter->Name("Counter");
+  counter->Type(ChannelType::FixedLength);
+  counter->DataType(ChannelDataType::UnsignedIntegerLe);
+  counter->DataBytes(4);
+  auto* cc = counter->CreateChannelConversion();
+  cc->Type(ConversionType::Linear);
+  cc->Parameter(0, 1.0);
+  cc->Parameter(1, 0.5);
+
+  writer->PreTrigTime(0);
+  writer->InitMeasurement();
+  auto tick_time = TimeStampToNs();
+  writer->StartMeasurement(tick_time);
+  for (size_t sample = 0; sample < 1000; ++sample) {
+    counter->SetChannelValue(static_cast<uint64_t>(sample));
+    writer->SaveSample(*group, tick_time);
+    tick_time += 1'000'000; // 1 ms
+  }
+  writer->StopMeasurement(tick_time);
+  writer->FinalizeMeasurement();
+
+  MdfReader reader(mdf_file.string());
+  ASSERT_TRUE(reader.ReadEverythingButData());
+  auto* dg = reader.GetFile()->Header()->LastDataGroup();
+  ASSERT_TRUE(dg != nullptr);
+  const auto* cg = dg->GetChannelGroup("Group");
+  ASSERT_TRUE(cg != nullptr);
+  const auto* cn = cg->GetChannel("Counter");
+  ASSERT_TRUE(cn != nullptr);
+
+  std::vector<uint64_t> first_list;
+  double sum = 0.0;
+  size_t nof_values = 0;
+  {
+    ChannelChunkObserver observer(*dg, *cg, *cn, 300);
+    observer.OnChunk = [&] (uint64_t first_sample, Span<const double> values,
+                            Span<const uint8_t> valid) -> bool {
+      EXPECT_EQ(values.size(), valid.size());
+      for (size_t index = 0; index < values.size(); ++index) {
+        EXPECT_EQ(valid[index], 1);
+        EXPECT_DOUBLE_EQ(values[index],
+                         1.0 + (0.5 * static_cast<double>(first_sample + index)));
+        sum += values[index];
+      }
+      first_list.push_back(first_sample);
+      nof_values += values.size();
+      return true;
+    };
+    ASSERT_TRUE(reader.ReadData(*dg));
+  }
+  EXPECT_EQ(first_list, std::vector<uint64_t>({0, 300, 600, 900}));
+  EXPECT_EQ(nof_values, 1000);
+  EXPECT_DOUBLE_EQ(sum, 1000.0 + (0.5 * 999.0 * 1000.0 / 2));
+
+  // A partial read needs a flush of the last chunk.
+  first_list.clear();
+  nof_values = 0;
+  {
+    ChannelChunkObserver observer(*dg, *cg, *cn, 64);
+    observer.ConvertValues(false);
+    observer.OnChunk = [&] (uint64_t first_sample, Span<const double> values,
+                            Span<const uint8_t> ) -> bool {
+      for (size_t index = 0; index < values.size(); ++index) {
+        EXPECT_DOUBLE_EQ(values[index],
+                         static_cast<double>(first_sample + index));
+      }
+      first_list.push_back(first_sample);
+      nof_values += values.size();
+      return true;
+    };
+    ASSERT_TRUE(reader.ReadPartialData(*dg, 100, 199));
+    EXPECT_TRUE(observer.Flush());
+  }
+  EXPECT_EQ(first_list.size(), 2);
+  EXPECT_EQ(nof_values, 100);
+  reader.Close();
+}
+
+TEST_F(TestWrite, Mdf4VlsdOnDemand) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+  path mdf_file(kTestDir);
+  mdf_file.append("vlsd_on_demand.mf4");
+
+  for (const bool compress : {false, true}) {
+    auto writer = MdfFactory::CreateMdfWriter(MdfWriterType::Mdf4Basic);
+    writer->Init(mdf_file.string());
+    writer->CompressData(compress);
+    auto* header = writer->Header();
+    auto* data_group = header->CreateDataGroup();
+    auto* group = data_group->CreateChannelGroup();
+    group->Name("Group");
+    auto* master = group->CreateChannel();
+    master->Name("Time");
+    master->Type(ChannelType::Master);
+    master->Sync(ChannelSyncType::Time);
+    master->DataType(ChannelDataType::FloatLe);
+    master->DataBytes(8);
+    auto* text = group->CreateChannel();
+    text->Name("Text");
+    text->Type(ChannelType::VariableLength); // Store in SD block
+    text->DataType(ChannelDataType::StringUTF8);
+
+    writer->PreTrigTime(0);
+    writer->InitMeasurement();
+    auto tick_time = TimeStampToNs();
+    writer->StartMeasurement(tick_time);
+    for (size_t sample = 0; sample < 1000; ++sample) {
+      text->SetChannelValue("Text " + std::to_string(sample));
+      writer->SaveSample(*group, tick_time);
+      tick_time += 1'000'000; // 1 ms
+    }
+    writer->StopMeasurement(tick_time);
+    writer->FinalizeMeasurement();
+
+    // Read the signal data through a memory mapped file and a file buffer.
+    for (const bool mapped : {true, false}) {
+      std::unique_ptr<MdfReader> reader;
+      if (mapped) {
+        reader = std::make_unique<MdfReader>(mdf_file.string());
+      } else {
+        auto file_buffer = std::make_shared<std::filebuf>();
+        file_buffer->open(mdf_file.string(),
+                          std::ios_base::in | std::ios_base::binary);
+        std::shared_ptr<std::streambuf> buffer = file_buffer;
+        reader = std::make_unique<MdfReader>(buffer);
+      }
+      ASSERT_TRUE(reader->ReadEverythingButData());
+      auto* dg = reader->GetFile()->Header()->LastDataGroup();
+      ASSERT_TRUE(dg != nullptr);
+      ChannelObserverList observer_list;
+      CreateChannelObserverForDataGroup(*dg, observer_list);
+      ASSERT_TRUE(reader->ReadData(*dg));
+      reader->Close();
+
+      const auto& observer = observer_list[1];
+      ASSERT_EQ(observer->NofSamples(), 1000);
+      for (size_t sample = 0; sample < observer->NofSamples(); ++sample) {
+        std::string value;
+        EXPECT_TRUE(observer->GetChannelValue(sample, value));
+        EXPECT_EQ(value, "Text " + std::to_string(sample));
+      }
+    }
+  }
+}
+
+TEST_F(TestWrite, Mdf4LazyMetadata) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+  path mdf_file(kTestDir);
+  mdf_file.append("lazy_metadata.mf4");
+
+  {
+    auto writer = MdfFactory::CreateMdfWriter(MdfWriterType::Mdf4Basic);
+    writer->Init(mdf_file.string());
+    auto* header = writer->Header();
+    auto* data_group = header->CreateDataGroup();
+    auto* group = data_group->CreateChannelGroup();
+    group->Name("Group");
+    auto* master = group->CreateChannel();
+    master->Name("Time");
+    master->Type(ChannelType::Master);
+    master->Sync(ChannelSyncType::Time);
+    master->DataType(ChannelDataType::FloatLe);
+    master->DataBytes(8);
+    for (size_t index = 0; index < 10; ++index) {
+      auto* channel = group->CreateChannel();
+      channel->Name("Channel" + std::to_string(index));
+      channel->Description("Description " + std::to_string(index));
+      channel->Unit("U" + std::to_string(index));
+      channel->DataType(ChannelDataType::UnsignedIntegerLe);
+      channel->DataBytes(4);
+      auto* conversion = channel->CreateChannelConversion();
+      conversion->Type(ConversionType::Linear);
+      conversion->Parameter(0, static_cast<double>(index));
+      conversion->Parameter(1, 2.0);
+      auto* source = channel->CreateSourceInformation();
+      source->Name("ECU" + std::to_string(index));
+    }
+
+    writer->PreTrigTime(0);
+    writer->InitMeasurement();
+    auto tick_time = TimeStampToNs();
+    writer->StartMeasurement(tick_time);
+    for (size_t sample = 0; sample < 100; ++sample) {
+      for (auto* channel : group->Channels()) {
+        channel->SetChannelValue(sample);
+      }
+      writer->SaveSample(*group, tick_time);
+      tick_time += 1'000'000; // 1 ms
+    }
+    writer->StopMeasurement(tick_time);
+    writer->FinalizeMeasurement();
+  }
+
+  MdfReader reader(mdf_file.string());
+  reader.LazyMetadata(true);
+  ASSERT_TRUE(reader.ReadEverythingButData());
+  reader.Close();
+  auto* dg = reader.GetFile()->Header()->LastDataGroup();
+  ASSERT_TRUE(dg != nullptr);
+  auto* cg = dg->GetChannelGroup("Group");
+  ASSERT_TRUE(cg != nullptr);
+
+  // The metadata is read when the channel is accessed. The file is closed.
+  auto* channel = cg->GetChannel("Channel3");
+  ASSERT_TRUE(channel != nullptr);
+  EXPECT_EQ(channel->Unit(), "U3");
+  EXPECT_EQ(channel->Description(), "Description 3");
+  const auto* conversion = channel->ChannelConversion();
+  ASSERT_TRUE(conversion != nullptr);
+  EXPECT_DOUBLE_EQ(conversion->Parameter(0), 3.0);
+  const auto* source = channel->SourceInformation();
+  ASSERT_TRUE(source != nullptr);
+  EXPECT_EQ(source->Name(), "ECU3");
+
+  // The remaining channels are read together with the data.
+  ChannelObserverList observer_list;
+  CreateChannelObserverForDataGroup(*dg, observer_list);
+  ASSERT_TRUE(reader.ReadData(*dg));
+  reader.Close();
+  for (const auto& observer : observer_list) {
+    const auto& cn = observer->Channel();
+    if (cn.Type() == ChannelType::Master) {
+      continue;
+    }
+    const auto index = cn.Name().substr(7);
+    EXPECT_EQ(cn.Unit(), "U" + index);
+    EXPECT_EQ(cn.Description(), "Description " + index);
+    ASSERT_TRUE(cn.ChannelConversion() != nullptr);
+    ASSERT_EQ(observer->NofSamples(), 100);
+    double value = 0;
+    EXPECT_TRUE(observer->GetEngValue(10, value));
+    EXPECT_DOUBLE_EQ(value, std::stod(index) + 20.0);
+  }
+}
+
+TEST_F(TestWrite, Mdf4ChannelIndex) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+  path mdf_file(kTestDir);
+  mdf_file.append("channel_index.mf4");
+
+  {
+    auto writer = MdfFactory::CreateMdfWriter(MdfWriterType::Mdf4Basic);
+    writer->Init(mdf_file.string());
+    auto* header = writer->Header();
+    auto* data_group = header->CreateDataGroup();
+    std::vector<IChannelGroup*> group_list;
+    for (const std::string name : {"Slow", "Fast"}) {
+      auto* group = data_group->CreateChannelGroup();
+      group->Name(name);
+      auto* master = group->CreateChannel();
+      master->Name("Time");
+      master->Type(ChannelType::Master);
+      master->Sync(ChannelSyncType::Time);
+      master->DataType(ChannelDataType::FloatLe);
+      master->DataBytes(8);
+      auto* speed = group->CreateChannel();
+      speed->Name("Speed");
+      speed->DataType(ChannelDataType::UnsignedIntegerLe);
+      speed->DataBytes(4);
+      auto* other = group->CreateChannel();
+      other->Name(name + "Counter");
+      other->DataType(ChannelDataType::UnsignedIntegerLe);
+      other->DataBytes(4);
+      CnComment cn_comment;
+      cn_comment.Names().AddAlternativeName(name + "Alias");
+      other->SetCnComment(cn_comment);
+      group_list.push_back(group);
+    }
+
+    writer->PreTrigTime(0);
+    writer->InitMeasurement();
+    auto tick_time = TimeStampToNs();
+    writer->StartMeasurement(tick_time);
+    for (size_t sample = 0; sample < 100; ++sample) {
+      for (auto* group : group_list) {
+        if (group->Name() == "Slow" && sample % 10 != 0) {
+          continue;
+        }
+        for (auto* channel : group->Channels()) {
+          channel->SetChannelValue(sample);
+        }
+        writer->SaveSample(*group, tick_time);
+      }
+      tick_time += 1'000'000; // 1 ms
+    }
+    writer->StopMeasurement(tick_time);
+    writer->FinalizeMeasurement();
+  }
+
+  MdfReader reader(mdf_file.string());
+  ASSERT_TRUE(reader.ReadEverythingButData());
+  auto* index = reader.GetChannelIndex();
+  ASSERT_TRUE(index != nullptr);
+
+  EXPECT_EQ(index->FindAll("speed").size(), 2);
+  ChannelIndexItem item;
+  ASSERT_TRUE(index->Find("SPEED", item));
+  EXPECT_EQ(item.ChannelGroup->Name(), "Fast");
+  EXPECT_EQ(item.ChannelGroup->NofSamples(), 100);
+  EXPECT_FALSE(index->Find("FastAlias", item));
+
+  index->IndexAlternativeNames(true);
+  ASSERT_TRUE(index->Find("FastAlias", item));
+  EXPECT_EQ(item.Channel->Name(), "FastCounter");
+  ASSERT_TRUE(index->Find("SlowCounter", item));
+  EXPECT_EQ(item.ChannelGroup->Name(), "Slow");
+
+  const std::vector<std::string> name_list = {"Speed", "SlowAlias", "Unknown",
+                                              "speed", "FastCounter"};
+  auto observer_list = CreateChannelObservers(*index, name_list);
+  ASSERT_EQ(observer_list.size(), 1);
+  ASSERT_EQ(observer_list[0].ObserverList.size(), 3);
+
+  DataGroupList dg_list;
+  for (const auto& group : observer_list) {
+    dg_list.push_back(group.DataGroup);
+  }
+  ASSERT_TRUE(reader.ReadDataParallel(dg_list));
+  reader.Close();
+
+  for (const auto& observer : observer_list[0].ObserverList) {
+    const bool slow = observer->Name() == "SlowCounter";
+    ASSERT_EQ(observer->NofSamples(), slow ? 10 : 100) << observer->Name();
+    uint64_t value = 0;
+    EXPECT_TRUE(observer->GetChannelValue(5, value));
+    EXPECT_EQ(value, slow ? 50 : 5) << observer->Name();
+  }
+}
+
+TEST_F(TestWrite, Mdf4ReadDataParallel) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+  path mdf_file(kTestDir);
+  mdf_file.append("read_parallel.mf4");
+
+  auto writer = MdfFactory::CreateMdfWriter(MdfWriterType::Mdf4Basic);
+  writer->Init(mdf_file.string());
+  auto* header = writer->Header();
+  for (size_t measurement = 0; measurement < 4; ++measurement) {
+    auto* data_group = header->CreateDataGroup();
+    auto* group1 = data_group->CreateChannelGroup();
+    group1->Name("Group1");
+    auto* master = group1->CreateChannel();
+    master->Name("Time");
+    master->Type(ChannelType::Master);
+    master->Sync(ChannelSyncType::Time);
+    master->DataType(ChannelDataType::FloatLe);
+    master->DataBytes(8);
+    auto* counter = group1->CreateChannel();
+    counter->Name("Counter");
+    counter->Type(ChannelType::FixedLength);
+    counter->DataType(ChannelDataType::UnsignedIntegerLe);
+    counter->DataBytes(4);
+    auto* cc = counter->CreateChannelConversion();
+    cc->Type(ConversionType::Linear);
+    cc->Parameter(0, static_cast<double>(measurement));
+    cc->Parameter(1, 0.5);
+    auto* text = group1->CreateChannel();
+    text->Name("Text");
+    text->Type(ChannelType::VariableLength);
+    text->DataType(ChannelDataType::StringUTF8);
+
+    // Every second data group has two channel groups, i.e. unsorted data.
+    IChannelGroup* group2 = nullptr;
+    IChannel* motorola = nullptr;
+    if (measurement % 2 == 1) {
+      group2 = data_group->CreateChannelGroup();
+      group2->Name("Group2");
+      motorola = group2->CreateChannel();
+      motorola->Name("Motorola64");
+      motorola->Type(ChannelType::FixedLength);
+      motorola->DataType(ChannelDataType::FloatBe);
+      motorola->DataBytes(8);
+    }
+
+    writer->PreTrigTime(0);
+    writer->InitMeasurement();
+    auto tick_time = TimeStampToNs();
+    writer->StartMeasurement(tick_time);
+    for (size_t sample = 0; sample < 1000; ++sample) {
+      counter->SetChannelValue(static_cast<uint64_t>(sample * measurement));
+      text->SetChannelValue("Text " + std::to_string(sample));
+      writer->SaveSample(*group1, tick_time);
+      if (group2 != nullptr) {
+        motorola->SetChannelValue(static_cast<double>(sample) + 0.25);
+        writer->SaveSample(*group2, tick_time);
+      }
+      tick_time += 1'000'000; // 1 ms
+    }
+    writer->StopMeasurement(tick_time);
+    writer->FinalizeMeasurement();
+  }
+
+  // Reference read. One data group at the time.
+  MdfReader serial_reader(mdf_file.string());
+  serial_reader.LazyMetadata(true);
+  ASSERT_TRUE(serial_reader.ReadEverythingButData());
+  ChannelObserverList serial_list;
+  for (auto* dg : serial_reader.GetHeader()->DataGroups()) {
+    CreateChannelObserverForDataGroup(*dg, serial_list);
+    ASSERT_TRUE(serial_reader.ReadData(*dg));
+  }
+  serial_reader.Close();
+
+  // Force more threads than data groups, so the thread budget is shared.
+  MdfReader parallel_reader(mdf_file.string());
+  parallel_reader.LazyMetadata(true);
+  parallel_reader.ReadThreads(8);
+  ASSERT_TRUE(parallel_reader.ReadEverythingButData());
+  const auto dg_list = parallel_reader.GetHeader()->DataGroups();
+  ASSERT_EQ(dg_list.size(), 4);
+  ChannelObserverList parallel_list;
+  for (auto* dg : dg_list) {
+    CreateChannelObserverForDataGroup(*dg, parallel_list);
+  }
+  ASSERT_TRUE(parallel_reader.ReadDataParallel(dg_list));
+  parallel_reader.Close();
+
+  ASSERT_EQ(parallel_list.size(), serial_list.size());
+  for (size_t index = 0; index < parallel_list.size(); ++index) {
+    const auto& expected = serial_list[index];
+    const auto& actual = parallel_list[index];
+    ASSERT_EQ(actual->Name(), expected->Name());
+    ASSERT_EQ(actual->NofSamples(), 1000) << actual->Name();
+    ASSERT_EQ(actual->NofSamples(), expected->NofSamples());
+    for (size_t sample = 0; sample < actual->NofSamples(); ++sample) {
+      std::string expected_value;
+      std::string actual_value;
+      const bool expected_valid =
+          expected->GetChannelValue(sample, expected_value);
+      EXPECT_EQ(actual->GetChannelValue(sample, actual_value), expected_valid)
+          << actual->Name();
+      EXPECT_EQ(actual_value, expected_value) << actual->Name();
+      EXPECT_EQ(actual->EngValueToString(sample),
+                expected->EngValueToString(sample)) << actual->Name();
+    }
+  }
+}
+
+TEST_F(TestWrite, Mdf4ParallelSortedParse) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+  path mdf_file(kTestDir);
+  mdf_file.append("parallel_sorted.mf4");
+
+  // The data must be larger than 2 x 16 MB to be parsed by several threads.
+  constexpr size_t kNofSamples = 1'400'000;
+  auto writer = MdfFactory::CreateMdfWriter(MdfWriterType::Mdf4Basic);
+  writer->Init(mdf_file.string());
+  writer->CompressData(true); // Many DZ blocks
+  auto* header = writer->Header();
+  auto* data_group = header->CreateDataGroup();
+  auto* group = data_group->CreateChannelGroup();
+  group->Name("Group");
+  auto* master = group->CreateChannel();
+  master->Name("Time");
+  master->Type(ChannelType::Master);
+  master->Sync(ChannelSyncType::Time);
+  master->DataType(ChannelDataType::FloatLe);
+  master->DataBytes(8);
+  auto* counter = group->CreateChannel();
+  counter->Name("Counter");
+  counter->Type(ChannelType::FixedLength);
+  counter->DataType(ChannelDataType::UnsignedIntegerLe);
+  counter->DataBytes(4);
+  auto* motorola = group->CreateChannel();
+  motorola->Name("Motorola64");
+  motorola->Type(ChannelType::FixedLength);
+  motorola->DataType(ChannelDataType::FloatBe);
+  motorola->DataBytes(8);
+  auto* invalid = group->CreateChannel();
+  invalid->Name("Invalid");
+  invalid->Type(ChannelType::FixedLength);
+  invalid->DataType(ChannelDataType::SignedIntegerLe);
+  invalid->DataBytes(4);
+  invalid->Flags(CnFlag::InvalidValid);
+
+  writer->PreTrigTime(0);
+  writer->InitMeasurement();
+  auto tick_time = TimeStampToNs();
+  writer->StartMeasurement(tick_time);
+  for (size_t sample = 0; sample < kNofSamples; ++sample) {
+    counter->SetChannelValue(static_cast<uint64_t>(sample));
+    motorola->SetChannelValue(static_cast<double>(sample) * 0.5);
+    invalid->SetChannelValue(-static_cast<int64_t>(sample), sample % 3 != 0);
+    writer->SaveSample(*group, tick_time);
+    tick_time += 1'000'000; // 1 ms
+  }
+  writer->StopMeasurement(tick_time);
+  writer->FinalizeMeasurement();
+
+  // Parse in the calling thread, then with several threads.
+  // The observers must be deleted before the readers.
+  std::array<std::unique_ptr<MdfReader>, 2> readers;
+  std::array<ChannelObserverList, 2> observer_lists;
+  for (size_t index = 0; index < readers.size(); ++index) {
+    auto& reader = readers[index];
+    reader = std::make_unique<MdfReader>(mdf_file.string());
+    reader->ReadThreads(index == 0 ? 1 : 4);
+    ASSERT_TRUE(reader->ReadEverythingButData());
+    auto* dg = reader->GetFile()->Header()->LastDataGroup();
+    ASSERT_TRUE(dg != nullptr);
+    ASSERT_GT(dg->ChannelGroups().size(), 0);
+    CreateChannelObserverForDataGroup(*dg, observer_lists[index]);
+    ASSERT_TRUE(reader->ReadData(*dg));
+    reader->Close();
+  }
+
+  const auto& serial_list = observer_lists[0];
+  const auto& parallel_list = observer_lists[1];
+  ASSERT_EQ(serial_list.size(), 4);
+  ASSERT_EQ(parallel_list.size(), serial_list.size());
+  for (size_t index = 0; index < serial_list.size(); ++index) {
+    const auto& expected = serial_list[index];
+    const auto& actual = parallel_list[index];
+    ASSERT_EQ(expected->NofSamples(), kNofSamples) << expected->Name();
+    ASSERT_EQ(actual->NofSamples(), kNofSamples) << actual->Name();
+    size_t nof_errors = 0;
+    for (size_t sample = 0; sample < kNofSamples && nof_errors < 10;
+         ++sample) {
+      double expected_value = 0;
+      double actual_value = 0;
+      const bool expected_valid =
+          expected->GetChannelValue(sample, expected_value);
+      const bool actual_valid = actual->GetChannelValue(sample, actual_value);
+      if (expected_valid != actual_valid || expected_value != actual_value) {
+        ++nof_errors;
+        ADD_FAILURE() << actual->Name() << ", Sample: " << sample;
+      }
+    }
+  }
+}
+
+TEST_F(TestWrite, Mdf4ParallelSortedTruncated) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+  path mdf_file(kTestDir);
+  mdf_file.append("parallel_sorted_truncated.mf4");
+
+  // One DT block larger than 2 x 16 MB. The DT block is the last block in
+  // the file, so the truncated file has a DT block that is larger than the
+  // file.
+  constexpr size_t kNofSamples = 600'000;
+  constexpr size_t kNofChannels = 7;
+  auto writer = MdfFactory::CreateMdfWriter(MdfWriterType::Mdf4Basic);
+  writer->Init(mdf_file.string());
+  writer->CompressData(false);
+  auto* header = writer->Header();
+  auto* data_group = header->CreateDataGroup();
+  auto* group = data_group->CreateChannelGroup();
+  group->Name("Group");
+  auto* master = group->CreateChannel();
+  master->Name("Time");
+  master->Type(ChannelType::Master);
+  master->Sync(ChannelSyncType::Time);
+  master->DataType(ChannelDataType::FloatLe);
+  master->DataBytes(8);
+  std::vector<IChannel*> channel_list;
+  for (size_t index = 0; index < kNofChannels; ++index) {
+    auto* channel = group->CreateChannel();
+    channel->Name("Channel" + std::to_string(index));
+    channel->Type(ChannelType::FixedLength);
+    channel->DataType(ChannelDataType::FloatLe);
+    channel->DataBytes(8);
+    channel_list.push_back(channel);
+  }
+
+  writer->PreTrigTime(0);
+  writer->InitMeasurement();
+  auto tick_time = TimeStampToNs();
+  writer->StartMeasurement(tick_time);
+  for (size_t sample = 0; sample < kNofSamples; ++sample) {
+    for (size_t index = 0; index < channel_list.size(); ++index) {
+      channel_list[index]->SetChannelValue(
+          static_cast<double>(sample) * static_cast<double>(index + 1));
+    }
+    writer->SaveSample(*group, tick_time);
+    tick_time += 1'000'000; // 1 ms
+  }
+  writer->StopMeasurement(tick_time);
+  writer->FinalizeMeasurement();
+  resize_file(mdf_file, file_size(mdf_file) - 1'000'003);
+
+  // The parallel read shall fall back on the serial read.
+  // The observers must be deleted before the readers.
+  std::array<std::unique_ptr<MdfReader>, 2> readers;
+  std::array<ChannelObserverList, 2> observer_lists;
+  for (size_t index = 0; index < readers.size(); ++index) {
+    auto& reader = readers[index];
+    reader = std::make_unique<MdfReader>(mdf_file.string());
+    reader->ReadThreads(index == 0 ? 1 : 4);
+    ASSERT_TRUE(reader->ReadEverythingButData());
+    auto* dg = reader->GetFile()->Header()->LastDataGroup();
+    ASSERT_TRUE(dg != nullptr);
+    CreateChannelObserverForDataGroup(*dg, observer_lists[index]);
+    reader->ReadData(*dg);
+    reader->Close();
+  }
+
+  const auto& serial_list = observer_lists[0];
+  const auto& parallel_list = observer_lists[1];
+  ASSERT_EQ(serial_list.size(), kNofChannels + 1);
+  ASSERT_EQ(parallel_list.size(), serial_list.size());
+  for (size_t index = 0; index < serial_list.size(); ++index) {
+    const auto& expected = serial_list[index];
+    const auto& actual = parallel_list[index];
+    ASSERT_EQ(actual->NofSamples(), expected->NofSamples());
+    size_t nof_valid = 0;
+    size_t nof_errors = 0;
+    for (size_t sample = 0; sample < actual->NofSamples() && nof_errors < 10;
+         ++sample) {
+      double expected_value = 0;
+      double actual_value = 0;
+      const bool expected_valid =
+          expected->GetChannelValue(sample, expected_value);
+      const bool actual_valid = actual->GetChannelValue(sample, actual_value);
+      if (expected_valid != actual_valid || expected_value != actual_value) {
+        ++nof_errors;
+        ADD_FAILURE() << actual->Name() << ", Sample: " << sample;
+      }
+      if (actual_valid) {
+        ++nof_valid;
+        if (index > 0 && actual_value != static_cast<double>(sample) *
+                                         static_cast<double>(index)) {
+          ++nof_errors;
+          ADD_FAILURE() << actual->Name() << ", Sample: " << sample;
+        }
+      }
+    }
+    // The samples in the missing part of the file aren't valid.
+    EXPECT_GT(nof_valid, 0) << actual->Name();
+    EXPECT_LT(nof_valid, kNofSamples) << actual->Name();
+  }
+}
+
+TEST_F(TestWrite, Mdf4InflateReadAhead) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+  path mdf_file(kTestDir);
+  mdf_file.append("inflate_read_ahead.mf4");
+
+  // About 20 MB of data, that is 5-6 DZ blocks.
+  constexpr size_t kNofSamples = 160'000;
+  constexpr size_t kNofChannels = 15;
+  auto writer = MdfFactory::CreateMdfWriter(MdfWriterType::Mdf4Basic);
+  writer->Init(mdf_file.string());
+  writer->CompressData(true);
+  auto* header = writer->Header();
+  auto* data_group = header->CreateDataGroup();
+  auto* group = data_group->CreateChannelGroup();
+  group->Name("Group");
+  auto* master = group->CreateChannel();
+  master->Name("Time");
+  master->Type(ChannelType::Master);
+  master->Sync(ChannelSyncType::Time);
+  master->DataType(ChannelDataType::FloatLe);
+  master->DataBytes(8);
+  std::vector<IChannel*> channel_list;
+  for (size_t index = 0; index < kNofChannels; ++index) {
+    auto* channel = group->CreateChannel();
+    channel->Name("Channel" + std::to_string(index));
+    channel->Type(ChannelType::FixedLength);
+    channel->DataType(ChannelDataType::FloatLe);
+    channel->DataBytes(8);
+    channel_list.push_back(channel);
+  }
+
+  writer->PreTrigTime(0);
+  writer->InitMeasurement();
+  auto tick_time = TimeStampToNs();
+  writer->StartMeasurement(tick_time);
+  for (size_t sample = 0; sample < kNofSamples; ++sample) {
+    for (size_t index = 0; index < channel_list.size(); ++index) {
+      channel_list[index]->SetChannelValue(
+          static_cast<double>(sample) * static_cast<double>(index + 1));
+    }
+    writer->SaveSample(*group, tick_time);
+    tick_time += 1'000'000; // 1 ms
+  }
+  writer->StopMeasurement(tick_time);
+  writer->FinalizeMeasurement();
+
+  // Read the file with and without the DZ read-ahead. The partial reads
+  // starts at the end of the file, so the read-ahead must restart on each
+  // read.
+  struct ReadTest {
+    unsigned ReadThreads;
+    bool Partial;
+  };
+  const std::vector<ReadTest> test_list = {
+      {1, false}, {4, false}, {1, true}, {4, true}};
+  std::vector<std::unique_ptr<MdfReader>> reader_list;
+  std::vector<ChannelObserverList> observer_lists(test_list.size());
+  for (size_t test = 0; test < test_list.size(); ++test) {
+    auto& reader = reader_list.emplace_back(
+        std::make_unique<MdfReader>(mdf_file.string()));
+    reader->ReadThreads(test_list[test].ReadThreads);
+    ASSERT_TRUE(reader->ReadEverythingButData());
+    auto* dg = reader->GetFile()->Header()->LastDataGroup();
+    ASSERT_TRUE(dg != nullptr);
+    CreateChannelObserverForDataGroup(*dg, observer_lists[test]);
+    if (!test_list[test].Partial) {
+      ASSERT_TRUE(reader->ReadData(*dg));
+    } else {
+      // Note that the sample range of a partial read is one-based.
+      constexpr size_t kNofParts = 7;
+      constexpr size_t kPartSize = (kNofSamples + kNofParts - 1) / kNofParts;
+      for (size_t part = kNofParts; part > 0; --part) {
+        const size_t min_sample = ((part - 1) * kPartSize) + 1;
+        const size_t max_sample = std::min(part * kPartSize, kNofSamples);
+        ASSERT_TRUE(reader->ReadPartialData(*dg, min_sample, max_sample));
+      }
+    }
+    reader->Close();
+  }
+
+  const auto& expected_list = observer_lists[0];
+  ASSERT_EQ(expected_list.size(), kNofChannels + 1);
+  for (size_t test = 0; test < test_list.size(); ++test) {
+    const auto& observer_list = observer_lists[test];
+    ASSERT_EQ(observer_list.size(), expected_list.size());
+    for (size_t index = 0; index < observer_list.size(); ++index) {
+      const auto& expected = expected_list[index];
+      const auto& observer = observer_list[index];
+      ASSERT_EQ(observer->NofSamples(), kNofSamples);
+      size_t nof_errors = 0;
+      for (size_t sample = 0; sample < kNofSamples && nof_errors < 10;
+           ++sample) {
+        double value = 0;
+        double expected_value = 0;
+        const bool valid = observer->GetChannelValue(sample, value);
+        const bool expected_valid =
+            expected->GetChannelValue(sample, expected_value);
+        if (!valid || valid != expected_valid || value != expected_value) {
+          ++nof_errors;
+          ADD_FAILURE() << "Test: " << test << ", Channel: "
+                        << observer->Name() << ", Sample: " << sample;
+        }
+      }
+    }
+  }
+  // The channel values are known.
+  double value = 0;
+  ASSERT_TRUE(expected_list[3]->GetChannelValue(kNofSamples - 1, value));
+  EXPECT_DOUBLE_EQ(value, static_cast<double>(kNofSamples - 1) * 3.0);
+}
+
+TEST_F(TestWrite, Mdf4PartialSortedRead) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+  // About 9 MB of data, that is 3 DZ blocks if compressed.
+  constexpr size_t kNofSamples = 120'000;
+  constexpr size_t kNofChannels = 8;
+  for (const bool compress : {false, true}) {
+    path mdf_file(kTestDir);
+    mdf_file.append(compress ? "partial_sorted_dz.mf4"
+                             : "partial_sorted_dt.mf4");
+    auto writer = MdfFactory::CreateMdfWriter(MdfWriterType::Mdf4Basic);
+    writer->Init(mdf_file.string());
+    writer->CompressData(compress);
+    auto* header = writer->Header();
+    auto* data_group = header->CreateDataGroup();
+    auto* group = data_group->CreateChannelGroup();
+    group->Name("Group");
+    auto* master = group->CreateChannel();
+    master->Name("Time");
+    master->Type(ChannelType::Master);
+    master->Sync(ChannelSyncType::Time);
+    master->DataType(ChannelDataType::FloatLe);
+    master->DataBytes(8);
+    std::vector<IChannel*> channel_list;
+    for (size_t index = 0; index < kNofChannels; ++index) {
+      auto* channel = group->CreateChannel();
+      channel->Name("Channel" + std::to_string(index));
+      channel->Type(ChannelType::FixedLength);
+      channel->DataType(ChannelDataType::FloatLe);
+      channel->DataBytes(8);
+      channel_list.push_back(channel);
+    }
+
+    writer->PreTrigTime(0);
+    writer->InitMeasurement();
+    auto tick_time = TimeStampToNs();
+    writer->StartMeasurement(tick_time);
+    for (size_t sample = 0; sample < kNofSamples; ++sample) {
+      for (size_t index = 0; index < channel_list.size(); ++index) {
+        channel_list[index]->SetChannelValue(
+            static_cast<double>(sample) * static_cast<double>(index + 1));
+      }
+      writer->SaveSample(*group, tick_time);
+      tick_time += 1'000'000; // 1 ms
+    }
+    writer->StopMeasurement(tick_time);
+    writer->FinalizeMeasurement();
+
+    // The uncompressed file is also read through a stream buffer with the
+    // smallest read window.
+    for (const bool stream : {false, true}) {
+      if (compress && stream) {
+        continue;
+      }
+      std::unique_ptr<MdfReader> reader;
+      if (stream) {
+        auto buffer = std::make_shared<std::filebuf>();
+        ASSERT_TRUE(buffer->open(mdf_file.string(),
+                                 std::ios_base::in | std::ios_base::binary));
+        reader = std::make_unique<MdfReader>(buffer);
+        reader->ReadBufferSize(1'000'000);
+      } else {
+        reader = std::make_unique<MdfReader>(mdf_file.string());
+      }
+      ASSERT_TRUE(reader->ReadEverythingButData());
+      auto* dg = reader->GetFile()->Header()->LastDataGroup();
+      ASSERT_TRUE(dg != nullptr);
+
+      // The partial reads are compared with slices of a full read.
+      std::vector<std::vector<double>> expected_list;
+      {
+        ChannelObserverList observer_list;
+        CreateChannelObserverForDataGroup(*dg, observer_list);
+        ASSERT_TRUE(reader->ReadData(*dg));
+        for (const auto& observer : observer_list) {
+          auto& values = expected_list.emplace_back();
+          observer->GetChannelSamples(values);
+          ASSERT_EQ(values.size(), kNofSamples);
+        }
+      }
+      ASSERT_EQ(expected_list.size(), kNofChannels + 1);
+
+      // Note that the sample range of a partial read is one-based.
+      struct RangeTest {
+        size_t MinSample;
+        size_t MaxSample;
+      };
+      const std::vector<RangeTest> range_list = {
+          {1, 1},                                 // First sample
+          {kNofSamples / 2, kNofSamples / 2},     // Middle sample
+          {50'001, 60'000},                       // Crosses a DZ block
+          {kNofSamples - 4'999, kNofSamples},     // Last block
+          {kNofSamples - 9, kNofSamples + 1'000}, // Beyond end
+          {kNofSamples + 1, kNofSamples + 100},   // After the last sample
+      };
+      for (const auto& range : range_list) {
+        ChannelObserverList observer_list;
+        CreateChannelObserverForDataGroup(*dg, observer_list);
+        ASSERT_TRUE(reader->ReadPartialData(*dg, range.MinSample,
+                                            range.MaxSample));
+        ASSERT_EQ(observer_list.size(), expected_list.size());
+
+        const size_t first_sample = range.MinSample - 1;
+        const size_t last_sample = std::min(range.MaxSample, kNofSamples);
+        for (size_t index = 0; index < observer_list.size(); ++index) {
+          const auto& observer = observer_list[index];
+          const auto& expected = expected_list[index];
+          ASSERT_EQ(observer->NofSamples(), kNofSamples);
+          size_t nof_errors = 0;
+          for (size_t sample = 0; sample < kNofSamples && nof_errors < 10;
+               ++sample) {
+            double value = 0;
+            const bool valid = observer->GetChannelValue(sample, value);
+            const bool expected_valid =
+                sample >= first_sample && sample < last_sample;
+            if (valid != expected_valid ||
+                (valid && value != expected[sample])) {
+              ++nof_errors;
+              ADD_FAILURE() << "Compress: " << compress
+                            << ", Stream: " << stream
+                            << ", Range: " << range.MinSample << "-"
+                            << range.MaxSample << ", Channel: "
+                            << observer->Name() << ", Sample: " << sample;
+            }
+          }
+        }
+      }
+      reader->Close();
+    }
+  }
+}
+
 TEST_F(TestWrite, Mdf4Master) {
   if (kSkipTest) {
     GTEST_SKIP();